@@ -0,0 +1,9 @@
+_copyBytes:
+push rbp
+mov rbp, rsp
+mov rdi, QWORD [rbp + 16]    ; destination
+mov rsi, QWORD [rbp + 24]    ; source
+mov rcx, QWORD [rbp + 32]    ; bytes to copy, copied forwards like the loop it replaces
+rep movsb
+leave
+ret 24
\ No newline at end of file
@@ -0,0 +1,9 @@
+_fillChar:
+push rbp
+mov rbp, rsp
+mov rdi, QWORD [rbp + 16]    ; first element to fill
+mov rcx, QWORD [rbp + 24]    ; number of elements
+mov al, BYTE [rbp + 32]      ; value
+rep stosb
+leave
+ret 17
\ No newline at end of file
@@ -0,0 +1,9 @@
+_fillInt:
+push rbp
+mov rbp, rsp
+mov rdi, QWORD [rbp + 16]    ; first element to fill
+mov rcx, QWORD [rbp + 24]    ; number of elements
+mov eax, DWORD [rbp + 32]    ; value
+rep stosd
+leave
+ret 20
\ No newline at end of file
@@ -0,0 +1,9 @@
+_fillLong:
+push rbp
+mov rbp, rsp
+mov rdi, QWORD [rbp + 16]    ; first element to fill
+mov rcx, QWORD [rbp + 24]    ; number of elements
+mov rax, QWORD [rbp + 32]    ; value
+rep stosq
+leave
+ret 24
\ No newline at end of file
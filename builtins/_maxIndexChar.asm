@@ -0,0 +1,20 @@
+_maxIndexChar:
+push rbp
+mov rbp, rsp
+mov rsi, QWORD [rbp + 16]    ; first element
+mov rcx, QWORD [rbp + 24]    ; number of elements
+mov rdx, QWORD [rbp + 32]    ; current maximum
+mov rax, -1                  ; index of the new maximum, none yet
+xor rdi, rdi                 ; index of the element
+_maxIndexCharLoop:
+cmp rdi, rcx
+jge _maxIndexCharEnd
+movsx rbx, BYTE [rsi + rdi]
+cmp rbx, rdx
+cmovg rdx, rbx
+cmovg rax, rdi
+inc rdi
+jmp _maxIndexCharLoop
+_maxIndexCharEnd:
+leave
+ret 24
\ No newline at end of file
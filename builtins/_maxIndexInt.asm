@@ -0,0 +1,99 @@
+_maxIndexInt:
+push rbp
+mov rbp, rsp
+mov rsi, QWORD [rbp + 16]    ; first element
+mov rcx, QWORD [rbp + 24]    ; number of elements
+mov rdx, QWORD [rbp + 32]    ; current maximum
+mov rax, -1                  ; index of the new maximum, none yet
+test rcx, rcx
+jle _maxIndexIntEnd
+movd xmm0, DWORD [rsi]       ; the maximum of the elements, eight at a time in the lanes of two registers
+pshufd xmm0, xmm0, 0
+movdqa xmm3, xmm0
+xor rdi, rdi                 ; index of the element
+mov r8, rcx
+and r8, -8                   ; elements in whole pairs of registers
+_maxIndexIntLanes:
+cmp rdi, r8
+jge _maxIndexIntCombine
+movdqu xmm1, [rsi + rdi * 4]
+movdqa xmm2, xmm1
+pcmpgtd xmm2, xmm0           ; lanes where the element is larger
+pand xmm1, xmm2
+pandn xmm2, xmm0
+por xmm2, xmm1
+movdqa xmm0, xmm2
+movdqu xmm1, [rsi + rdi * 4 + 16]
+movdqa xmm2, xmm1
+pcmpgtd xmm2, xmm3
+pand xmm1, xmm2
+pandn xmm2, xmm3
+por xmm2, xmm1
+movdqa xmm3, xmm2
+add rdi, 8
+jmp _maxIndexIntLanes
+_maxIndexIntCombine:
+movdqa xmm1, xmm3            ; combine the two registers, then the halves and the quarters
+movdqa xmm2, xmm1
+pcmpgtd xmm2, xmm0
+pand xmm1, xmm2
+pandn xmm2, xmm0
+por xmm2, xmm1
+movdqa xmm0, xmm2
+pshufd xmm1, xmm0, 0x4e
+movdqa xmm2, xmm1
+pcmpgtd xmm2, xmm0
+pand xmm1, xmm2
+pandn xmm2, xmm0
+por xmm2, xmm1
+movdqa xmm0, xmm2
+pshufd xmm1, xmm0, 0xb1
+movdqa xmm2, xmm1
+pcmpgtd xmm2, xmm0
+pand xmm1, xmm2
+pandn xmm2, xmm0
+por xmm2, xmm1
+movdqa xmm0, xmm2
+movd ebx, xmm0
+movsxd rbx, ebx
+_maxIndexIntRest:
+cmp rdi, rcx
+jge _maxIndexIntCompare
+movsxd r9, DWORD [rsi + rdi * 4]
+cmp r9, rbx
+cmovg rbx, r9
+inc rdi
+jmp _maxIndexIntRest
+_maxIndexIntCompare:
+cmp rbx, rdx                 ; no element beats the current maximum
+jle _maxIndexIntEnd
+movd xmm0, ebx               ; then find its first element, four at a time
+pshufd xmm0, xmm0, 0
+xor rdi, rdi
+mov r8, rcx
+and r8, -4
+_maxIndexIntSearch:
+cmp rdi, r8
+jge _maxIndexIntSearchRest
+movdqu xmm1, [rsi + rdi * 4]
+pcmpeqd xmm1, xmm0
+pmovmskb r9d, xmm1
+test r9d, r9d
+jnz _maxIndexIntMatch
+add rdi, 4
+jmp _maxIndexIntSearch
+_maxIndexIntMatch:
+bsf r9d, r9d                 ; first matching byte, four for each element
+shr r9d, 2
+add rdi, r9
+jmp _maxIndexIntFound
+_maxIndexIntSearchRest:
+cmp DWORD [rsi + rdi * 4], ebx
+je _maxIndexIntFound
+inc rdi
+jmp _maxIndexIntSearchRest
+_maxIndexIntFound:
+mov rax, rdi
+_maxIndexIntEnd:
+leave
+ret 24
\ No newline at end of file
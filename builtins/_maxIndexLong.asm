@@ -0,0 +1,20 @@
+_maxIndexLong:
+push rbp
+mov rbp, rsp
+mov rsi, QWORD [rbp + 16]    ; first element
+mov rcx, QWORD [rbp + 24]    ; number of elements
+mov rdx, QWORD [rbp + 32]    ; current maximum
+mov rax, -1                  ; index of the new maximum, none yet
+xor rdi, rdi                 ; index of the element
+_maxIndexLongLoop:
+cmp rdi, rcx
+jge _maxIndexLongEnd
+mov rbx, QWORD [rsi + rdi * 8]
+cmp rbx, rdx
+cmovg rdx, rbx
+cmovg rax, rdi
+inc rdi
+jmp _maxIndexLongLoop
+_maxIndexLongEnd:
+leave
+ret 24
\ No newline at end of file
@@ -0,0 +1,20 @@
+_minIndexChar:
+push rbp
+mov rbp, rsp
+mov rsi, QWORD [rbp + 16]    ; first element
+mov rcx, QWORD [rbp + 24]    ; number of elements
+mov rdx, QWORD [rbp + 32]    ; current minimum
+mov rax, -1                  ; index of the new minimum, none yet
+xor rdi, rdi                 ; index of the element
+_minIndexCharLoop:
+cmp rdi, rcx
+jge _minIndexCharEnd
+movsx rbx, BYTE [rsi + rdi]
+cmp rbx, rdx
+cmovl rdx, rbx
+cmovl rax, rdi
+inc rdi
+jmp _minIndexCharLoop
+_minIndexCharEnd:
+leave
+ret 24
\ No newline at end of file
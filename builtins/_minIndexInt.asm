@@ -0,0 +1,99 @@
+_minIndexInt:
+push rbp
+mov rbp, rsp
+mov rsi, QWORD [rbp + 16]    ; first element
+mov rcx, QWORD [rbp + 24]    ; number of elements
+mov rdx, QWORD [rbp + 32]    ; current minimum
+mov rax, -1                  ; index of the new minimum, none yet
+test rcx, rcx
+jle _minIndexIntEnd
+movd xmm0, DWORD [rsi]       ; the minimum of the elements, eight at a time in the lanes of two registers
+pshufd xmm0, xmm0, 0
+movdqa xmm3, xmm0
+xor rdi, rdi                 ; index of the element
+mov r8, rcx
+and r8, -8                   ; elements in whole pairs of registers
+_minIndexIntLanes:
+cmp rdi, r8
+jge _minIndexIntCombine
+movdqu xmm1, [rsi + rdi * 4]
+movdqa xmm2, xmm0
+pcmpgtd xmm2, xmm1           ; lanes where the element is smaller
+pand xmm1, xmm2
+pandn xmm2, xmm0
+por xmm2, xmm1
+movdqa xmm0, xmm2
+movdqu xmm1, [rsi + rdi * 4 + 16]
+movdqa xmm2, xmm3
+pcmpgtd xmm2, xmm1
+pand xmm1, xmm2
+pandn xmm2, xmm3
+por xmm2, xmm1
+movdqa xmm3, xmm2
+add rdi, 8
+jmp _minIndexIntLanes
+_minIndexIntCombine:
+movdqa xmm1, xmm3            ; combine the two registers, then the halves and the quarters
+movdqa xmm2, xmm0
+pcmpgtd xmm2, xmm1
+pand xmm1, xmm2
+pandn xmm2, xmm0
+por xmm2, xmm1
+movdqa xmm0, xmm2
+pshufd xmm1, xmm0, 0x4e
+movdqa xmm2, xmm0
+pcmpgtd xmm2, xmm1
+pand xmm1, xmm2
+pandn xmm2, xmm0
+por xmm2, xmm1
+movdqa xmm0, xmm2
+pshufd xmm1, xmm0, 0xb1
+movdqa xmm2, xmm0
+pcmpgtd xmm2, xmm1
+pand xmm1, xmm2
+pandn xmm2, xmm0
+por xmm2, xmm1
+movdqa xmm0, xmm2
+movd ebx, xmm0
+movsxd rbx, ebx
+_minIndexIntRest:
+cmp rdi, rcx
+jge _minIndexIntCompare
+movsxd r9, DWORD [rsi + rdi * 4]
+cmp r9, rbx
+cmovl rbx, r9
+inc rdi
+jmp _minIndexIntRest
+_minIndexIntCompare:
+cmp rbx, rdx                 ; no element beats the current minimum
+jge _minIndexIntEnd
+movd xmm0, ebx               ; then find its first element, four at a time
+pshufd xmm0, xmm0, 0
+xor rdi, rdi
+mov r8, rcx
+and r8, -4
+_minIndexIntSearch:
+cmp rdi, r8
+jge _minIndexIntSearchRest
+movdqu xmm1, [rsi + rdi * 4]
+pcmpeqd xmm1, xmm0
+pmovmskb r9d, xmm1
+test r9d, r9d
+jnz _minIndexIntMatch
+add rdi, 4
+jmp _minIndexIntSearch
+_minIndexIntMatch:
+bsf r9d, r9d                 ; first matching byte, four for each element
+shr r9d, 2
+add rdi, r9
+jmp _minIndexIntFound
+_minIndexIntSearchRest:
+cmp DWORD [rsi + rdi * 4], ebx
+je _minIndexIntFound
+inc rdi
+jmp _minIndexIntSearchRest
+_minIndexIntFound:
+mov rax, rdi
+_minIndexIntEnd:
+leave
+ret 24
\ No newline at end of file
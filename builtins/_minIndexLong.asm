@@ -0,0 +1,20 @@
+_minIndexLong:
+push rbp
+mov rbp, rsp
+mov rsi, QWORD [rbp + 16]    ; first element
+mov rcx, QWORD [rbp + 24]    ; number of elements
+mov rdx, QWORD [rbp + 32]    ; current minimum
+mov rax, -1                  ; index of the new minimum, none yet
+xor rdi, rdi                 ; index of the element
+_minIndexLongLoop:
+cmp rdi, rcx
+jge _minIndexLongEnd
+mov rbx, QWORD [rsi + rdi * 8]
+cmp rbx, rdx
+cmovl rdx, rbx
+cmovl rax, rdi
+inc rdi
+jmp _minIndexLongLoop
+_minIndexLongEnd:
+leave
+ret 24
\ No newline at end of file
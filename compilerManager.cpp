@@ -20,8 +20,20 @@ int Compiler::compileProgram() {
         this->ilGenerator = new ILGenerator(this->programTree, this->intermediateLanguageFileName);
         this->ilProgram = this->ilGenerator->generateProgramIL();
 
+        // Optimize the IL unless disabled with '-O0'
+        if (this->options.optimize) {
+            ILOptimizer optimizer(this->ilProgram, this->options);
+            optimizer.optimizeProgram();
+        }
+
+        // Lay out the functions' frames, the variables' offsets are fixed before the code generation
+        FrameLayout frameLayout(this->ilProgram, this->options);
+        frameLayout.layoutProgram();
+
+        this->ilGenerator->writeProgramIL(this->ilProgram);
+
         // Generate machine code from intermediate language
-        this->codeGenerator = new Generator(this->ilProgram, this->targetFileName);
+        this->codeGenerator = new Generator(this->ilProgram, this->targetFileName, this->options);
         this->codeGenerator->generateProgram();
 
         std::cout << "Compilation successful" << std::endl;
@@ -50,6 +62,51 @@ std::string Compiler::getSourceCode() {
     return fileBuffer.str();
 }
 
+void Compiler::parseOptions(int argc, char *argv[]) {
+    for (int i = 4; i < argc; ++i) {
+        std::string flag = argv[i];
+
+        if (flag == "-O0") {
+            options.optimize = false;
+        } else if (flag == "-O1") {
+            options.optimize = true;
+        } else if (flag == "-mavx2") {
+            options.avx2 = true;
+        } else if (flag == "--inline-report") {
+            options.inlineReport = true;
+        } else if (flag == "--peephole-stats") {
+            options.peepholeStats = true;
+        } else if (flag == "--frame-report") {
+            options.frameReport = true;
+        } else if (flag == "-fregister-args") {
+            options.registerArgs = true;
+        } else if (flag == "-fmemoize") {
+            options.memoize = true;
+        } else if (flag.starts_with("-fmemoize-size=") && parseUnsigned(flag.substr(15), options.memoizeSize) &&
+                   options.memoizeSize >= 1) {
+            continue;
+        } else if (flag.starts_with("-mtune=") && InstructionScheduler::tunes.contains(flag.substr(7))) {
+            options.tune = flag.substr(7);
+        } else if (flag.starts_with("-funroll=") && parseUnsigned(flag.substr(9), options.unrollFactor) &&
+                   options.unrollFactor >= 1) {
+            continue;
+        } else {
+            std::cout << "Unknown option '" << flag << "'" << std::endl;
+            std::cout << usageErrMsg << std::endl;
+
+            exit(1);
+        }
+    }
+}
+
+bool Compiler::parseUnsigned(const std::string &value, int &result) {
+    if (value.empty() || value.size() > 6 || !std::all_of(value.begin(), value.end(), ::isdigit)) return false;
+
+    result = std::stoi(value);
+
+    return true;
+}
+
 void Compiler::checkExtension(std::string filename, std::string ext) {
     if (filename.substr(filename.find_last_of('.') + 1) != ext) {
         std::cout << "Unknown extension for file '" << filename << "' ." << ext << " expected" << std::endl;
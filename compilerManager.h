@@ -7,11 +7,15 @@
 
 #include <iostream>
 #include <fstream>
+#include <algorithm>
 #include "lexer.h"
 #include "parser.h"
 #include "treeNodes.h"
 #include "intermediateCodeGenerator.h"
 #include "generation.h"
+#include "ilOptimizer.h"
+#include "frameLayout.h"
+#include "compilerOptions.h"
 
 class Compiler {
 public:
@@ -30,6 +34,8 @@ public:
         checkExtension(sourceFileName, "ig");
         checkExtension(intermediateLanguageFileName, "il");
         checkExtension(targetFileName, "asm");
+
+        parseOptions(argc, argv);
     }
 
     ~Compiler() {
@@ -45,19 +51,32 @@ public:
 
     /**
      * @brief Compile the program by performing lexical analysis, parsing,
-     * intermediate language generation, and code generation.
+     * intermediate language generation, optimization and code generation.
      *
      * This function manages the compilation process by reading the source code from the specified file,
      * performing lexical analysis using a Lexer, parsing the token stream into a program tree using a Parser,
-     * generating intermediate language (IL) from the program tree using an ILGenerator, and finally generating
-     * machine code using a Generator. Any compilation errors are caught and handled by outputting the error message.
+     * generating intermediate language (IL) from the program tree using an ILGenerator, optimizing the IL
+     * using an ILOptimizer, and finally generating machine code using a Generator. Any compilation errors are caught and handled by outputting the error message.
      *
      * @return 0 if compilation succeeds, 1 if there are compilation errors.
      */
     int compileProgram();
 
 private:
-    inline static const std::string usageErrMsg = "Usage: ./compiler [filename].ig [filename].il [filename].asm";
+    inline static const std::string usageErrMsg = "Usage: ./compiler [filename].ig [filename].il [filename].asm [options]\n"
+                                                          "Options:\n"
+                                                          "  -O0  Disable the IL and machine code optimizations\n"
+                                                          "  -O1  Enable the IL and machine code optimizations (default)\n"
+                                                          "  -funroll=N  Partially unroll counted loops N times (default 4, 1 disables)\n"
+                                                          "  -mavx2  Vectorize loops with the AVX2 instructions instead of SSE2\n"
+                                                          "  -mtune=NAME  Schedule the instructions for the core NAME: generic (default), "
+                                                          "skylake, icelake or znver3\n"
+                                                          "  --inline-report  Print the function inlining decisions\n"
+                                                          "  --peephole-stats  Print how many times each peephole rule was applied\n"
+                                                          "  --frame-report  Print each function's frame size without and with the shared slots\n"
+                                                          "  -fregister-args  Pass the first six arguments of the program's functions in registers\n"
+                                                          "  -fmemoize  Cache the results of pure recursive functions\n"
+                                                          "  -fmemoize-size=N  Entries of each function's cache (default 4096)";
 
     std::string sourceFileName;
     std::string intermediateLanguageFileName;
@@ -70,6 +89,9 @@ private:
     ThreeAddressProgramP ilProgram = nullptr;
     Generator *codeGenerator = nullptr;
 
+    // Optional flags given after the file names
+    CompilerOptions options;
+
     /**
      * @brief Retrieve the source code from the specified source file.
      *
@@ -78,6 +100,22 @@ private:
      */
     std::string getSourceCode();
 
+    /**
+     * @brief Parse the optional flags following the three file names into 'options'.
+     *
+     * Exits with a usage message when an unknown flag is given.
+     */
+    void parseOptions(int argc, char *argv[]);
+
+    /**
+     * @brief Parse the numeric value of a flag.
+     *
+     * @param value The text after the flag's '='.
+     * @param result Set to the parsed value.
+     * @return Whether the text is a number of at most 6 digits.
+     */
+    static bool parseUnsigned(const std::string &value, int &result);
+
     void checkExtension(std::string filename, std::string ext);
 };
 
@@ -0,0 +1,39 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#ifndef COMPILER_COMPILEROPTIONS_H
+#define COMPILER_COMPILEROPTIONS_H
+
+#include <string>
+
+/**
+ * @brief Holds the optional command line flags given to the compiler after the file names.
+ *
+ * The options are filled by the Compiler class and passed on to the optimization and generation stages.
+ */
+class CompilerOptions {
+public:
+    // Whether the IL and machine code optimization passes should run ('-O0' disables them, '-O1' is the default)
+    bool optimize = true;
+    // How many iterations a counted loop is partially unrolled to ('-funroll=N', 1 disables partial unrolling)
+    int unrollFactor = 4;
+    // Whether vectorized loops use 32 byte AVX2 registers instead of 16 byte SSE2 registers ('-mavx2')
+    bool avx2 = false;
+    // Whether the inlining decisions are printed ('--inline-report')
+    bool inlineReport = false;
+    // Whether pure recursive functions cache their results ('-fmemoize')
+    bool memoize = false;
+    // Number of entries of each memoized function's cache ('-fmemoize-size=N')
+    int memoizeSize = 4096;
+    // Whether the number of times each peephole rule was applied is printed ('--peephole-stats')
+    bool peepholeStats = false;
+    // Whether each function's frame size, with and without the shared slots, is printed ('--frame-report')
+    bool frameReport = false;
+    // Whether the program's functions take their first arguments in registers instead of the stack ('-fregister-args')
+    bool registerArgs = false;
+    // The core whose latencies the instructions are scheduled by ('-mtune=NAME')
+    std::string tune = "generic";
+};
+
+#endif //COMPILER_COMPILEROPTIONS_H
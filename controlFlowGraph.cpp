@@ -0,0 +1,326 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#include <algorithm>
+#include "controlFlowGraph.h"
+#include "ilAnalysis.h"
+
+ControlFlowGraph::ControlFlowGraph(std::list<ThreeAddressStmtP> &stmts) {
+    ILStmtIterator blockStart = stmts.begin();
+
+    for (auto it = stmts.begin(); it != stmts.end(); ++it) {
+        // A label always starts a new block so jumps can enter it
+        if (dynamic_cast<LabelStmtP>(*it) && it != blockStart) {
+            blocks.emplace_back(blocks.size(), blockStart, it);
+            blockStart = it;
+        }
+
+        // A jump always ends the current block
+        if (ILAnalysis::isJump(*it)) {
+            blocks.emplace_back(blocks.size(), blockStart, std::next(it));
+            blockStart = std::next(it);
+        }
+    }
+
+    if (blockStart != stmts.end()) {
+        blocks.emplace_back(blocks.size(), blockStart, stmts.end());
+    }
+
+    for (auto &block: blocks) {
+        if (auto label = dynamic_cast<LabelStmtP>(*block.begin)) {
+            labelBlocks[label->labelName] = block.id;
+        }
+    }
+
+    linkBlocks();
+    computeReachability();
+    computeDominators();
+}
+
+void ControlFlowGraph::linkBlocks() {
+    for (auto &block: blocks) {
+        ThreeAddressStmtP last = block.lastStmt();
+        bool fallsThrough = !dynamic_cast<GotoStmtP>(last) && !dynamic_cast<FunctionExitStmtP>(last);
+
+        if (ILAnalysis::isJump(last)) {
+            block.successors.push_back(labelBlocks.at(ILAnalysis::jumpTarget(last)));
+        }
+
+        if (fallsThrough && block.id + 1 < (int) blocks.size() &&
+            std::find(block.successors.begin(), block.successors.end(), block.id + 1) == block.successors.end()) {
+            block.successors.push_back(block.id + 1);
+        }
+
+        for (int successor: block.successors) {
+            blocks[successor].predecessors.push_back(block.id);
+        }
+    }
+}
+
+void ControlFlowGraph::computeReachability() {
+    reachable.assign(blocks.size(), false);
+
+    if (blocks.empty()) return;
+
+    std::vector<int> worklist = {0};
+    reachable[0] = true;
+
+    while (!worklist.empty()) {
+        int current = worklist.back();
+        worklist.pop_back();
+
+        for (int successor: blocks[current].successors) {
+            if (!reachable[successor]) {
+                reachable[successor] = true;
+                worklist.push_back(successor);
+            }
+        }
+    }
+}
+
+void ControlFlowGraph::computeDominators() {
+    size_t blockCount = blocks.size();
+
+    immediateDominators.assign(blockCount, -1);
+
+    if (blockCount == 0) return;
+
+    // Number the reachable blocks in postorder with an explicit stack, the graph may be deep
+    std::vector<int> postorder;
+    std::vector<int> postorderNumbers(blockCount, -1);
+    std::vector<bool> visited(blockCount, false);
+    std::vector<std::pair<int, size_t>> stack = {{0, 0}};
+
+    visited[0] = true;
+
+    while (!stack.empty()) {
+        auto &[current, next] = stack.back();
+
+        if (next < blocks[current].successors.size()) {
+            int successor = blocks[current].successors[next++];
+
+            if (!visited[successor]) {
+                visited[successor] = true;
+                stack.emplace_back(successor, 0);
+            }
+
+            continue;
+        }
+
+        postorderNumbers[current] = (int) postorder.size();
+        postorder.push_back(current);
+        stack.pop_back();
+    }
+
+    // Walk up from both blocks to their common dominator, the dominators have higher postorder numbers
+    auto intersect = [&](int first, int second) {
+        while (first != second) {
+            while (postorderNumbers[first] < postorderNumbers[second]) first = immediateDominators[first];
+            while (postorderNumbers[second] < postorderNumbers[first]) second = immediateDominators[second];
+        }
+
+        return first;
+    };
+
+    immediateDominators[0] = 0;
+
+    for (bool changed = true; changed;) {
+        changed = false;
+
+        // Visit the blocks in reverse postorder, so most predecessors are done before the blocks they enter
+        for (auto it = std::next(postorder.rbegin()); it != postorder.rend(); ++it) {
+            int newDominator = -1;
+
+            for (int predecessor: blocks[*it].predecessors) {
+                if (immediateDominators[predecessor] == -1) continue;
+
+                newDominator = newDominator == -1 ? predecessor : intersect(predecessor, newDominator);
+            }
+
+            if (newDominator != immediateDominators[*it]) {
+                immediateDominators[*it] = newDominator;
+                changed = true;
+            }
+        }
+    }
+
+    numberDominatorTree();
+}
+
+void ControlFlowGraph::numberDominatorTree() {
+    size_t blockCount = blocks.size();
+    std::vector<std::vector<int>> children(blockCount);
+
+    treeEnter.assign(blockCount, -1);
+    treeExit.assign(blockCount, -1);
+
+    for (size_t b = 1; b < blockCount; ++b) {
+        if (immediateDominators[b] != -1) children[immediateDominators[b]].push_back((int) b);
+    }
+
+    std::vector<std::pair<int, size_t>> stack = {{0, 0}};
+    int number = 0;
+
+    treeEnter[0] = number++;
+
+    while (!stack.empty()) {
+        auto &[current, next] = stack.back();
+
+        if (next < children[current].size()) {
+            int child = children[current][next++];
+
+            treeEnter[child] = number++;
+            stack.emplace_back(child, 0);
+            continue;
+        }
+
+        treeExit[current] = number - 1;
+        stack.pop_back();
+    }
+}
+
+bool ControlFlowGraph::dominates(int dominator, int block) const {
+    return reachable[block] && reachable[dominator] && treeEnter[dominator] <= treeEnter[block] &&
+           treeExit[block] <= treeExit[dominator];
+}
+
+std::vector<NaturalLoop> ControlFlowGraph::findLoops() const {
+    std::vector<NaturalLoop> loops;
+
+    for (auto &block: blocks) {
+        if (!reachable[block.id]) continue;
+
+        for (int successor: block.successors) {
+            // A back edge goes to a block that dominates its source
+            if (!dominates(successor, block.id)) continue;
+
+            auto loopIt = std::find_if(loops.begin(), loops.end(),
+                                       [successor](const NaturalLoop &loop) { return loop.header == successor; });
+
+            if (loopIt == loops.end()) {
+                loops.emplace_back();
+                loopIt = std::prev(loops.end());
+                loopIt->header = successor;
+                loopIt->blocks.insert(successor);
+            }
+
+            loopIt->latches.push_back(block.id);
+
+            // Walk backwards from the latch, every block reached before the header is in the loop
+            std::vector<int> worklist = {block.id};
+
+            while (!worklist.empty()) {
+                int current = worklist.back();
+                worklist.pop_back();
+
+                if (loopIt->blocks.contains(current)) continue;
+
+                loopIt->blocks.insert(current);
+
+                for (int predecessor: blocks[current].predecessors) {
+                    if (reachable[predecessor]) worklist.push_back(predecessor);
+                }
+            }
+        }
+    }
+
+    for (auto &loop: loops) {
+        for (int member: loop.blocks) {
+            for (int successor: blocks[member].successors) {
+                if (!loop.contains(successor)) {
+                    loop.exitingBlocks.push_back(member);
+                    break;
+                }
+            }
+        }
+
+        std::vector<int> outsidePredecessors;
+
+        for (int predecessor: blocks[loop.header].predecessors) {
+            if (reachable[predecessor] && !loop.contains(predecessor)) outsidePredecessors.push_back(predecessor);
+        }
+
+        if (outsidePredecessors.size() == 1 && blocks[outsidePredecessors[0]].successors.size() == 1) {
+            loop.preheader = outsidePredecessors[0];
+        }
+    }
+
+    // Nested loops are strictly smaller than the loops containing them
+    std::stable_sort(loops.begin(), loops.end(), [](const NaturalLoop &a, const NaturalLoop &b) {
+        return a.blocks.size() < b.blocks.size();
+    });
+
+    return loops;
+}
+
+void ControlFlowGraph::computeTempLiveness() {
+    size_t blockCount = blocks.size();
+    std::vector<std::unordered_set<int>> uses(blockCount), defs(blockCount);
+
+    // A temporary is used by the block if it is read before the block assigns it
+    for (auto &block: blocks) {
+        for (auto it = block.begin; it != block.end; ++it) {
+            for (auto temp: ILAnalysis::usedTemps(*it)) {
+                if (!defs[block.id].contains(temp->id)) uses[block.id].insert(temp->id);
+            }
+
+            int defined = ILAnalysis::definedTemp(*it);
+
+            if (defined != -1) defs[block.id].insert(defined);
+        }
+    }
+
+    tempLiveIn.assign(blockCount, {});
+    tempLiveOut.assign(blockCount, {});
+
+    bool changed = true;
+
+    while (changed) {
+        changed = false;
+
+        for (int b = (int) blockCount - 1; b >= 0; --b) {
+            std::unordered_set<int> liveOut;
+
+            for (int successor: blocks[b].successors) {
+                liveOut.insert(tempLiveIn[successor].begin(), tempLiveIn[successor].end());
+            }
+
+            std::unordered_set<int> liveIn = uses[b];
+
+            for (int temp: liveOut) {
+                if (!defs[b].contains(temp)) liveIn.insert(temp);
+            }
+
+            if (liveIn != tempLiveIn[b] || liveOut != tempLiveOut[b]) {
+                tempLiveIn[b] = std::move(liveIn);
+                tempLiveOut[b] = std::move(liveOut);
+                changed = true;
+            }
+        }
+    }
+}
+
+bool ControlFlowGraph::moveStmt(std::list<ThreeAddressStmtP> &stmts, ILStmtIterator stmt, ILStmtIterator position) {
+    bool emptied = false;
+
+    // A block starting with the statement starts right after it instead, and so the previous block ends there
+    for (auto &block: blocks) {
+        if (block.end == stmt) block.end = std::next(stmt);
+
+        if (block.begin == stmt) {
+            block.begin = std::next(stmt);
+            emptied = emptied || block.begin == block.end;
+        }
+    }
+
+    stmts.splice(position, stmts, stmt);
+
+    return !emptied;
+}
+
+int ControlFlowGraph::blockByLabel(const std::string &label) const {
+    auto it = labelBlocks.find(label);
+
+    return it == labelBlocks.end() ? -1 : it->second;
+}
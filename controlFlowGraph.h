@@ -0,0 +1,150 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#ifndef COMPILER_CONTROLFLOWGRAPH_H
+#define COMPILER_CONTROLFLOWGRAPH_H
+
+#include <list>
+#include <set>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "threeAddressExpressionsAndStatements.h"
+
+typedef std::list<ThreeAddressStmtP>::iterator ILStmtIterator;
+
+/**
+ * @brief Represents a maximal straight-line run of IL statements.
+ *
+ * A block starts at a label or right after a jump and ends after a jump or right before the next label.
+ */
+class BasicBlock {
+public:
+    int id;
+    // The first statement of the block
+    ILStmtIterator begin;
+    // One past the last statement of the block
+    ILStmtIterator end;
+    std::vector<int> successors;
+    std::vector<int> predecessors;
+
+    BasicBlock(int id, ILStmtIterator begin, ILStmtIterator end) : id(id), begin(begin), end(end) {
+
+    }
+
+    /**
+     * @brief Returns the last statement of the block.
+     */
+    ThreeAddressStmtP lastStmt() const {
+        return *std::prev(end);
+    }
+};
+
+/**
+ * @brief Represents a natural loop: a header and every block that reaches one of its back edges without
+ * passing through the header.
+ */
+class NaturalLoop {
+public:
+    int header;
+    // Blocks with a back edge to the header
+    std::vector<int> latches;
+    // All blocks of the loop, including the header
+    std::set<int> blocks;
+    // Blocks of the loop with a successor outside of it
+    std::vector<int> exitingBlocks;
+    // The single block outside of the loop entering the header, or -1 if there isn't a suitable one
+    int preheader = -1;
+
+    /**
+     * @brief Checks whether a block is a part of the loop.
+     */
+    bool contains(int block) const {
+        return blocks.contains(block);
+    }
+};
+
+/**
+ * @brief Control flow graph of a single function's IL statements.
+ *
+ * The graph keeps iterators into the statement list, so it must be rebuilt after a pass
+ * inserts or removes statements at block boundaries. Statements moved with 'moveStmt' keep it valid.
+ *
+ * The dominators are kept as a tree of immediate dominators (computed by the Cooper-Harvey-Kennedy
+ * algorithm), numbered in preorder so a dominance check takes constant time.
+ */
+class ControlFlowGraph {
+public:
+    std::vector<BasicBlock> blocks;
+    // Whether each block can be reached from the function entry
+    std::vector<bool> reachable;
+    // Temporaries live at the start and at the end of each block (filled by 'computeTempLiveness')
+    std::vector<std::unordered_set<int>> tempLiveIn;
+    std::vector<std::unordered_set<int>> tempLiveOut;
+
+    /**
+     * @brief Splits the statements into basic blocks, links them and computes dominators.
+     *
+     * @param stmts The IL statements of one function (declaration to function exit).
+     */
+    explicit ControlFlowGraph(std::list<ThreeAddressStmtP> &stmts);
+
+    /**
+     * @brief Checks if every path from the function entry to 'block' passes through 'dominator'.
+     */
+    bool dominates(int dominator, int block) const;
+
+    /**
+     * @brief Finds the natural loops of the function.
+     *
+     * Back edges to the same header are merged into one loop.
+     *
+     * @return The loops ordered from the innermost to the outermost.
+     */
+    std::vector<NaturalLoop> findLoops() const;
+
+    /**
+     * @brief Computes the temporaries live in and out of every block with a backward data-flow analysis.
+     */
+    void computeTempLiveness();
+
+    /**
+     * @brief Returns the block starting with the given label, or -1 if there isn't one.
+     */
+    int blockByLabel(const std::string &label) const;
+
+    /**
+     * @brief Moves a statement that is neither a label nor a jump before another position of the list, keeping
+     * the blocks' boundaries and links valid.
+     *
+     * @param stmts The statements the graph was built from.
+     * @param stmt The statement to move.
+     * @param position The statement it is moved before.
+     * @return False if the move left its block empty, the graph must be rebuilt before its blocks are used again.
+     */
+    bool moveStmt(std::list<ThreeAddressStmtP> &stmts, ILStmtIterator stmt, ILStmtIterator position);
+
+private:
+    std::unordered_map<std::string, int> labelBlocks;
+    // The immediate dominator of each reachable block, the entry is its own and the unreachable blocks have -1
+    std::vector<int> immediateDominators;
+    // The preorder number of each block in the dominator tree and the last number in its subtree, a block dominates
+    // the blocks numbered within its interval
+    std::vector<int> treeEnter;
+    std::vector<int> treeExit;
+
+    void linkBlocks();
+
+    void computeReachability();
+
+    void computeDominators();
+
+    /**
+     * @brief Numbers the blocks of the dominator tree in preorder.
+     */
+    void numberDominatorTree();
+};
+
+#endif //COMPILER_CONTROLFLOWGRAPH_H
@@ -0,0 +1,317 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#include "frameLayout.h"
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <set>
+#include "ilAnalysis.h"
+#include "controlFlowGraph.h"
+
+void FrameLayout::layoutProgram() {
+    for (auto stmt: ilProgram->ilStmts) {
+        if (auto functionDeclaration = dynamic_cast<FunctionDeclarationStmtP>(stmt)) {
+            programFunctions.insert(functionDeclaration->name);
+        }
+    }
+
+    if (options.registerArgs) gatherRegisterArguments();
+
+    std::list<ThreeAddressStmtP> functionStmts;
+
+    for (auto stmt: ilProgram->ilStmts) {
+        if (dynamic_cast<FunctionDeclarationStmtP>(stmt)) functionStmts.clear();
+
+        functionStmts.push_back(stmt);
+
+        if (dynamic_cast<FunctionExitStmtP>(stmt)) layoutFunction(functionStmts);
+    }
+}
+
+int FrameLayout::paramsSize(FunctionDeclarationStmtP declaration) {
+    return ((int) declaration->params.size() - declaration->registerParams) * PARAM_SLOT_SIZE;
+}
+
+void FrameLayout::gatherRegisterArguments() {
+    std::list<ThreeAddressStmtP> &stmts = ilProgram->ilStmts;
+    FunctionDeclarationStmtP function = nullptr;
+    std::vector<std::list<ThreeAddressStmtP>::iterator> pushes;
+
+    for (auto it = stmts.begin(); it != stmts.end(); ++it) {
+        if (auto functionDeclaration = dynamic_cast<FunctionDeclarationStmtP>(*it)) {
+            function = functionDeclaration;
+            pushes.clear();
+        } else if (dynamic_cast<FunctionParamPushStmtP>(*it)) {
+            pushes.push_back(it);
+        } else if (FunctionCallExprP call = ILAnalysis::getCall(*it)) {
+            auto first = pushes.end() - std::min((long) pushes.size(), (long) call->paramCount);
+            bool contiguous = true;
+
+            for (auto push = first; push != pushes.end(); ++push) {
+                contiguous &= std::next(*push) == (push + 1 == pushes.end() ? it : *(push + 1));
+            }
+
+            // Move the pushes of a call with statements between them (the calls of the later arguments) to right
+            // before it, each value taken to a new temporary where it was pushed
+            if (!contiguous && programFunctions.contains(call->functionName)) {
+                for (auto push = first; push != pushes.end(); ++push) {
+                    auto functionParamPush = dynamic_cast<FunctionParamPushStmtP>(**push);
+
+                    if (!dynamic_cast<ImIntValP>(functionParamPush->expr)) {
+                        stmts.insert(*push, new TempAssignmentTAStmt(++function->maxTemp, functionParamPush->expr));
+                        functionParamPush->expr = new UniTemp(function->maxTemp);
+                    }
+
+                    stmts.splice(it, stmts, *push);
+                }
+            }
+
+            pushes.erase(first, pushes.end());
+        }
+    }
+}
+
+void FrameLayout::layoutFunction(std::list<ThreeAddressStmtP> &stmts) {
+    auto declaration = dynamic_cast<FunctionDeclarationStmtP>(stmts.front());
+    int savedRegistersSize = (int) declaration->registerVars.size() * SLOT_SIZE;
+    bool calls = false;
+
+    unsharedDepth = declaration->maxTemp * SLOT_SIZE + savedRegistersSize;
+
+    if (options.optimize) colorTemps(stmts);
+
+    for (auto stmt: stmts) {
+        if (auto functionDeclaration = dynamic_cast<FunctionDeclarationStmtP>(stmt)) {
+            enterFunction(functionDeclaration);
+        } else if (auto scopeEnter = dynamic_cast<ScopeEnterStmtP>(stmt)) {
+            enterScope(scopeEnter);
+        } else if (dynamic_cast<ScopeExitStmtP>(stmt)) {
+            exitScope();
+        } else {
+            // Each occurrence of a variable gets the offset of the innermost variable by its name, the register
+            // variables have none
+            ILAnalysis::forEachVariable(stmt, [this](Variable &var) {
+                auto offsets = variableOffsets.find(var.name);
+
+                if (offsets != variableOffsets.end() && !offsets->second.empty()) {
+                    var.frameOffset = offsets->second.back();
+                }
+            });
+
+            if (auto functionParamPush = dynamic_cast<FunctionParamPushStmtP>(stmt)) {
+                pendingPushes.push_back(functionParamPush);
+            } else if (FunctionCallExprP call = ILAnalysis::getCall(stmt)) {
+                layoutCallArguments(call);
+                calls = true;
+            }
+        }
+    }
+
+    declaration->frameSize = alignFrame(declaration->frameSize);
+    // The frame starts below the slot the saved 'rbp' would take
+    declaration->leaf = options.optimize && !calls && declaration->frameSize + SLOT_SIZE <= RED_ZONE_SIZE;
+
+    if (options.frameReport) {
+        std::cout << declaration->name << ": frame " << alignFrame(unsharedDepth) << " -> " << declaration->frameSize
+                  << " bytes" << std::endl;
+    }
+}
+
+void FrameLayout::colorTemps(std::list<ThreeAddressStmtP> &stmts) {
+    auto declaration = dynamic_cast<FunctionDeclarationStmtP>(stmts.front());
+    ControlFlowGraph cfg(stmts);
+    // The temporaries each temporary can't share a slot with
+    std::map<int, std::set<int>> interference;
+
+    cfg.computeTempLiveness();
+
+    for (const auto &block: cfg.blocks) {
+        std::unordered_set<int> live = cfg.tempLiveOut[block.id];
+
+        // Walk the block backwards, a temporary assigned conflicts with every temporary live after the assignment
+        for (auto it = block.end; it != block.begin;) {
+            --it;
+            int defined = ILAnalysis::definedTemp(*it);
+
+            if (defined != -1) {
+                interference[defined];
+
+                for (int temp: live) {
+                    if (temp == defined) continue;
+
+                    interference[defined].insert(temp);
+                    interference[temp].insert(defined);
+                }
+
+                live.erase(defined);
+            }
+
+            for (auto temp: ILAnalysis::usedTemps(*it)) {
+                interference[temp->id];
+                live.insert(temp->id);
+            }
+        }
+    }
+
+    // The entry of a memoized function is stored in the prologue and read at the exit, it is live throughout
+    if (declaration->memoRange > 0) {
+        for (auto &[temp, conflicts]: interference) {
+            if (temp == declaration->memoTemp) continue;
+
+            conflicts.insert(declaration->memoTemp);
+            interference[declaration->memoTemp].insert(temp);
+        }
+
+        interference[declaration->memoTemp];
+    }
+
+    // Give each temporary the lowest id none of its colored neighbours has
+    std::unordered_map<int, int> colors;
+    int maxColor = 0;
+
+    for (const auto &[temp, conflicts]: interference) {
+        std::set<int> taken;
+
+        for (int conflict: conflicts) {
+            if (colors.contains(conflict)) taken.insert(colors[conflict]);
+        }
+
+        int color = 1;
+
+        while (taken.contains(color)) color++;
+
+        colors[temp] = color;
+        maxColor = std::max(maxColor, color);
+    }
+
+    for (auto stmt: stmts) {
+        for (auto temp: ILAnalysis::usedTemps(stmt)) {
+            temp->id = colors[temp->id];
+        }
+
+        if (auto tempAssignment = dynamic_cast<TempAssignmentTAStmtP>(stmt)) {
+            tempAssignment->id = colors[tempAssignment->id];
+        } else if (auto vectorReduce = dynamic_cast<VectorReduceStmtP>(stmt)) {
+            vectorReduce->id = colors[vectorReduce->id];
+        }
+    }
+
+    if (declaration->memoRange > 0) declaration->memoTemp = colors[declaration->memoTemp];
+
+    declaration->maxTemp = maxColor;
+}
+
+void FrameLayout::enterFunction(FunctionDeclarationStmtP declaration) {
+    currentFunction = declaration;
+    variableOffsets.clear();
+    openScopes.clear();
+    pendingPushes.clear();
+
+    // The temporaries are at 'rbp - id * 8', the saved registers right below them
+    frameDepth = (declaration->maxTemp + (int) declaration->registerVars.size()) * SLOT_SIZE;
+    declaration->registerParams = 0;
+
+    if (options.registerArgs) {
+        declaration->registerParams = std::min((int) declaration->params.size(), (int) REGISTER_PARAMS);
+    }
+
+    for (size_t i = 0; i < declaration->params.size(); ++i) {
+        Variable &param = declaration->params[i];
+        int stackIndex = (int) i - declaration->registerParams;
+
+        // The parameters passed in registers are stored right below the saved registers, the rest stay above the
+        // return address
+        if (stackIndex < 0) {
+            frameDepth += PARAM_SLOT_SIZE;
+            param.frameOffset = -frameDepth;
+        } else {
+            param.frameOffset = FIRST_PARAM_OFFSET + stackIndex * PARAM_SLOT_SIZE;
+        }
+
+        variableOffsets[param.name].push_back(param.frameOffset);
+    }
+
+    unsharedDepth += declaration->registerParams * PARAM_SLOT_SIZE;
+    declaration->frameSize = frameDepth;
+}
+
+void FrameLayout::enterScope(ScopeEnterStmtP scopeEnter) {
+    std::vector<Variable *> vars;
+
+    openScopes.emplace_back(std::vector<std::string>(), frameDepth);
+
+    for (auto &var: scopeEnter->vars) {
+        vars.push_back(&var);
+    }
+
+    std::stable_sort(vars.begin(), vars.end(), [](const Variable *first, const Variable *second) {
+        return variableSize(*first, true) > variableSize(*second, true);
+    });
+
+    for (auto var: vars) {
+        frameDepth = placeVariable(*var, frameDepth);
+        unsharedDepth = placeVariable(*var, unsharedDepth);
+        var->frameOffset = -frameDepth;
+
+        variableOffsets[var->name].push_back(var->frameOffset);
+        openScopes.back().first.push_back(var->name);
+    }
+
+    currentFunction->frameSize = std::max(currentFunction->frameSize, frameDepth);
+}
+
+void FrameLayout::exitScope() {
+    for (const auto &name: openScopes.back().first) {
+        variableOffsets[name].pop_back();
+    }
+
+    frameDepth = openScopes.back().second;
+    openScopes.pop_back();
+}
+
+void FrameLayout::layoutCallArguments(FunctionCallExprP call) {
+    auto first = pendingPushes.end() - std::min((long) pendingPushes.size(), (long) call->paramCount);
+    bool programFunction = programFunctions.contains(call->functionName);
+    int offset = 0;
+    int index = 0;
+
+    // The parameters are pushed in reverse, the last push is the first parameter
+    for (auto push = pendingPushes.end(); push != first; ++index) {
+        --push;
+        (*push)->argsSize = 0;
+
+        // The built-in functions take all their arguments on the stack
+        if (programFunction && options.registerArgs && index < REGISTER_PARAMS) {
+            (*push)->argRegister = index;
+            continue;
+        }
+
+        (*push)->argOffset = offset;
+
+        offset += programFunction ? PARAM_SLOT_SIZE
+                                  : (*push)->isPtr ? PTR_SIZE : typeSizes.at((*push)->varType);
+    }
+
+    if (first != pendingPushes.end()) (*first)->argsSize = offset;
+
+    pendingPushes.erase(first, pendingPushes.end());
+}
+
+int FrameLayout::variableSize(const Variable &var, bool element) {
+    if (var.ptrType) return PTR_SIZE;
+
+    return typeSizes.at(var.type) * (element || var.arrSize == 0 ? 1 : var.arrSize);
+}
+
+int FrameLayout::placeVariable(const Variable &var, int depth) {
+    int alignment = variableSize(var, true);
+
+    return (depth + variableSize(var, false) + alignment - 1) / alignment * alignment;
+}
+
+int FrameLayout::alignFrame(int size) {
+    return (size + FRAME_ALIGNMENT - 1) / FRAME_ALIGNMENT * FRAME_ALIGNMENT;
+}
@@ -0,0 +1,177 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#ifndef COMPILER_FRAMELAYOUT_H
+#define COMPILER_FRAMELAYOUT_H
+
+#include <list>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include "threeAddressExpressionsAndStatements.h"
+#include "compilerOptions.h"
+
+/**
+ * @brief Lays out the stack frame of every function once, before the code generation.
+ *
+ * Below 'rbp' are the temporaries, then the callee-saved registers of the register variables and then the
+ * variables of all the function's scopes, the scopes nested in a scope below its variables and sibling scopes
+ * sharing the same space. The prologue allocates the whole frame at once. Each variable is placed at an offset
+ * aligned to its element size and every occurrence of it is given that offset, so the generator addresses it
+ * without looking it up.
+ *
+ * When optimizing, a function calling nothing whose frame fits the red zone is a leaf, it keeps its frame below
+ * 'rsp' and addresses it as if 'rbp' was pushed, the offsets are the same.
+ *
+ * When optimizing, the temporaries share their slots: two temporaries get the same slot unless one of them is
+ * assigned while the other is live, a greedy coloring of their interference graph.
+ *
+ * The parameters of the program's functions take a slot of 8 bytes each above the return address, which keeps
+ * 'rbp' and so the variables aligned, the built-in functions read theirs packed. The caller allocates the
+ * arguments of each call with a single adjustment before the first of them is stored, at a fixed offset from
+ * 'rsp', and the called function releases them on return.
+ *
+ * With '-fregister-args' the program's functions take their first 'REGISTER_PARAMS' arguments in registers, and
+ * the prologue stores them right below the saved registers. Only the arguments after them are allocated on the
+ * stack, still with a single adjustment, and released on return. The built-in functions keep taking theirs on the
+ * stack, the call of each function passes the arguments the way it takes them.
+ */
+class FrameLayout {
+public:
+    // Size of a parameter's slot, in the functions declared by the program
+    static const int PARAM_SLOT_SIZE = 8;
+    // Offset from 'rbp' of the first parameter, above the saved 'rbp' and the return address
+    static const int FIRST_PARAM_OFFSET = 16;
+    // Number of the first parameters passed in registers with '-fregister-args'
+    static const int REGISTER_PARAMS = 6;
+
+    /**
+     * @brief Constructor for the FrameLayout class.
+     *
+     * @param ilProgram The program whose functions are laid out.
+     * @param options The compiler options, sharing the temporaries' slots is an optimization.
+     */
+    FrameLayout(ThreeAddressProgramP ilProgram, const CompilerOptions &options) : ilProgram(ilProgram),
+                                                                                  options(options) {
+
+    }
+
+    /**
+     * @brief Lays out the frames of all the functions, setting the variables' and the arguments' offsets and the
+     * functions' frame sizes. The sizes are printed when asked by '--frame-report'.
+     */
+    void layoutProgram();
+
+    /**
+     * @brief Gets the size of the parameters a function declared by the program takes on the stack, released by its
+     * 'ret'.
+     */
+    static int paramsSize(FunctionDeclarationStmtP declaration);
+
+private:
+    // Size of temporary variables and of the saved registers in bytes
+    static const int SLOT_SIZE = 8;
+    // Size of a pointer data type in bytes
+    static const int PTR_SIZE = 8;
+    // The frame size is rounded up to it, keeping 'rsp' as aligned as 'rbp'
+    static const int FRAME_ALIGNMENT = 16;
+    // Size of the System V red zone, the bytes below 'rsp' a function may use without allocating them
+    static const int RED_ZONE_SIZE = 128;
+
+    // Map to associate VariableType with its size in bytes
+    inline static const std::unordered_map<VariableType, int> typeSizes = {
+            {VariableType::longType, 8},
+            {VariableType::intType,  4},
+            {VariableType::charType, 1},
+    };
+
+    ThreeAddressProgramP ilProgram;
+    // The options given to the compiler
+    const CompilerOptions &options;
+    // The names of the functions declared by the program, their parameters take 'PARAM_SLOT_SIZE' bytes each
+    std::unordered_set<std::string> programFunctions;
+
+    // The function being laid out
+    FunctionDeclarationStmtP currentFunction = nullptr;
+    // Map from each variable name to the offsets of the variables by that name in the open scopes, innermost last
+    std::unordered_map<std::string, std::vector<int>> variableOffsets;
+    // The names declared by each open scope and the frame depth before it, to restore both at its exit
+    std::vector<std::pair<std::vector<std::string>, int>> openScopes;
+    // The bytes below 'rbp' used by the open scopes
+    int frameDepth = 0;
+    // The bytes below 'rbp' the function would take with no slot shared, for the report
+    int unsharedDepth = 0;
+    // The parameter pushes whose call is not reached yet, in order
+    std::vector<FunctionParamPushStmtP> pendingPushes;
+
+    /**
+     * @brief Moves the pushes of each call to a program function right before it, so the registers the generator
+     * loads them to are not used by anything between. A value pushed before the statements computing the other
+     * arguments is kept in a new temporary.
+     */
+    void gatherRegisterArguments();
+
+    /**
+     * @brief Lays out the frame of a function.
+     *
+     * @param stmts The function's statements, declaration to function exit.
+     */
+    void layoutFunction(std::list<ThreeAddressStmtP> &stmts);
+
+    /**
+     * @brief Renumbers the temporaries of a function so the ones never live at the same time share an id, and with
+     * it a slot, the entry of a memoized function keeps its own.
+     *
+     * @param stmts The function's statements, declaration to function exit.
+     */
+    static void colorTemps(std::list<ThreeAddressStmtP> &stmts);
+
+    /**
+     * @brief Starts the layout of a function, placing its parameters above the return address, or below the saved
+     * registers for the ones passed in registers.
+     */
+    void enterFunction(FunctionDeclarationStmtP declaration);
+
+    /**
+     * @brief Places the variables of a scope below the ones of the open scopes, the most aligned first so
+     * the padding between them is minimal.
+     */
+    void enterScope(ScopeEnterStmtP scopeEnter);
+
+    /**
+     * @brief Releases the space of the innermost open scope for the scopes after it.
+     */
+    void exitScope();
+
+    /**
+     * @brief Assigns the offsets of a call's arguments from 'rsp', the first parameter's lowest, or the registers
+     * of the ones passed in registers.
+     *
+     * @param call The call, its pushes are the last 'paramCount' pending ones.
+     */
+    void layoutCallArguments(FunctionCallExprP call);
+
+    /**
+     * @brief Gets the size of a variable, or of each of its elements.
+     *
+     * @param var The variable.
+     * @param element Whether to get the size of a single element of an array.
+     */
+    static int variableSize(const Variable &var, bool element);
+
+    /**
+     * @brief Places a variable below the given depth, aligned to its element size.
+     *
+     * @return The depth below the variable.
+     */
+    static int placeVariable(const Variable &var, int depth);
+
+    /**
+     * @brief Rounds a frame size up to 'FRAME_ALIGNMENT'.
+     */
+    static int alignFrame(int size);
+};
+
+#endif //COMPILER_FRAMELAYOUT_H
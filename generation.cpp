@@ -4,6 +4,8 @@
 
 #include "generation.h"
 
+#include <algorithm>
+
 void Generator::generateProgram() {
     this->programOut << "section .data\n"
                         "overflowErrMsg db 'Stack overflow, exiting', 0xa\n"
@@ -14,10 +16,24 @@ void Generator::generateProgram() {
         this->programOut << literal.first << " db `" << literal.second << "`, 0\n";
     }
 
+    // The tables of the memoized functions, a value and a flag telling if it was computed for each entry
+    this->programOut << "\nsection .bss\n";
+
+    for (auto ilStmt: this->ilProgram->ilStmts) {
+        auto functionDeclaration = dynamic_cast<FunctionDeclarationStmtP>(ilStmt);
+
+        if (functionDeclaration && functionDeclaration->memoRange > 0) {
+            int tableSize = memoTableSize(functionDeclaration);
+
+            this->programOut << functionDeclaration->name << "MemoValues resq " << tableSize << "\n"
+                             << functionDeclaration->name << "MemoSet resb " << tableSize << "\n";
+        }
+    }
+
     this->programOut << "\nsection .text\n"
                         "global _start\n"
                         "_start:\n"
-                        "mov r8, 0                ; function call stack counter\n"
+                        "mov r10, 0               ; function call stack counter\n"
                         "call main\n"
                         "movsx rdi, eax           ; exit code\n"
                         "mov rax, 0x3c            ; syscall number for sys_exit\n"
@@ -36,10 +52,31 @@ void Generator::generateProgram() {
         this->readAndGenerateBuiltinFunctionCode(builtinName);
     }
 
+    // The sections and the built-in functions are written as they are, before the functions' machine code
+    std::string programHeader = this->programOut.str();
+
     for (auto ilStmt: this->ilProgram->ilStmts) {
         convertTAStmtToAsm(ilStmt);
     }
 
+    // Clean up the local redundancy left by generating each statement on its own
+    if (this->options.optimize) {
+        PeepholeOptimizer peepholeOptimizer;
+
+        for (auto &machineFunction: this->machineFunctions) {
+            peepholeOptimizer.optimizeFunction(machineFunction);
+        }
+
+        if (this->options.peepholeStats) peepholeOptimizer.printStats(std::cout);
+
+        // Start the long latency instructions early, after the peephole rules which look for adjacent instructions
+        InstructionScheduler scheduler(this->options.tune);
+
+        for (auto &machineFunction: this->machineFunctions) {
+            scheduler.scheduleFunction(machineFunction);
+        }
+    }
+
     std::ofstream outFile(this->outFileName);
 
     if (outFile.fail()) {
@@ -47,202 +84,405 @@ void Generator::generateProgram() {
         throw FileOpenException(this->outFileName);
     }
 
-    outFile << this->programOut.str();
+    outFile << programHeader;
+
+    // Print the machine code of the functions
+    for (const auto &machineFunction: this->machineFunctions) {
+        machineFunction.print(outFile);
+    }
 
     outFile.close();
 }
 
-std::string Generator::movTo64BitReg(const std::string &reg, const std::string &val, int size) {
-    // Determine the appropriate move instruction based on the size of the value
-    std::string movType = (size < BIT_64_REG_SIZE) ? "movsx " : "mov ";
+void Generator::emit(const std::string &opcode, std::vector<MachineOperand> operands) {
+    this->machineFunctions.back().instrs.emplace_back(opcode, std::move(operands));
+}
+
+void Generator::emit(MachineInstr instr) {
+    this->machineFunctions.back().instrs.push_back(std::move(instr));
+}
 
-    // Construct the assembly instruction string
-    return movType + reg + ", " + val;
+void Generator::emitLabel(const std::string &label, const std::string &comment) {
+    this->machineFunctions.back().instrs.push_back(MachineInstr::makeLabel(label, comment));
 }
 
-std::string Generator::getStackAddr(const VariableStackData &var) {
-    // If positive stack position: "rbp + stackPos"
-    if (var.stackPos > 0) {
-        return "rbp + " + std::to_string(var.stackPos);
+MachineInstr Generator::movTo64BitReg(const std::string &reg, const MachineOperand &val, bool nonNegative) {
+    if (val.size == BIT_64_REG_SIZE) return {"mov", {MachineOperand::makeReg(reg), val}};
+
+    // Writing the 32 bit part of a register clears its upper half, which is all a non-negative value needs
+    if (nonNegative) {
+        MachineOperand dest = MachineOperand::makeReg(MachineOperand::partialRegister(reg, BIT_32_REG_SIZE));
+
+        return {val.size == BIT_32_REG_SIZE ? "mov" : "movzx", {dest, val}};
     }
 
-    // Negative stack position: "rbp - |stackPos|"
-    return "rbp - " + std::to_string(std::abs(var.stackPos));
+    return {"movsx", {MachineOperand::makeReg(reg), val}};
 }
 
-std::string Generator::getSubscriptableStackPosition(SubscriptableVariableValP subVar,
-                                                     const std::string &freeReg) {
-    // Retrieve the current VariableStackData for the variable name
-    VariableStackData varData = this->variableStack[subVar->var.name].top();
-    // Initialize typeSize with the size of the variable's type, if the
-    // var is a pointer then it would be changed to the side of the type
-    int typeSize = varData.varSize;
-    std::string varBaseAddr = getStackAddr(varData);
+VariableStackData Generator::getVariableData(const Variable &var) {
+    return {var.frameOffset, sizeByTypeAndPtr(var.type, var.ptrType, 0)};
+}
 
-    // Load the address pointed to by the pointer into the freeReg register if the variable is a pointer
-    if (subVar->var.ptrType) {
-        this->programOut << "mov " << freeReg << ", QWORD [" << varBaseAddr << "]\n";
-        varBaseAddr = freeReg;
-        typeSize = typeSizes[subVar->var.type];
+MachineOperand Generator::getStackAddr(const VariableStackData &var, int size) {
+    return getFrameAddr(var.stackPos, size);
+}
+
+MachineOperand Generator::getFrameAddr(int offset, int size) {
+    std::string base = "rbp";
+
+    // A leaf function doesn't push 'rbp', its frame is addressed from 'rsp' as if it did
+    if (currentFunction->leaf) {
+        base = "rsp";
+        offset -= BIT_64_REG_SIZE;
     }
 
-    // Determine the offset used for subscripting
-    std::string offset = "rcx";
+    return MachineOperand::makeMem(size, base, offset);
+}
+
+MachineOperand Generator::getTempAddr(int id) {
+    return getFrameAddr(-id * TEMP_SIZE, TEMP_SIZE);
+}
+
+MachineOperand Generator::getSubscriptableStackPosition(SubscriptableVariableValP subVar,
+                                                        const std::string &freeReg) {
+    auto imIntIndex = dynamic_cast<ImIntValP>(subVar->index);
+    MachineOperand address;
+    int typeSize;
 
-    if (auto imIntIndex = dynamic_cast<ImIntValP>(subVar->index)) {
-        offset = imIntIndex->value;
+    // A register variable is a pointer whose value is already in its register
+    if (this->registerVariables.contains(subVar->var.name)) {
+        address = MachineOperand::makeMem(0, this->registerVariables[subVar->var.name], 0);
+        typeSize = typeSizes[subVar->var.type];
+    } else {
+        // Retrieve the VariableStackData for the variable's offset in the frame
+        VariableStackData varData = getVariableData(subVar->var);
+
+        // Initialize typeSize with the size of the variable's type, if the
+        // var is a pointer then it would be changed to the side of the type
+        typeSize = varData.varSize;
+        address = getStackAddr(varData, 0);
+
+        // Load the address pointed to by the pointer into the freeReg register if the variable is a pointer
+        if (subVar->var.ptrType) {
+            emit("mov", {MachineOperand::makeReg(freeReg), getStackAddr(varData, PTR_SIZE)});
+            address = MachineOperand::makeMem(0, freeReg, 0);
+            typeSize = typeSizes[subVar->var.type];
+        }
+    }
+
+    // A constant index is a part of the displacement, otherwise the index is computed to 'rcx'
+    if (imIntIndex) {
+        address.value += typeSize * std::stoll(imIntIndex->value);
     } else {
         convertUniExprToRegister(subVar->index, "rcx");
+        address.index = "rcx";
+        address.scale = typeSize;
     }
 
     // Return the memory location of the subscripted variable
-    return "[" + varBaseAddr + " + " + std::to_string(typeSize) + " * " + offset + "]";
+    return address;
 }
 
 void Generator::convertUniExprToRegister(UniExprP expr, const std::string &reg) {
+    MachineOperand dest = MachineOperand::makeReg(reg);
+
     if (auto imInt = dynamic_cast<ImIntValP>(expr)) {
         // If the expression is an immediate integer value (ImIntVal), move the value to the register.
-        this->programOut << "mov " << reg << ", " << imInt->value << "\n";
+        emit("mov", {dest, MachineOperand::makeImm(std::stoll(imInt->value))});
     } else if (auto temp = dynamic_cast<UniTempP>(expr)) {
         // If the expression is a temporary (UniTemp), load its value from the stack into the register.
-        this->programOut << "mov " << reg << ", QWORD [rbp - " << (temp->id * TEMP_SIZE) << "]\n";
+        emit("mov", {dest, getTempAddr(temp->id)});
     } else if (auto subVar = dynamic_cast<SubscriptableVariableValP>(expr)) {
         // If the expression is a subscriptable variable, calculate its address and move the value to the register
-        VariableStackData varData = this->variableStack[subVar->var.name].top();
-
-        int typeSize = varData.varSize;
+        int typeSize;
 
         if (subVar->var.ptrType) {
             typeSize = typeSizes[subVar->var.type];
+        } else {
+            typeSize = getVariableData(subVar->var).varSize;
         }
 
-        std::string varAddr = sizeIdentifiers[typeSize] + " " +
-                              getSubscriptableStackPosition(subVar, reg);
+        MachineOperand varAddr = getSubscriptableStackPosition(subVar, reg);
 
-        this->programOut << movTo64BitReg(reg, varAddr, typeSize) << "\n";
+        varAddr.size = typeSize;
+        emit(movTo64BitReg(reg, varAddr));
     } else if (auto var = dynamic_cast<VariableValP>(expr)) {
-        // If the expression is a variable, load its value from the stack into the register
-        VariableStackData varData = this->variableStack[var->var.name].top();
+        if (this->registerVariables.contains(var->var.name)) {
+            // If the expression is a register variable, copy its register
+            emit("mov", {dest, MachineOperand::makeReg(this->registerVariables[var->var.name])});
+            return;
+        }
 
-        std::string varAddr = sizeIdentifiers[varData.varSize] +
-                              " [" + getStackAddr(varData) + "]";
+        // If the expression is a variable, load its value from the stack into the register
+        VariableStackData varData = getVariableData(var->var);
 
-        this->programOut << movTo64BitReg(reg, varAddr, varData.varSize) << "\n";
+        emit(movTo64BitReg(reg, getStackAddr(varData, varData.varSize), var->nonNegative));
     } else if (auto logicalNot = dynamic_cast<LogicalNotExprP>(expr)) {
         // If the expression is a logical negation, evaluate the expression and set the register based on the result
         convertUniExprToRegister(logicalNot->expr, reg);
-        this->programOut << "test " << reg << ", " << reg << "\n";
-        this->programOut << "setz dl\n";
-        this->programOut << "movzx " << reg << " dl\n";
+        emit("test", {dest, dest});
+        emit("setz", {MachineOperand::makeReg("dl")});
+        emit("movzx", {dest, MachineOperand::makeReg("dl")});
     } else if (auto numericNeg = dynamic_cast<NumericNegExprP>(expr)) {
         // If the expression is a numeric negation, negate the value and store it in the register
         convertUniExprToRegister(numericNeg->expr, reg);
-        this->programOut << "neg " << reg << "\n";
+        emit("neg", {dest});
     }
 }
 
 void Generator::convertAddrExprToRegister(AddrExprP expr, const std::string &reg) {
+    MachineOperand dest = MachineOperand::makeReg(reg);
+
     if (auto addrStr = dynamic_cast<AddrStrExprP>(expr)) {
-        this->programOut << "mov " << reg << ", " << addrStr->value << "\n";
+        emit("mov", {dest, MachineOperand::makeLabel(addrStr->value)});
     } else if (auto addrVar = dynamic_cast<AddrVarExprP>(expr)) {
         if (auto subVar = dynamic_cast<SubscriptableVariableValP>(addrVar->addressable)) {
             // If subscriptable then used the 'getSubscriptableStackPosition' to get the address
-            std::string stackPos = getSubscriptableStackPosition(subVar, reg);
-            this->programOut << "lea " << reg << ", " << stackPos << "\n";
+            MachineOperand stackPos = getSubscriptableStackPosition(subVar, reg);
+            emit("lea", {dest, stackPos});
         } else {
             // Otherwise load as a regular variable
             Variable var = addrVar->addressable->var;
-            VariableStackData varData = this->variableStack[var.name].top();
 
-            std::string varBaseAddr = getStackAddr(varData);
+            if (this->registerVariables.contains(var.name)) {
+                // Register variables are pointers, their value is the address
+                emit("mov", {dest, MachineOperand::makeReg(this->registerVariables[var.name])});
+                return;
+            }
+
+            VariableStackData varData = getVariableData(var);
 
             if (var.ptrType) {
                 // If the variable is a pointer then the address is its value
-                this->programOut << "mov " << reg << ", QWORD [" << varBaseAddr << "]\n";
+                emit("mov", {dest, getStackAddr(varData, PTR_SIZE)});
             } else {
-                this->programOut << "lea " << reg << ", [" << varBaseAddr << "]\n";
+                emit("lea", {dest, getStackAddr(varData, 0)});
             }
         }
     }
 }
 
-std::unordered_map<ExprOperator, std::string> Generator::BinaryExprToAsmStrSteps = {
-        {ExprOperator::add,              "add rax, rbx\n"},
+std::unordered_map<ExprOperator, std::vector<MachineInstr>> Generator::BinaryExprToAsmSteps = {
+        {ExprOperator::div, {{"cqo", {}},
+                             {"idiv", {MachineOperand::makeReg("rbx")}}}},
 
-        {ExprOperator::sub,              "sub rax, rbx\n"},
-
-        {ExprOperator::mult,             "imul rbx\n"},
-
-        {ExprOperator::div,              "cqo\n"
-                                         "idiv rbx\n"},
-
-        {ExprOperator::mod,              "cqo\n"
-                                         "idiv rbx\n"
-                                         "mov rax, rdx\n"},
-
-        {ExprOperator::equals,           "xor rax, rbx\n"
-                                         "setz al\n"
-                                         "movzx rax, al\n"},
-
-        {ExprOperator::notEquals,        "xor rax, rbx\n"
-                                         "setnz al\n"
-                                         "movzx rax, al\n"},
-
-        {ExprOperator::biggerThan,       "cmp rax, rbx\n"
-                                         "setg al\n"
-                                         "movzx rax, al\n"},
+        {ExprOperator::mod, {{"cqo", {}},
+                             {"idiv", {MachineOperand::makeReg("rbx")}},
+                             {"mov", {MachineOperand::makeReg("rax"), MachineOperand::makeReg("rdx")}}}}
+};
 
-        {ExprOperator::biggerThanEquals, "cmp rax, rbx\n"
-                                         "setge al\n"
-                                         "movzx rax, al\n"},
+void Generator::convertBinaryExprToRegister(BinaryExprP expr) {
+    bool division = expr->op == ExprOperator::div || expr->op == ExprOperator::mod;
+    auto rightImInt = dynamic_cast<ImIntValP>(expr->right);
+    // The constant right operand, the divisor of a division
+    long long divisor = rightImInt ? std::stoll(rightImInt->value) : 0;
+    MachineOperand rax = MachineOperand::makeReg("rax");
+
+    // A non-negative value is divided by a power of two with a shift, and its remainder is masked
+    if (division && expr->nonNegative && std::has_single_bit((unsigned long long) divisor) &&
+        (expr->op == ExprOperator::div || divisor <= MAX_MASK_DIVISOR)) {
+        convertUniExprToRegister(expr->left, "rax");
+
+        if (expr->op == ExprOperator::mod) {
+            emit("and", {rax, MachineOperand::makeImm(divisor - 1)});
+        } else if (divisor > 1) {
+            emit("shr", {rax, MachineOperand::makeImm(std::countr_zero((unsigned long long) divisor))});
+        }
 
-        {ExprOperator::lessThan,         "cmp rax, rbx\n"
-                                         "setl al\n"
-                                         "movzx rax, al\n"},
+        return;
+    }
 
-        {ExprOperator::lessThanEquals,   "cmp rax, rbx\n"
-                                         "setle al\n"
-                                         "movzx rax, al\n"}
-};
+    // The first instruction selection pattern matching the expression computes it
+    for (const auto &pattern: selectionPatterns) {
+        if (pattern.op == expr->op && matchesOperandKind(expr->left, pattern.left) &&
+            matchesOperandKind(expr->right, pattern.right) &&
+            (!pattern.exactValue || (rightImInt && divisor == pattern.value))) {
+            generateAsmPattern(pattern, expr);
+            return;
+        }
+    }
 
-void Generator::convertBinaryExprToRegister(BinaryExprP expr) {
     // Convert the left and right operands of the binary expression to registers
     convertUniExprToRegister(expr->left, "rax");
     convertUniExprToRegister(expr->right, "rbx");
 
     // Determine the assembly code corresponding to the binary operation
-    if (BinaryExprToAsmStrSteps.contains(expr->op)) {
-        this->programOut << BinaryExprToAsmStrSteps[expr->op];
+    if (division && (expr->narrow || expr->nonNegative)) {
+        // Values known to fit in 32 bits use the faster 32 bit division, non-negative values the unsigned one,
+        // which zero extends its results
+        MachineOperand divisorReg = MachineOperand::makeReg(expr->narrow ? "ebx" : "rbx");
+
+        if (expr->nonNegative) {
+            emit("xor", {MachineOperand::makeReg("edx"), MachineOperand::makeReg("edx")});
+            emit("div", {divisorReg});
+
+            if (expr->op == ExprOperator::mod) {
+                emit("mov", {MachineOperand::makeReg(expr->narrow ? "eax" : "rax"),
+                             MachineOperand::makeReg(expr->narrow ? "edx" : "rdx")});
+            }
+        } else {
+            emit("cdq");
+            emit("idiv", {MachineOperand::makeReg("ebx")});
+            emit("movsxd", {rax, MachineOperand::makeReg(expr->op == ExprOperator::mod ? "edx" : "eax")});
+        }
+    } else if (BinaryExprToAsmSteps.contains(expr->op)) {
+        for (const auto &step: BinaryExprToAsmSteps[expr->op]) {
+            emit(step);
+        }
     } else if (expr->op == ExprOperator::logicalOr) {
         // Generate assembly code for logical OR operation with unique labels
         std::string orTrue = "orTrue" + std::to_string(++this->labelCount);
         std::string orFalse = "orFalse" + std::to_string(this->labelCount);
         std::string orEnd = "orEnd" + std::to_string(this->labelCount);
-
-        this->programOut << "test rax, rax\n" <<
-                         "jnz " << orTrue << "\n" <<
-                         "test rbx, rbx\n" <<
-                         "jz " << orFalse << "\n" <<
-                         orTrue << ":\n" <<
-                         "mov rax, 1\n"
-                         "jmp " << orEnd << "\n" <<
-                         orFalse << ":\n" <<
-                         "mov rax, 0\n" <<
-                         orEnd << ":\n";
+        MachineOperand rbx = MachineOperand::makeReg("rbx");
+
+        emit("test", {rax, rax});
+        emit("jnz", {MachineOperand::makeLabel(orTrue)});
+        emit("test", {rbx, rbx});
+        emit("jz", {MachineOperand::makeLabel(orFalse)});
+        emitLabel(orTrue);
+        emit("mov", {rax, MachineOperand::makeImm(1)});
+        emit("jmp", {MachineOperand::makeLabel(orEnd)});
+        emitLabel(orFalse);
+        emit("mov", {rax, MachineOperand::makeImm(0)});
+        emitLabel(orEnd);
     } else if (expr->op == ExprOperator::logicalAnd) {
         // Generate assembly code for logical AND operation with unique labels
         std::string andFalse = "andFalse" + std::to_string(++this->labelCount);
         std::string andEnd = "andEnd" + std::to_string(this->labelCount);
+        MachineOperand rbx = MachineOperand::makeReg("rbx");
+
+        emit("test", {rax, rax});
+        emit("jz", {MachineOperand::makeLabel(andFalse)});
+        emit("test", {rbx, rbx});
+        emit("jz", {MachineOperand::makeLabel(andFalse)});
+        emit("mov", {rax, MachineOperand::makeImm(1)});
+        emit("jmp", {MachineOperand::makeLabel(andEnd)});
+        emitLabel(andFalse);
+        emit("mov", {rax, MachineOperand::makeImm(0)});
+        emitLabel(andEnd);
+    }
+}
+
+bool Generator::fitsImmediate(long long value) {
+    return value >= INT32_MIN && value <= INT32_MAX;
+}
+
+bool Generator::matchesOperandKind(UniExprP operand, OperandKind kind) {
+    auto imInt = dynamic_cast<ImIntValP>(operand);
+    long long value = imInt ? std::stoll(imInt->value) : 0;
+
+    if (kind == OperandKind::immediate) {
+        return imInt && fitsImmediate(value);
+    } else if (kind == OperandKind::powerOfTwo) {
+        return imInt && value > 0 && std::has_single_bit((unsigned long long) value);
+    } else if (kind == OperandKind::reg) {
+        auto var = dynamic_cast<VariableValP>(operand);
+
+        return var && !dynamic_cast<SubscriptableVariableValP>(var) && this->registerVariables.contains(var->var.name);
+    }
+
+    return true;
+}
+
+std::optional<MachineOperand> Generator::getDirectOperand(UniExprP operand, int size) {
+    if (auto imInt = dynamic_cast<ImIntValP>(operand)) {
+        long long value = std::stoll(imInt->value);
+
+        if (fitsImmediate(value)) return MachineOperand::makeImm(value);
+    } else if (auto temp = dynamic_cast<UniTempP>(operand)) {
+        MachineOperand slot = getTempAddr(temp->id);
+
+        slot.size = size;
+        return slot;
+    } else if (auto var = dynamic_cast<VariableValP>(operand)) {
+        if (dynamic_cast<SubscriptableVariableValP>(var)) return std::nullopt;
+
+        if (this->registerVariables.contains(var->var.name)) {
+            return MachineOperand::makeReg(MachineOperand::partialRegister(this->registerVariables[var->var.name],
+                                                                           size));
+        }
+
+        // Narrower variables are sign extended when loaded, the low bytes of a wider one are read in place
+        VariableStackData varData = getVariableData(var->var);
 
-        this->programOut << "test rax, rax\n" <<
-                         "jz " << andFalse << "\n" <<
-                         "test rbx, rbx\n" <<
-                         "jz " << andFalse << "\n" <<
-                         "mov rax, 1\n"
-                         "jmp " << andEnd << "\n" <<
-                         andFalse << ":\n" <<
-                         "mov rax, 0\n" <<
-                         andEnd << ":\n";
+        if (varData.varSize >= size) return getStackAddr(varData, size);
+    }
+
+    return std::nullopt;
+}
+
+MachineOperand Generator::getOperand(UniExprP operand, const std::string &scratchReg, int size) {
+    std::optional<MachineOperand> direct = getDirectOperand(operand, size);
+
+    if (direct) return *direct;
+
+    convertUniExprToRegister(operand, scratchReg);
+    return MachineOperand::makeReg(MachineOperand::partialRegister(scratchReg, size));
+}
+
+void Generator::generateAsmPattern(const SelectionPattern &pattern, BinaryExprP expr) {
+    // A result known to be non-negative and to fit in 32 bits is computed on the 32 bit registers, writing them
+    // clears the upper halves
+    int size = expr->narrowResult ? BIT_32_REG_SIZE : BIT_64_REG_SIZE;
+    MachineOperand result = MachineOperand::makeReg(MachineOperand::partialRegister("rax", size));
+    MachineOperand left = result;
+    MachineOperand right;
+    std::optional<MachineOperand> directLeft;
+
+    if (pattern.left == OperandKind::reg) {
+        const std::string &reg = this->registerVariables[dynamic_cast<VariableValP>(expr->left)->var.name];
+
+        left = MachineOperand::makeReg(MachineOperand::partialRegister(reg, size));
+    } else if (expr->narrowResult && !dynamic_cast<UniTempP>(expr->left) &&
+               (directLeft = getDirectOperand(expr->left, size))) {
+        // Only the low half of the left operand is used, a temporary is still loaded whole so the load of a value
+        // just stored is forwarded
+        emit("mov", {result, *directLeft});
+    } else {
+        convertUniExprToRegister(expr->left, "rax");
+    }
+
+    if (pattern.right == OperandKind::reg) {
+        const std::string &reg = this->registerVariables[dynamic_cast<VariableValP>(expr->right)->var.name];
+
+        right = MachineOperand::makeReg(MachineOperand::partialRegister(reg, size));
+    } else if (pattern.right == OperandKind::any) {
+        right = getOperand(expr->right, "rbx", size);
+    } else {
+        right = MachineOperand::makeImm(std::stoll(dynamic_cast<ImIntValP>(expr->right)->value));
+    }
+
+    // Fill in the operands of the pattern's instructions
+    for (const PatternInstr &patternInstr: pattern.instrs) {
+        if (patternInstr.opcode.empty()) break;
+
+        std::vector<MachineOperand> operands;
+
+        for (PatternOperand operand: patternInstr.operands) {
+            if (operand == PatternOperand::none) break;
+
+            if (operand == PatternOperand::rax) {
+                operands.push_back(result);
+            } else if (operand == PatternOperand::eax || operand == PatternOperand::al) {
+                operands.push_back(MachineOperand::makeReg(operand == PatternOperand::eax ? "eax" : "al"));
+            } else if (operand == PatternOperand::left) {
+                operands.push_back(left);
+            } else if (operand == PatternOperand::right) {
+                operands.push_back(right);
+            } else if (operand == PatternOperand::shift) {
+                operands.push_back(MachineOperand::makeImm(std::countr_zero((unsigned long long) right.value)));
+            } else if (operand == PatternOperand::leftPlusRight) {
+                // The right operand is an immediate displacement or an index register, addresses use the 64 bit ones
+                operands.push_back(right.isImm() ? MachineOperand::makeMem(0, left.fullReg(), right.value)
+                                                 : MachineOperand::makeMem(0, left.fullReg(), 0, right.fullReg()));
+            } else {
+                operands.push_back(MachineOperand::makeMem(0, left.fullReg(), 0, left.fullReg(),
+                                                           (int) pattern.value - 1));
+            }
+        }
+
+        emit(std::string(patternInstr.opcode), std::move(operands));
     }
 }
 
@@ -253,6 +493,8 @@ void Generator::convertTAExprToRaxRegister(ThreeAddressExprP expr) {
         convertAddrExprToRegister(addr, "rax");
     } else if (auto binary = dynamic_cast<BinaryExprP>(expr)) {
         convertBinaryExprToRegister(binary);
+    } else if (auto select = dynamic_cast<SelectExprP>(expr)) {
+        convertSelectExprToRegister(select);
     }
 }
 
@@ -274,117 +516,260 @@ void Generator::convertTAStmtToAsm(ThreeAddressStmtP taStmt) {
         convertGotoIfZeroToAsm(gotoIfZeroStmt);
     } else if (auto gotoIfNotZeroStmt = dynamic_cast<GotoIfNotZeroStmtP>(taStmt)) {
         convertGotoIfNotZeroToAsm(gotoIfNotZeroStmt);
+    } else if (auto gotoIfCompareStmt = dynamic_cast<GotoIfCompareStmtP>(taStmt)) {
+        convertGotoIfCompareToAsm(gotoIfCompareStmt);
     } else if (auto setReturnValue = dynamic_cast<SetReturnValueStmtP>(taStmt)) {
         convertSetReturnValueToAsm(setReturnValue);
-    } else if (auto scopeEnter = dynamic_cast<ScopeEnterStmtP>(taStmt)) {
-        convertScopeEnterToAsm(scopeEnter);
-    } else if (auto scopeExit = dynamic_cast<ScopeExitStmtP>(taStmt)) {
-        convertScopeExitToAsm();
     } else if (auto functionDeclaration = dynamic_cast<FunctionDeclarationStmtP>(taStmt)) {
         convertFunctionDeclarationToAsm(functionDeclaration);
     } else if (auto functionExit = dynamic_cast<FunctionExitStmtP>(taStmt)) {
         convertFunctionExitToAsm();
+    } else if (auto vectorLoad = dynamic_cast<VectorLoadStmtP>(taStmt)) {
+        convertVectorLoadToAsm(vectorLoad);
+    } else if (auto vectorStore = dynamic_cast<VectorStoreStmtP>(taStmt)) {
+        convertVectorStoreToAsm(vectorStore);
+    } else if (auto vectorBroadcast = dynamic_cast<VectorBroadcastStmtP>(taStmt)) {
+        convertVectorBroadcastToAsm(vectorBroadcast);
+    } else if (auto vectorBinary = dynamic_cast<VectorBinaryStmtP>(taStmt)) {
+        convertVectorBinaryToAsm(vectorBinary);
+    } else if (auto vectorReduce = dynamic_cast<VectorReduceStmtP>(taStmt)) {
+        convertVectorReduceToAsm(vectorReduce);
     }
 }
 
 void Generator::convertTempAssignmentToAsm(TempAssignmentTAStmtP tempAssignment) {
+    MachineOperand rax = MachineOperand::makeReg("rax");
+
     if (auto funcCall = dynamic_cast<FunctionCallExprP>(tempAssignment->expr)) {
         // Convert the function call to assembly
         generateAsmFunctionCall(funcCall->functionName);
 
         int retSize = sizeByTypeAndPtr(funcCall->retType, funcCall->retPtr, 0);
 
-        if (retSize < BIT_64_REG_SIZE) {
-            this->programOut << "movsx rax, " << getAxRegisterBySize(retSize) << "\n";
+        if (retSize < BIT_64_REG_SIZE && !funcCall->retExtended) {
+            emit("movsx", {rax, MachineOperand::makeReg(getAxRegisterBySize(retSize))});
         }
-
-        // Restore the Stack Pointer counter to the state before the
-        // function call, changed by the function push params
-        currentRelativeSP -= FuncParamsOffsetSP;
-        FuncParamsOffsetSP = 0;
     } else {
+        auto binary = dynamic_cast<BinaryExprP>(tempAssignment->expr);
+        auto binaryLeftTemp = binary ? dynamic_cast<UniTempP>(binary->left) : nullptr;
+
+        // Stepping a temporary by a constant is done in place
+        if (binaryLeftTemp && binaryLeftTemp->id == tempAssignment->id &&
+            generateAsmStepInPlace(binary, getTempAddr(tempAssignment->id), TEMP_SIZE)) {
+            return;
+        }
+
         // Convert the expression to the 'rax' register
         convertTAExprToRaxRegister(tempAssignment->expr);
     }
 
-    this->programOut << "mov QWORD [rbp - " << (tempAssignment->id * TEMP_SIZE) << "], rax\n";
+    emit("mov", {getTempAddr(tempAssignment->id), rax});
 }
 
 void Generator::convertVarAssignmentToAsm(VarAssignmentTAStmtP varAssignmentStmt) {
+    const std::string &varName = varAssignmentStmt->var->var.name;
+
+    if (this->registerVariables.contains(varName) &&
+        !dynamic_cast<SubscriptableVariableValP>(varAssignmentStmt->var)) {
+        MachineOperand varReg = MachineOperand::makeReg(this->registerVariables[varName]);
+        auto binary = dynamic_cast<BinaryExprP>(varAssignmentStmt->expr);
+        auto binaryLeftVar = binary ? dynamic_cast<VariableValP>(binary->left) : nullptr;
+
+        // Stepping a register variable by a constant is done in place
+        if (binaryLeftVar && binaryLeftVar->var.name == varName &&
+            !dynamic_cast<SubscriptableVariableValP>(binaryLeftVar) &&
+            generateAsmStepInPlace(binary, varReg, BIT_64_REG_SIZE)) {
+            return;
+        }
+
+        convertTAExprToRaxRegister(varAssignmentStmt->expr);
+        emit("mov", {varReg, MachineOperand::makeReg("rax")});
+        return;
+    }
+
+    auto binary = dynamic_cast<BinaryExprP>(varAssignmentStmt->expr);
+    auto binaryLeftVar = binary ? dynamic_cast<VariableValP>(binary->left) : nullptr;
+
+    // Stepping a stack variable by a constant is done in place, on its own bytes
+    if (binaryLeftVar && binaryLeftVar->var.name == varName &&
+        !dynamic_cast<SubscriptableVariableValP>(binaryLeftVar) &&
+        !dynamic_cast<SubscriptableVariableValP>(varAssignmentStmt->var)) {
+        VariableStackData varData = getVariableData(varAssignmentStmt->var->var);
+
+        if (generateAsmStepInPlace(binary, getStackAddr(varData, varData.varSize), varData.varSize)) {
+            return;
+        }
+    }
+
     // Convert the expression to the 'rax' register
     convertTAExprToRaxRegister(varAssignmentStmt->expr);
 
-    // Retrieve the current VariableStackData for the variable name
-    VariableStackData varData = this->variableStack[varAssignmentStmt->var->var.name].top();
-
     // Determine the address and size of the assigned variable on the stack
-    std::string varStackAddr = "[" + getStackAddr(varData) + "]";
-
-    int typeSize = varData.varSize;
+    MachineOperand varStackAddr;
 
     if (auto subVar = dynamic_cast<SubscriptableVariableValP>(varAssignmentStmt->var)) {
         varStackAddr = getSubscriptableStackPosition(subVar, "rbx");
 
         if (subVar->var.ptrType) {
-            typeSize = typeSizes[subVar->var.type];
+            varStackAddr.size = typeSizes[subVar->var.type];
+        } else {
+            varStackAddr.size = getVariableData(varAssignmentStmt->var->var).varSize;
         }
+    } else {
+        // Retrieve the VariableStackData for the variable's offset in the frame
+        VariableStackData varData = getVariableData(varAssignmentStmt->var->var);
+
+        varStackAddr = getStackAddr(varData, varData.varSize);
+    }
+
+    emit("mov", {varStackAddr, MachineOperand::makeReg(getAxRegisterBySize(varStackAddr.size))});
+}
+
+bool Generator::generateAsmStepInPlace(BinaryExprP binary, const MachineOperand &dest, int size) {
+    auto rightImInt = binary ? dynamic_cast<ImIntValP>(binary->right) : nullptr;
+
+    if (!rightImInt || (binary->op != ExprOperator::add && binary->op != ExprOperator::sub)) return false;
+
+    long long value = std::stoll(rightImInt->value);
+    long long step = value;
+    // The immediate must fit in the destination, a narrow variable only keeps the low bytes of the sum anyway
+    long long limit = size < 4 ? 1LL << (size * 8 - 1) : 1LL << 31;
+
+    if (step < -limit || step >= limit) return false;
+
+    if (binary->op == ExprOperator::sub) step = -step;
+
+    if (step == 1 || step == -1) {
+        emit(step == 1 ? "inc" : "dec", {dest});
+    } else {
+        emit(binary->op == ExprOperator::add ? "add" : "sub", {dest, MachineOperand::makeImm(value)});
     }
 
-    this->programOut << "mov " << sizeIdentifiers[typeSize] <<
-                     " " << varStackAddr << ", " << getAxRegisterBySize(typeSize) << "\n";
+    return true;
 }
 
 void Generator::convertFunctionParamPushToAsm(FunctionParamPushStmtP funcParamPushStmt) {
+    if (funcParamPushStmt->argRegister >= 0) {
+        pendingRegisterArgs.push_back(funcParamPushStmt);
+        return;
+    }
+
+    // Allocate the call's whole argument block at its first push
+    if (funcParamPushStmt->argsSize > 0) {
+        emit("sub", {MachineOperand::makeReg("rsp"), MachineOperand::makeImm(funcParamPushStmt->argsSize)});
+    }
+
     // Convert the expression to the 'rax' register
     convertTAExprToRaxRegister(funcParamPushStmt->expr);
 
-    // Determine the size to push onto the stack based on the variable type and pointer status
+    // Determine the size to store based on the variable type and pointer status
     int sizeToPush = sizeByTypeAndPtr(funcParamPushStmt->varType, funcParamPushStmt->isPtr, 0);
 
-    // Update the current relative stack pointer
-    currentRelativeSP += sizeToPush;
-    // Update the size of the offset of the params
-    FuncParamsOffsetSP += sizeToPush;
-
-    // Generate assembly code to adjust the stack pointer and move the value onto the stack
-    this->programOut << "sub rsp, " << sizeToPush << "\n";
-    this->programOut << "mov " << sizeIdentifiers[sizeToPush]
-                     << " [rbp - " << currentRelativeSP << "], "
-                     << getAxRegisterBySize(sizeToPush) << "\n";
+    // Store the value at the argument's fixed offset in the block
+    emit("mov", {MachineOperand::makeMem(sizeToPush, "rsp", funcParamPushStmt->argOffset),
+                 MachineOperand::makeReg(getAxRegisterBySize(sizeToPush))});
 }
 
 void Generator::convertFunctionCallToAsm(FunctionCallExprP functionCallStmt) {
     // Convert the function call to assembly
-    generateAsmFunctionCall(functionCallStmt->functionName);
-
-    // Restore the Stack Pointer counter to the state before the
-    // function call, changed by the function push params
-    currentRelativeSP -= FuncParamsOffsetSP;
-    FuncParamsOffsetSP = 0;
+    if (functionCallStmt->tailCall) {
+        generateAsmTailCall(functionCallStmt->functionName);
+    } else {
+        generateAsmFunctionCall(functionCallStmt->functionName);
+    }
 }
 
 void Generator::convertLabelToAsm(LabelStmtP labelStmt) {
-    this->programOut << labelStmt->labelName << ":\n";
+    emitLabel(labelStmt->labelName);
 }
 
 void Generator::convertGotoToAsm(GotoStmtP gotoStmt) {
-    this->programOut << "jmp " << gotoStmt->labelName << "\n";
+    emit("jmp", {MachineOperand::makeLabel(gotoStmt->labelName)});
 }
 
 void Generator::convertGotoIfZeroToAsm(GotoIfZeroStmtP gotoIfZeroStmt) {
-    // Convert the expression to the 'rax' register
-    convertTAExprToRaxRegister(gotoIfZeroStmt->expr);
+    generateAsmTestZero(gotoIfZeroStmt->expr);
 
-    this->programOut << "test rax, rax\n"
-                        "jz " << gotoIfZeroStmt->labelName << "\n";
+    emit("jz", {MachineOperand::makeLabel(gotoIfZeroStmt->labelName)});
 }
 
 void Generator::convertGotoIfNotZeroToAsm(GotoIfNotZeroStmtP gotoIfNotZeroStmt) {
-    // Convert the expression to the 'rax' register
-    convertTAExprToRaxRegister(gotoIfNotZeroStmt->expr);
+    generateAsmTestZero(gotoIfNotZeroStmt->expr);
+
+    emit("jnz", {MachineOperand::makeLabel(gotoIfNotZeroStmt->labelName)});
+}
+
+void Generator::generateAsmTestZero(ThreeAddressExprP expr) {
+    auto temp = dynamic_cast<UniTempP>(expr);
+    auto var = dynamic_cast<VariableValP>(expr);
+    MachineOperand zero = MachineOperand::makeImm(0);
+
+    if (var && !dynamic_cast<SubscriptableVariableValP>(var) && this->registerVariables.contains(var->var.name)) {
+        MachineOperand varReg = MachineOperand::makeReg(this->registerVariables[var->var.name]);
+
+        emit("test", {varReg, varReg});
+    } else if (var && !dynamic_cast<SubscriptableVariableValP>(var) &&
+               sizeIdentifiers.contains(getVariableData(var->var).varSize)) {
+        // A variable of any size is zero when all of its bytes are
+        VariableStackData varData = getVariableData(var->var);
+
+        emit("cmp", {getStackAddr(varData, varData.varSize), zero});
+    } else if (temp) {
+        emit("cmp", {getTempAddr(temp->id), zero});
+    } else {
+        MachineOperand rax = MachineOperand::makeReg("rax");
+
+        // Convert the expression to the 'rax' register
+        convertTAExprToRaxRegister(expr);
 
-    this->programOut << "test rax, rax\n"
-                        "jnz " << gotoIfNotZeroStmt->labelName << "\n";
+        emit("test", {rax, rax});
+    }
+}
+
+std::unordered_map<ExprOperator, std::string> Generator::conditionCodes = {
+        {ExprOperator::equals,           "e"},
+        {ExprOperator::notEquals,        "ne"},
+        {ExprOperator::biggerThan,       "g"},
+        {ExprOperator::biggerThanEquals, "ge"},
+        {ExprOperator::lessThan,         "l"},
+        {ExprOperator::lessThanEquals,   "le"}
+};
+
+void Generator::generateAsmCompare(BinaryExprP comparison) {
+    auto rightImInt = dynamic_cast<ImIntValP>(comparison->right);
+    bool rightImmediate = matchesOperandKind(comparison->right, OperandKind::immediate);
+    std::optional<MachineOperand> left = getDirectOperand(comparison->left);
+
+    // 'cmp' compares a register or a stack slot, and at most one of its operands is in memory
+    if (!matchesOperandKind(comparison->left, OperandKind::reg) && !(rightImmediate && left && left->isMem())) {
+        convertUniExprToRegister(comparison->left, "rax");
+        left = MachineOperand::makeReg("rax");
+    }
+
+    if (rightImmediate && std::stoll(rightImInt->value) == 0 && !left->isMem()) {
+        // Testing a register sets the flags as comparing it with zero, with a shorter instruction
+        emit("test", {*left, *left});
+    } else {
+        emit("cmp", {*left, getOperand(comparison->right, "rbx")});
+    }
+}
+
+void Generator::convertGotoIfCompareToAsm(GotoIfCompareStmtP gotoIfCompareStmt) {
+    generateAsmCompare(gotoIfCompareStmt->comparison);
+
+    emit("j" + conditionCodes[gotoIfCompareStmt->comparison->op],
+         {MachineOperand::makeLabel(gotoIfCompareStmt->labelName)});
+}
+
+void Generator::convertSelectExprToRegister(SelectExprP select) {
+    generateAsmCompare(select->comparison);
+
+    // Moving the values leaves the flags of the comparison as they are
+    convertUniExprToRegister(select->trueValue, "rcx");
+    convertUniExprToRegister(select->falseValue, "rax");
+
+    emit("cmov" + conditionCodes[select->comparison->op],
+         {MachineOperand::makeReg("rax"), MachineOperand::makeReg("rcx")});
 }
 
 void Generator::convertSetReturnValueToAsm(SetReturnValueStmtP setReturnValueStmt) {
@@ -392,96 +777,380 @@ void Generator::convertSetReturnValueToAsm(SetReturnValueStmtP setReturnValueStm
     convertTAExprToRaxRegister(setReturnValueStmt->expr);
 }
 
-void Generator::convertScopeEnterToAsm(ScopeEnterStmtP scopeEnterStmt) {
-    // Initialize variables to track frame size and frame variables
-    std::vector<std::string> frameVars;
-    int frameSize = 0;
+void Generator::convertFunctionDeclarationToAsm(FunctionDeclarationStmtP functionDeclarationStmt) {
+    // Clear the register variables to prepare for the new function
+    registerVariables.clear();
+    savedRegisters.clear();
+    usesYmmRegisters = false;
+    currentFunction = functionDeclarationStmt;
+    machineFunctions.emplace_back(functionDeclarationStmt->name);
+
+    emitLabel(functionDeclarationStmt->name, "FUNCTION");
+
+    if (functionDeclarationStmt->memoRange > 0) generateAsmMemoLookup(functionDeclarationStmt);
+
+    // Generate assembly code for function prologue, a leaf function can't recurse and keeps its frame in the red
+    // zone, it needs neither
+    if (!functionDeclarationStmt->leaf) {
+        emit("cmp", {MachineOperand::makeReg("r10"), MachineOperand::makeImm(STACK_OVERFLOW_LIMIT)});
+        emit("jae", {MachineOperand::makeLabel("_overflow")});
+        emit("push", {MachineOperand::makeReg("rbp")});
+        emit("mov", {MachineOperand::makeReg("rbp"), MachineOperand::makeReg("rsp")});
+    }
 
-    // Process each variable in the scope
-    for (auto &var: scopeEnterStmt->vars) {
-        int varSize = sizeByTypeAndPtr(var.type, var.ptrType, var.arrSize);
+    // Allocate the whole frame laid out for the function, the variables of all its scopes included
+    if (functionDeclarationStmt->frameSize > 0 && !functionDeclarationStmt->leaf) {
+        emit("sub", {MachineOperand::makeReg("rsp"), MachineOperand::makeImm(functionDeclarationStmt->frameSize)});
+    }
+
+    // Save the callee-saved registers given to the register variables right below the temporaries
+    for (size_t i = 0; i < functionDeclarationStmt->registerVars.size(); ++i) {
+        const std::string &reg = VARIABLE_REGISTERS[i];
+        int offset = (functionDeclarationStmt->maxTemp + (int) i + 1) * BIT_64_REG_SIZE;
 
-        // Add variable to frame variables and update frame size
-        frameVars.push_back(var.name);
-        frameSize += varSize;
+        registerVariables[functionDeclarationStmt->registerVars[i].name] = reg;
+        savedRegisters.emplace_back(reg, offset);
 
-        // Update the stack pointer to allocate space for the variable
-        currentRelativeSP += varSize;
-        // Push variable information to the variable stack
-        variableStack[var.name].push(VariableStackData(-currentRelativeSP,
-                                                       sizeByTypeAndPtr(var.type,
-                                                                        var.ptrType, 0)));
+        emit("mov", {getFrameAddr(-offset, BIT_64_REG_SIZE), MachineOperand::makeReg(reg)});
     }
 
-    // Create a new scope frame and push it onto the scope frame stack
-    scopeFrameStack.push(ScopeFrame(frameSize, frameVars));
+    // Store the parameters passed in registers to their slots, they are addressed like the others
+    for (int i = 0; i < functionDeclarationStmt->registerParams; ++i) {
+        emit("mov", {getFrameAddr(functionDeclarationStmt->params[i].frameOffset, BIT_64_REG_SIZE),
+                     MachineOperand::makeReg(ARG_REGISTERS[i])});
+    }
 
-    // If frame size is greater than zero, adjust the stack pointer (rsp)
-    if (frameSize > 0) {
-        this->programOut << "sub rsp, " << frameSize << "\n";
+    // Keep the entry found by the lookup for the store at the function's exit
+    if (functionDeclarationStmt->memoRange > 0) {
+        emit("mov", {getTempAddr(functionDeclarationStmt->memoTemp), MachineOperand::makeReg("rax")});
     }
+
+    // Store the total size of parameters, released by the 'ret' instruction
+    this->paramsSize = FrameLayout::paramsSize(functionDeclarationStmt);
 }
 
-void Generator::convertScopeExitToAsm() {
-    // Retrieve the top scope frame from the scope frame stack
-    ScopeFrame scopeFrame = scopeFrameStack.top();
+void Generator::convertFunctionExitToAsm() {
+    if (currentFunction->memoRange > 0) generateAsmMemoStore();
+
+    generateAsmFrameRelease();
+
+    emit("ret", {MachineOperand::makeImm(this->paramsSize)});
+}
 
-    // Remove variables of the exiting scope from the variable stack
-    for (auto &frameVar: scopeFrame.frameVars) {
-        variableStack[frameVar].pop();
+void Generator::generateAsmFrameRelease() {
+    for (const auto &savedRegister: savedRegisters) {
+        emit("mov", {MachineOperand::makeReg(savedRegister.first),
+                     getFrameAddr(-savedRegister.second, BIT_64_REG_SIZE)});
     }
 
-    // If the frame size is greater than zero, adjust the stack pointer (rsp) to deallocate stack space
-    if (scopeFrame.frameSize > 0) {
-        currentRelativeSP -= scopeFrame.frameSize;
-        this->programOut << "add rsp, " << scopeFrame.frameSize << "\n";
+    // Avoid the penalty of mixing SSE instructions with dirty upper halves in the caller
+    if (usesYmmRegisters) {
+        emit("vzeroupper");
     }
 
-    scopeFrameStack.pop();
+    if (!currentFunction->leaf) {
+        emit("leave");
+    }
 }
 
-void Generator::convertFunctionDeclarationToAsm(FunctionDeclarationStmtP functionDeclarationStmt) {
-    // Clear the variable stack to prepare for the new function
-    variableStack.clear();
+void Generator::generateAsmMemoLookup(FunctionDeclarationStmtP functionDeclarationStmt) {
+    const std::string &name = functionDeclarationStmt->name;
+    int range = functionDeclarationStmt->memoRange;
+    MachineOperand rax = MachineOperand::makeReg("rax");
+    MachineOperand rcx = MachineOperand::makeReg("rcx");
+    MachineOperand rdx = MachineOperand::makeReg("rdx");
+    MachineOperand memoMiss = MachineOperand::makeLabel(name + "MemoMiss");
 
-    // Generate assembly code for function prologue
-    this->programOut << functionDeclarationStmt->name << ":     ; FUNCTION\n"
-                     << "cmp r8, " << STACK_OVERFLOW_LIMIT << "\n"
-                                                              "jae _overflow\n"
-                                                              "push rbp\n"
-                                                              "mov rbp, rsp\n";
+    emit("mov", {rax, MachineOperand::makeImm(-1)});
+
+    // The entry is the arguments' value as digits in base 'range', the first parameter's the most significant
+    for (size_t i = 0; i < functionDeclarationStmt->params.size(); ++i) {
+        const Variable &param = functionDeclarationStmt->params[i];
+        int paramSize = sizeByTypeAndPtr(param.type, param.ptrType, 0);
 
-    // Calculate the size of local temporaries needed for the function
-    currentRelativeSP = functionDeclarationStmt->maxTemp * TEMP_SIZE;
+        if ((int) i < functionDeclarationStmt->registerParams) {
+            // The register holds the argument's value extended from whatever it was computed as, keep the bytes
+            // of the parameter's type like its slot does
+            emit("mov", {rcx, MachineOperand::makeReg(ARG_REGISTERS[i])});
 
-    // Allocate stack space for local temporaries if needed
-    if (currentRelativeSP > 0) {
-        this->programOut << "sub rsp, " << currentRelativeSP << "\n";
+            if (paramSize == 1) emit("movsx", {rcx, MachineOperand::makeReg("cl")});
+            if (paramSize == 4) emit("movsxd", {rcx, MachineOperand::makeReg("ecx")});
+        } else {
+            // The parameters are right above the return address, the frame is not built yet
+            int paramOffset = param.frameOffset - BIT_64_REG_SIZE;
+
+            emit(movTo64BitReg("rcx", MachineOperand::makeMem(paramSize, "rsp", paramOffset)));
+        }
+
+        emit("cmp", {rcx, MachineOperand::makeImm(range)});
+        emit("jae", {memoMiss});
+
+        if (i == 0) {
+            emit("mov", {rdx, rcx});
+        } else {
+            emit("imul", {rdx, rdx, MachineOperand::makeImm(range)});
+            emit("add", {rdx, rcx});
+        }
     }
 
-    // Initialize parameters on the variables stack with the correct offset
-    int paramOffset = BIT_64_REG_SIZE * 2;
+    // The tables are addressed from their symbols
+    MachineOperand memoSet = MachineOperand::makeMem(1, "rax", 0);
+    MachineOperand memoValue = MachineOperand::makeMem(BIT_64_REG_SIZE, "", 0, "rax", BIT_64_REG_SIZE);
 
-    for (const auto &param: functionDeclarationStmt->params) {
-        int paramSize = sizeByTypeAndPtr(param.type, param.ptrType, 0);
+    memoSet.name = name + "MemoSet";
+    memoValue.name = name + "MemoValues";
 
-        variableStack[param.name].push(VariableStackData(paramOffset, paramSize));
-        paramOffset += paramSize;
+    emit("mov", {rax, rdx});
+    emit("cmp", {memoSet, MachineOperand::makeImm(0)});
+    emit("je", {memoMiss});
+    emit("mov", {rax, memoValue});
+    emit("ret", {MachineOperand::makeImm(FrameLayout::paramsSize(functionDeclarationStmt))});
+    emitLabel(memoMiss.name);
+}
+
+void Generator::generateAsmMemoStore() {
+    const std::string &name = currentFunction->name;
+    MachineOperand rcx = MachineOperand::makeReg("rcx");
+    MachineOperand memoValue = MachineOperand::makeMem(BIT_64_REG_SIZE, "", 0, "rcx", BIT_64_REG_SIZE);
+    MachineOperand memoSet = MachineOperand::makeMem(1, "rcx", 0);
+
+    memoValue.name = name + "MemoValues";
+    memoSet.name = name + "MemoSet";
+
+    emit("mov", {rcx, getTempAddr(currentFunction->memoTemp)});
+    emit("test", {rcx, rcx});
+    emit("js", {MachineOperand::makeLabel(name + "MemoDone")});
+    emit("mov", {memoValue, MachineOperand::makeReg("rax")});
+    emit("mov", {memoSet, MachineOperand::makeImm(1)});
+    emitLabel(name + "MemoDone");
+}
+
+int Generator::memoTableSize(FunctionDeclarationStmtP functionDeclarationStmt) {
+    int size = 1;
+
+    for (size_t i = 0; i < functionDeclarationStmt->params.size(); ++i) {
+        size *= functionDeclarationStmt->memoRange;
     }
 
-    // Calculate and store the total size of parameters
-    this->paramsSize = paramOffset - (BIT_64_REG_SIZE * 2);
+    return size;
 }
 
-void Generator::convertFunctionExitToAsm() {
-    this->programOut << "leave\n"
-                        "ret " << this->paramsSize << "\n\n";
+std::string Generator::getVectorRegister(int reg, int width) {
+    return (width == YMM_REG_SIZE ? "ymm" : "xmm") + std::to_string(reg);
+}
+
+void Generator::generateVectorOperation(VectorOperator op, int elementSize, bool avx, const std::string &dest,
+                                        const std::string &left, const std::string &right) {
+    // The scratch registers have the same width as the destination
+    std::string prefix = dest.substr(0, 3);
+    MachineOperand mask = MachineOperand::makeReg(prefix + std::to_string(VECTOR_MASK_REG));
+    MachineOperand destReg = MachineOperand::makeReg(dest);
+    MachineOperand leftReg = MachineOperand::makeReg(left);
+    MachineOperand rightReg = MachineOperand::makeReg(right);
+    std::string suffix = packedSuffixes[elementSize];
+    bool isMax = op == VectorOperator::max;
+
+    if (avx) {
+        if (op == VectorOperator::add || op == VectorOperator::sub) {
+            emit((op == VectorOperator::add ? "vpadd" : "vpsub") + suffix, {destReg, leftReg, rightReg});
+        } else if (elementSize != BIT_64_REG_SIZE) {
+            emit((isMax ? "vpmaxs" : "vpmins") + suffix, {destReg, leftReg, rightReg});
+        } else {
+            // There is no 64 bit minimum or maximum, select the left lanes where they win the comparison
+            emit("vpcmpgtq", {mask, isMax ? leftReg : rightReg, isMax ? rightReg : leftReg});
+            emit("vpblendvb", {destReg, rightReg, leftReg, mask});
+        }
+
+        return;
+    }
+
+    if (op == VectorOperator::add || op == VectorOperator::sub) {
+        if (dest != left) {
+            emit("movdqa", {destReg, leftReg});
+        }
+
+        emit((op == VectorOperator::add ? "padd" : "psub") + suffix, {destReg, rightReg});
+        return;
+    }
+
+    // SSE2 only has a 16 bit signed minimum and maximum, mask the left lanes that win the comparison
+    // and combine them with the rest of the right lanes
+    MachineOperand blend = MachineOperand::makeReg(prefix + std::to_string(VECTOR_BLEND_REG));
+
+    emit("movdqa", {mask, isMax ? leftReg : rightReg});
+    emit("pcmpgt" + suffix, {mask, isMax ? rightReg : leftReg});
+    emit("movdqa", {blend, leftReg});
+    emit("pand", {blend, mask});
+    emit("pandn", {mask, rightReg});
+    emit("por", {mask, blend});
+    emit("movdqa", {destReg, mask});
+}
+
+void Generator::convertVectorLoadToAsm(VectorLoadStmtP vectorLoadStmt) {
+    MachineOperand stackPos = getSubscriptableStackPosition(vectorLoadStmt->source, "rbx");
+    bool avx = vectorLoadStmt->width == YMM_REG_SIZE;
+
+    usesYmmRegisters |= avx;
+
+    emit(avx ? "vmovdqu" : "movdqu",
+         {MachineOperand::makeReg(getVectorRegister(vectorLoadStmt->reg, vectorLoadStmt->width)), stackPos});
+}
+
+void Generator::convertVectorStoreToAsm(VectorStoreStmtP vectorStoreStmt) {
+    MachineOperand stackPos = getSubscriptableStackPosition(vectorStoreStmt->target, "rbx");
+    bool avx = vectorStoreStmt->width == YMM_REG_SIZE;
+
+    usesYmmRegisters |= avx;
+
+    emit(avx ? "vmovdqu" : "movdqu",
+         {stackPos, MachineOperand::makeReg(getVectorRegister(vectorStoreStmt->reg, vectorStoreStmt->width))});
+}
+
+void Generator::convertVectorBroadcastToAsm(VectorBroadcastStmtP vectorBroadcastStmt) {
+    int elementSize = typeSizes[vectorBroadcastStmt->elementType];
+    MachineOperand lowReg = MachineOperand::makeReg(getVectorRegister(vectorBroadcastStmt->reg, 0));
+    MachineOperand rax = MachineOperand::makeReg("rax");
+
+    convertUniExprToRegister(vectorBroadcastStmt->value, "rax");
+
+    if (vectorBroadcastStmt->width == YMM_REG_SIZE) {
+        usesYmmRegisters = true;
+
+        emit("vmovq", {lowReg, rax});
+        emit("vpbroadcast" + packedSuffixes[elementSize],
+             {MachineOperand::makeReg(getVectorRegister(vectorBroadcastStmt->reg, YMM_REG_SIZE)), lowReg});
+        return;
+    }
+
+    emit("movq", {lowReg, rax});
+
+    if (elementSize == BIT_64_REG_SIZE) {
+        emit("punpcklqdq", {lowReg, lowReg});
+        return;
+    }
+
+    // Widen a byte to the first 32 bits before copying them to the other lanes
+    if (elementSize == 1) {
+        emit("punpcklbw", {lowReg, lowReg});
+        emit("punpcklwd", {lowReg, lowReg});
+    }
+
+    emit("pshufd", {lowReg, lowReg, MachineOperand::makeImm(0)});
+}
+
+void Generator::convertVectorBinaryToAsm(VectorBinaryStmtP vectorBinaryStmt) {
+    int width = vectorBinaryStmt->width;
+    bool avx = width == YMM_REG_SIZE;
+
+    usesYmmRegisters |= avx;
+
+    generateVectorOperation(vectorBinaryStmt->op, typeSizes[vectorBinaryStmt->elementType], avx,
+                            getVectorRegister(vectorBinaryStmt->reg, width),
+                            getVectorRegister(vectorBinaryStmt->left, width),
+                            getVectorRegister(vectorBinaryStmt->right, width));
+}
+
+void Generator::convertVectorReduceToAsm(VectorReduceStmtP vectorReduceStmt) {
+    int elementSize = typeSizes[vectorReduceStmt->elementType];
+    bool avx = vectorReduceStmt->width == YMM_REG_SIZE;
+    std::string reduced = getVectorRegister(VECTOR_REDUCE_REG, 0);
+    std::string shifted = getVectorRegister(VECTOR_SHIFTED_REG, 0);
+    std::string lowReg = getVectorRegister(vectorReduceStmt->reg, 0);
+    MachineOperand reducedReg = MachineOperand::makeReg(reduced);
+    MachineOperand shiftedReg = MachineOperand::makeReg(shifted);
+    MachineOperand rax = MachineOperand::makeReg("rax");
+
+    // Start from the two 16 byte halves of a 32 byte register
+    if (avx) {
+        usesYmmRegisters = true;
+
+        emit("vextracti128", {reducedReg, MachineOperand::makeReg(getVectorRegister(vectorReduceStmt->reg,
+                                                                                     YMM_REG_SIZE)),
+                              MachineOperand::makeImm(1)});
+        generateVectorOperation(vectorReduceStmt->op, elementSize, avx, reduced, reduced, lowReg);
+    } else {
+        emit("movdqa", {reducedReg, MachineOperand::makeReg(lowReg)});
+    }
+
+    // Combine the upper half of the remaining lanes with the lower half
+    for (int shift = BIT_64_REG_SIZE; shift >= elementSize; shift /= 2) {
+        if (avx) {
+            emit("vpsrldq", {shiftedReg, reducedReg, MachineOperand::makeImm(shift)});
+        } else {
+            emit("movdqa", {shiftedReg, reducedReg});
+            emit("psrldq", {shiftedReg, MachineOperand::makeImm(shift)});
+        }
+
+        generateVectorOperation(vectorReduceStmt->op, elementSize, avx, reduced, reduced, shifted);
+    }
+
+    emit(avx ? "vmovq" : "movq", {rax, reducedReg});
+
+    if (elementSize != BIT_64_REG_SIZE) {
+        emit(elementSize == 1 ? "movsx" : "movsxd", {rax, MachineOperand::makeReg(elementSize == 1 ? "al" : "eax")});
+    }
+
+    emit("mov", {getTempAddr(vectorReduceStmt->id), rax});
 }
 
 void Generator::generateAsmFunctionCall(const std::string &funcName) {
-    this->programOut << "inc r8\n"
-                        "call " << funcName << "\n"
-                     << "dec r8\n";
+    generateAsmRegisterArguments();
+
+    emit("inc", {MachineOperand::makeReg("r10")});
+    emit("call", {MachineOperand::makeLabel(funcName)});
+    emit("dec", {MachineOperand::makeReg("r10")});
+}
+
+void Generator::generateAsmTailCall(const std::string &funcName) {
+    MachineOperand rax = MachineOperand::makeReg("rax");
+
+    generateAsmRegisterArguments();
+
+    // Copy the pushed parameters over the function's own parameters, right above the return address, both
+    // take the same slots
+    for (int offset = 0; offset < this->paramsSize; offset += FrameLayout::PARAM_SLOT_SIZE) {
+        emit("mov", {rax, MachineOperand::makeMem(BIT_64_REG_SIZE, "rsp", offset)});
+        emit("mov", {getFrameAddr(FrameLayout::FIRST_PARAM_OFFSET + offset, BIT_64_REG_SIZE), rax});
+    }
+
+    generateAsmFrameRelease();
+
+    emit("jmp", {MachineOperand::makeLabel(funcName)});
+}
+
+void Generator::generateAsmRegisterArguments() {
+    // The arguments are pushed from the last, load each to its register by their order, 'rcx' and 'rdx' last
+    std::stable_sort(pendingRegisterArgs.begin(), pendingRegisterArgs.end(),
+                     [](FunctionParamPushStmtP first, FunctionParamPushStmtP second) {
+                         auto last = [](const std::string &reg) { return reg == "rcx" || reg == "rdx"; };
+
+                         return !last(ARG_REGISTERS[first->argRegister]) && last(ARG_REGISTERS[second->argRegister]);
+                     });
+
+    bool parked = false;
+
+    for (auto push: pendingRegisterArgs) {
+        std::string reg = ARG_REGISTERS[push->argRegister];
+        ThreeAddressExprP next = push != pendingRegisterArgs.back() ? pendingRegisterArgs.back()->expr : nullptr;
+
+        // Computing the argument for 'rdx', loaded after 'rcx', may use 'rcx' unless it is a plain load
+        if (reg == "rcx" && next && !dynamic_cast<ImIntValP>(next) && !dynamic_cast<UniTempP>(next) &&
+            (!dynamic_cast<VariableValP>(next) || dynamic_cast<SubscriptableVariableValP>(next))) {
+            reg = ARG_PARKING_REGISTER;
+            parked = true;
+        }
+
+        if (auto uni = dynamic_cast<UniExprP>(push->expr)) {
+            convertUniExprToRegister(uni, reg);
+        } else {
+            convertTAExprToRaxRegister(push->expr);
+            emit("mov", {MachineOperand::makeReg(reg), MachineOperand::makeReg("rax")});
+        }
+    }
+
+    if (parked) emit("mov", {MachineOperand::makeReg("rcx"), MachineOperand::makeReg(ARG_PARKING_REGISTER)});
+
+    pendingRegisterArgs.clear();
 }
 
 void Generator::readAndGenerateBuiltinFunctionCode(const std::string &builtin) {
@@ -5,15 +5,22 @@
 #ifndef COMPILER_GENERATION_H
 #define COMPILER_GENERATION_H
 
+#include <bit>
+#include <optional>
 #include <utility>
-#include <stack>
 
 #include "intermediateCodeGenerator.h"
+#include "instructionSelection.h"
+#include "machineInstructions.h"
+#include "peepholeOptimizer.h"
+#include "instructionScheduler.h"
+#include "compilerOptions.h"
+#include "frameLayout.h"
 
 /**
  * @brief Represents data associated with a variable's stack position and size.
  *
- * Used by the code generator to keep track of variable data
+ * Used by the code generator to address a variable at the offset the frame layout gave it
  */
 class VariableStackData {
 public:
@@ -31,26 +38,6 @@ public:
     }
 };
 
-/**
- * @brief Represents a scope frame with frame size and a set of variables used in the scope frame.
- */
-class ScopeFrame {
-public:
-    int frameSize;
-    std::vector<std::string> frameVars;
-
-    /**
-     * @brief Constructor for the ScopeFrame class.
-     *
-     * @param frameSize The size of the scope frame.
-     * @param frameVars The set of variables within the scope.
-     */
-    ScopeFrame(int frameSize, std::vector<std::string> frameVars) : frameSize(frameSize),
-                                                                           frameVars(std::move(frameVars)) {
-
-    }
-};
-
 /**
  * @brief Class responsible for generating assembly code from an intermediate representation.
  */
@@ -61,8 +48,10 @@ public:
      *
      * @param ilProgram The ThreeAddressProgram instance (IL representation) used for code generation.
      * @param outFileName The name of the output file for the generated assembly code.
+     * @param options The compiler options selecting the backend passes.
      */
-    Generator(ThreeAddressProgramP ilProgram, std::string outFileName) : outFileName(std::move(outFileName)) {
+    Generator(ThreeAddressProgramP ilProgram, std::string outFileName, const CompilerOptions &options)
+            : outFileName(std::move(outFileName)), options(options) {
         this->ilProgram = ilProgram;
     }
 
@@ -78,73 +67,143 @@ private:
     static const int TEMP_SIZE = 8;
     // Size of a 64-bit register in bytes
     static const int BIT_64_REG_SIZE = 8;
+    // Size of a 32-bit register in bytes
+    static const int BIT_32_REG_SIZE = 4;
     // Size of a pointer data type in bytes
     static const int PTR_SIZE = 8;
+    // Largest power of two divisor whose remainder is taken with a mask, larger masks don't fit an immediate
+    static const long long MAX_MASK_DIVISOR = 1LL << 31;
+    // Callee-saved registers given to the register variables of a function, in order
+    inline static const std::vector<std::string> VARIABLE_REGISTERS = {"r12", "r13", "r14", "r15"};
+    // Registers the first arguments of the program's functions are passed in with '-fregister-args', in order. They
+    // are caller-saved like 'rax', 'rbx', 'r11' and the vector registers, nothing is kept in them across a call,
+    // while 'rbp' and the register variables' registers are callee-saved and 'r10' counts the nested calls
+    inline static const std::vector<std::string> ARG_REGISTERS = {"rdi", "rsi", "rdx", "rcx", "r8", "r9"};
+    // Register holding the argument for 'rcx' while the argument for 'rdx', which may use 'rcx', is computed
+    inline static const std::string ARG_PARKING_REGISTER = "r11";
+    // Width in bytes of the AVX2 vector registers, narrower vector statements use the SSE2 registers
+    static const int YMM_REG_SIZE = 32;
+    // Vector registers used for scratch, the IL's vector registers are numbered below them
+    static const int VECTOR_BLEND_REG = 12;
+    static const int VECTOR_MASK_REG = 13;
+    static const int VECTOR_SHIFTED_REG = 14;
+    static const int VECTOR_REDUCE_REG = 15;
 
     // Map to associate VariableType with its corresponding size on the stack
     static std::unordered_map<VariableType, int> typeSizes;
     // Map to associate sizes on the stack to the type identifiers (BYTE, WORD, DWORD, QWORD)
     static std::unordered_map<int, std::string> sizeIdentifiers;
-    // Map to associate binary expression operators to the steps needed to be taken
-    // in assembly to perform the operation
-    static std::unordered_map<ExprOperator, std::string> BinaryExprToAsmStrSteps;
-
-    // Map to keep track of each variable current size and position on the stack,
-    // that can be changed by scopes
-    std::unordered_map<std::string, std::stack<VariableStackData>> variableStack;
-    // Stack to keep track of scope frames, used to know the side for deallocation
-    // and which variables to pop from the 'variableStack' map
-    std::stack<ScopeFrame> scopeFrameStack;
+    // Map to associate element sizes to the suffixes of the packed integer instructions
+    static std::unordered_map<int, std::string> packedSuffixes;
+    // Map to associate the division operators to the steps needed to be taken in assembly to perform the
+    // operation, the other binary operators are selected by the 'selectionPatterns' table
+    static std::unordered_map<ExprOperator, std::vector<MachineInstr>> BinaryExprToAsmSteps;
+    // Map to associate comparison operators to the condition codes (of jcc and cmovcc) holding after 'cmp'
+    static std::unordered_map<ExprOperator, std::string> conditionCodes;
 
     // Pointer to the intermediate representation of the program
     ThreeAddressProgramP ilProgram;
     // The name of the output file where the generated assembly code will be written
     std::string outFileName;
-    // A stringstream used to accumulate the generated assembly code for the program
+    // The options given to the compiler
+    const CompilerOptions &options;
+    // A stringstream used to accumulate the program's sections and built-in functions, written as they are
     std::stringstream programOut;
+    // The machine code of the program's functions, in order, written out after the backend passes
+    std::vector<MachineFunction> machineFunctions;
     // Counter for generating unique labels within the assembly code
     int labelCount = 0;
-    // Current relative stack pointer (SP) position within the function's stack frame
-    int currentRelativeSP = 0;
-    // Size of function parameters to subtract after the function call is generated
-    int FuncParamsOffsetSP = 0;
     // Size of function parameters in bytes, used at function exit with the 'ret' instruction
     int paramsSize = 0;
+    // Map from the current function's register variables to the register holding them
+    std::unordered_map<std::string, std::string> registerVariables;
+    // The registers saved by the current function's prologue and their stack position, restored at exit
+    std::vector<std::pair<std::string, int>> savedRegisters;
+    // Whether the current function used the 32 byte vector registers, which are cleared before returning
+    bool usesYmmRegisters = false;
+    // The declaration of the function being generated
+    FunctionDeclarationStmtP currentFunction = nullptr;
+    // The pushes of the next call's arguments passed in registers, loaded right before the call
+    std::vector<FunctionParamPushStmtP> pendingRegisterArgs;
+
+    /**
+     * @brief Appends an instruction to the current function's machine code.
+     *
+     * @param opcode The instruction's mnemonic.
+     * @param operands The operands, the destination first.
+     */
+    void emit(const std::string &opcode, std::vector<MachineOperand> operands = {});
+
+    /**
+     * @brief Appends an instruction to the current function's machine code.
+     */
+    void emit(MachineInstr instr);
+
+    /**
+     * @brief Appends a label to the current function's machine code.
+     *
+     * @param label The label's name.
+     * @param comment A comment written after it, empty for none.
+     */
+    void emitLabel(const std::string &label, const std::string &comment = "");
 
     /**
      * @brief Constructs the stack address based on the provided VariableStackData.
      *
      * @param var The VariableStackData containing stack position information.
-     * @return A string representing the stack address relative to the base pointer (rbp).
-     *         If the stack position is positive, the address is calculated as "rbp + stackPos".
-     *         If the stack position is negative, the address is calculated as "rbp - |stackPos|".
+     * @param size The size of the accessed memory in bytes, 0 to leave it out.
+     * @return The memory operand of the variable, as given by 'getFrameAddr'.
+     */
+    MachineOperand getStackAddr(const VariableStackData &, int size);
+
+    /**
+     * @brief Constructs the memory operand of an offset from 'rbp' in the current function's frame.
+     *
+     * @param offset The offset from 'rbp'.
+     * @param size The size of the accessed memory in bytes, 0 to leave it out.
+     * @return "[rbp + offset]", from 'rsp' instead in a leaf function that didn't push 'rbp'.
+     */
+    MachineOperand getFrameAddr(int offset, int size);
+
+    /**
+     * @brief Constructs the memory operand of a temporary's slot.
+     *
+     * @param id The temporary's id.
+     */
+    MachineOperand getTempAddr(int id);
+
+    /**
+     * @brief Gets the offset and the size (of each element for arrays) of a variable on the stack.
+     *
+     * @param var The variable, its offset set by the frame layout.
      */
-    static std::string getStackAddr(const VariableStackData &);
+    static VariableStackData getVariableData(const Variable &var);
 
     /**
-     * @brief Constructs an assembly instruction to move a value into a 64-bit register.
+     * @brief Constructs an instruction moving a value into a 64-bit register.
      *
      * @param reg The destination 64-bit register.
-     * @param val The value to be moved into the register.
-     * @param size The size of the value being moved (in bytes).
-     * @return An assembly instruction string that moves the specified value into the register.
-     *         If the size of the value is less than 64 bits, sign extension (movsx) is used.
+     * @param val The value to be moved into the register, its size given by the operand.
+     * @param nonNegative Whether the value is known to be non-negative.
+     * @return An instruction that moves the specified value into the register.
+     *         If the size of the value is less than 64 bits, sign extension (movsx) is used, or zero extension
+     *         (to the 32 bit part of the register) for a non-negative value.
      */
-    static std::string movTo64BitReg(const std::string &, const std::string &, int);
+    static MachineInstr movTo64BitReg(const std::string &reg, const MachineOperand &val, bool nonNegative = false);
 
     /**
      * @brief Retrieves the stack position of a subscriptable variable.
      *
      * @param subVar Pointer to a SubscriptableVariableVal instance.
      * @param freeReg A string specifying a free register to use for intermediate operations.
-     * @return A string representing the memory location accessed by the subscripted variable,
-     *         computed as "[varBaseAddr + typeSize * offset]", where:\n
+     * @return The memory operand accessed by the subscripted variable, sized by its type,
+     *         addressing "[varBaseAddr + offset * typeSize]", where:\n
      *         - varBaseAddr is the base address of the variable on the stack.
      *           If the subscriptable is a pointer then the base address is stored in the 'freeReg' register\n
      *         - typeSize is the size of the variable's type.\n
      *         - offset is the index or offset value used for subscripting.\n
      */
-    std::string getSubscriptableStackPosition(SubscriptableVariableValP subVar, const std::string &reg);
+    MachineOperand getSubscriptableStackPosition(SubscriptableVariableValP subVar, const std::string &freeReg);
 
     /**
      * @brief Generates assembly code to move the value of a UniExpr to the specified register.
@@ -171,6 +230,46 @@ private:
      */
     void convertBinaryExprToRegister(BinaryExprP);
 
+    /**
+     * @brief Checks whether a value fits in the sign extended 32 bit immediate operand of an instruction.
+     */
+    static bool fitsImmediate(long long value);
+
+    /**
+     * @brief Checks whether an operand is of the kind an instruction selection pattern requires.
+     *
+     * @param operand The operand of a binary expression.
+     * @param kind The kind required by the pattern.
+     */
+    bool matchesOperandKind(UniExprP operand, OperandKind kind);
+
+    /**
+     * @brief Gets an operand an instruction can use without loading it to a register.
+     *
+     * @param operand The operand.
+     * @param size The size the instruction reads, 8 or 4 for an instruction using the low half of the value.
+     * @return A 32 bit immediate, the register of a register variable or a stack slot (of a temporary or a
+     *         variable at least as wide as 'size'), nothing if the operand has to be loaded.
+     */
+    std::optional<MachineOperand> getDirectOperand(UniExprP operand, int size = BIT_64_REG_SIZE);
+
+    /**
+     * @brief Gets the right operand of an instruction, loading it to a scratch register if it can't be used directly.
+     *
+     * @param operand The operand.
+     * @param scratchReg The register the operand is loaded to if needed.
+     * @param size The size the instruction reads, as given to 'getDirectOperand'.
+     */
+    MachineOperand getOperand(UniExprP operand, const std::string &scratchReg, int size = BIT_64_REG_SIZE);
+
+    /**
+     * @brief Generates the instructions of an instruction selection pattern matching a binary expression.
+     *
+     * @param pattern The pattern.
+     * @param expr The binary expression, computed to the 'rax' register.
+     */
+    void generateAsmPattern(const SelectionPattern &pattern, BinaryExprP expr);
+
     /**
      * @brief Converts a three-address expression into a set of assembly instructions.
      * The value of the expression is saved in the 'rax' register.
@@ -206,12 +305,23 @@ private:
      */
     void convertVarAssignmentToAsm(VarAssignmentTAStmtP);
 
+    /**
+     * @brief Generates assembly code adding a constant to (or subtracting it from) a destination in place.
+     *
+     * @param binary The addition or subtraction whose left operand is the destination.
+     * @param dest The register or the sized memory operand of the destination.
+     * @param size The size of the destination in bytes.
+     * @return Whether the expression was a step by a constant that fits the destination, and the code was generated.
+     */
+    bool generateAsmStepInPlace(BinaryExprP binary, const MachineOperand &dest, int size);
+
     /**
      * @brief Convert a function parameter push statement to assembly code.
      *
      * This function takes a function parameter push statement and converts its associated
-     * expression into assembly code. It determines the size required on the stack based
-     * on the variable type and pointer status.
+     * expression into assembly code, stored at the argument's offset from 'rsp'. The first push
+     * of a call allocates the call's whole argument block. An argument passed in a register is
+     * computed by the call instead.
      *
      * @param funcParamPushStmt A pointer to a FunctionParamPushStmt representing the push statement.
      */
@@ -221,8 +331,8 @@ private:
      * @brief Convert a function call expression to assembly code.
      *
      * This function takes a function call expression and generates the corresponding assembly
-     * code by calling the target function. It then adjusts the stack pointer and resets the
-     * function parameter offset.
+     * code by calling the target function, or jumping to it for a tail call. It then adjusts the stack
+     * pointer and resets the function parameter offset.
      *
      * @param functionCallStmt A pointer to a FunctionCallExprP containing the function call expression.
      */
@@ -267,41 +377,57 @@ private:
     void convertGotoIfNotZeroToAsm(GotoIfNotZeroStmtP);
 
     /**
-     * @brief Convert a set return value statement to assembly code.
+     * @brief Generates assembly code setting the zero flag by whether the value of an expression is zero.
      *
-     * This function generates assembly code to set the return value of a function by converting
-     * a three-address expression's result to the 'rax' register.
+     * A variable or a temporary is compared with zero in place, other expressions are computed to 'rax' first.
      *
-     * @param setReturnValueStmt A pointer to a SetReturnValueStmtP representing the set return value statement.
+     * @param expr The tested expression.
      */
-    void convertSetReturnValueToAsm(SetReturnValueStmtP);
+    void generateAsmTestZero(ThreeAddressExprP expr);
+
+    /**
+     * @brief Convert a goto-if-compare statement to assembly code.
+     *
+     * This function generates assembly code to compare the operands of the statement's comparison and
+     * perform a conditional jump to a specified label if the comparison holds.
+     *
+     * @param gotoIfCompareStmt A pointer to a GotoIfCompareStmtP representing the goto-if-compare statement.
+     */
+    void convertGotoIfCompareToAsm(GotoIfCompareStmtP);
 
     /**
-     * @brief Convert a scope enter statement to assembly code.
+     * @brief Generates assembly code that compares the operands of a comparison, setting the flags its condition
+     * code reads. A register variable, a 32 bit immediate or a 64 bit stack slot is compared directly, other
+     * operands are loaded to 'rax' and 'rbx'.
      *
-     * This function generates assembly code to handle entering a new scope. It allocates stack
-     * space for local variables within the scope and updates the 'variableStack' and
-     * 'scopeFrameStack' accordingly.
+     * @param comparison The comparison.
+     */
+    void generateAsmCompare(BinaryExprP comparison);
+
+    /**
+     * @brief Converts a select expression to the 'rax' register with a conditional move.
      *
-     * @param scopeEnterStmt A pointer to a ScopeEnterStmtP representing the scope enter statement.
+     * @param select The select expression, its values must not need a scratch register.
      */
-    void convertScopeEnterToAsm(ScopeEnterStmtP);
+    void convertSelectExprToRegister(SelectExprP select);
 
     /**
-     * @brief Convert a scope exit statement to assembly code.
+     * @brief Convert a set return value statement to assembly code.
+     *
+     * This function generates assembly code to set the return value of a function by converting
+     * a three-address expression's result to the 'rax' register.
      *
-     * This function generates assembly code to handle exiting from the current scope. It removes
-     * variables from the 'variableStack' that belong to the exiting scope and adjusts the stack
-     * pointer (rsp) to deallocate the stack space reserved for the scope's local variables.
+     * @param setReturnValueStmt A pointer to a SetReturnValueStmtP representing the set return value statement.
      */
-    void convertScopeExitToAsm();
+    void convertSetReturnValueToAsm(SetReturnValueStmtP);
 
     /**
      * @brief Convert a function declaration statement to assembly code.
      *
      * This function generates assembly code for function declaration statements. It sets up the
-     * function's prologue, initializes the stack frame and allocates space for local temporaries
-     * usage.
+     * function's prologue, initializes the stack frame, allocates the whole frame laid out for the
+     * function and saves the callee-saved registers given to the function's register variables. A leaf
+     * function skips the overflow check and the frame setup, its frame is in the red zone below 'rsp'.
      *
      * @param functionDeclarationStmt Pointer to the function declaration statement.
      */
@@ -310,8 +436,9 @@ private:
     /**
      * @brief Generate assembly code for function exit.
      *
-     * This function generates assembly code for function epilogue. It restores the stack frame
-     * and returns from the function using the 'leave' and 'ret' instructions.
+     * This function generates assembly code for function epilogue. It restores the saved registers
+     * and the stack frame and returns from the function using the 'leave' and 'ret' instructions ('leave' is
+     * skipped by a leaf function, which has no frame to release).
      */
     void convertFunctionExitToAsm();
 
@@ -319,13 +446,126 @@ private:
      * @brief Generate assembly code for a function call.
      *
      * This function generates assembly code to call a function. It increments the stack overflow
-     * counter ('r8') to track recursive function calls, calls the target function, and
-     * decrements the stack overflow counter afterwards.
+     * counter ('r10') to track recursive function calls, calls the target function, and
+     * decrements the stack overflow counter afterwards. The arguments passed in registers are
+     * loaded first.
      *
      * @param funcName The name of the function to be called.
      */
     void generateAsmFunctionCall(const std::string& funcName);
 
+    /**
+     * @brief Generate assembly code for a tail call.
+     *
+     * The pushed parameters are copied over the current function's own parameters and the frame is
+     * released before jumping to the target function, which then returns straight to the current
+     * function's caller. The stack overflow counter ('r10') is left as is since no frame is added.
+     * The arguments passed in registers are loaded first, the frame they are computed from is still
+     * there.
+     *
+     * @param funcName The name of the function to be called.
+     */
+    void generateAsmTailCall(const std::string& funcName);
+
+    /**
+     * @brief Generate assembly code loading the pending arguments passed in registers.
+     *
+     * The arguments are pushed right before their call, so nothing else runs in between. The ones
+     * for 'rcx' and 'rdx', which computing the other arguments may use, are loaded last.
+     */
+    void generateAsmRegisterArguments();
+
+    /**
+     * @brief Generate assembly code restoring the saved registers and releasing the stack frame.
+     */
+    void generateAsmFrameRelease();
+
+    /**
+     * @brief Generate assembly code looking up the result of a memoized function in its table.
+     *
+     * Runs before the prologue, a cached result is returned right away. Otherwise 'rax' is left with the
+     * call's entry in the table, or -1 when an argument is out of the table's range.
+     *
+     * @param functionDeclarationStmt The declaration of the memoized function.
+     */
+    void generateAsmMemoLookup(FunctionDeclarationStmtP functionDeclarationStmt);
+
+    /**
+     * @brief Generate assembly code storing the returned value ('rax') in the current function's table.
+     */
+    void generateAsmMemoStore();
+
+    /**
+     * @brief Returns the number of entries of a memoized function's table, one for each set of arguments in range.
+     */
+    static int memoTableSize(FunctionDeclarationStmtP functionDeclarationStmt);
+
+    /**
+     * @brief Get the name of a vector register.
+     *
+     * @param reg The number of the register.
+     * @param width The width of the register in bytes.
+     * @return The register's name ('xmmN' for 16 bytes, 'ymmN' for 32 bytes).
+     */
+    static std::string getVectorRegister(int reg, int width);
+
+    /**
+     * @brief Generates the instructions of a lane-wise operation on vector registers.
+     *
+     * SSE2 instructions overwrite their first operand, so the left operand is first copied to the destination
+     * which must not be the right operand unless it is also the left one. SSE2 has no 64 bit comparisons,
+     * so 64 bit minimums and maximums need AVX2.
+     *
+     * @param op The operation.
+     * @param elementSize The size of the lanes in bytes.
+     * @param avx Whether to use the AVX2 (VEX encoded) instructions.
+     * @param dest The destination register.
+     * @param left The left operand register.
+     * @param right The right operand register.
+     */
+    void generateVectorOperation(VectorOperator op, int elementSize, bool avx, const std::string &dest,
+                                 const std::string &left, const std::string &right);
+
+    /**
+     * @brief Convert a vector load statement to assembly code, an unaligned move of the consecutive elements.
+     *
+     * @param vectorLoadStmt Pointer to the vector load statement.
+     */
+    void convertVectorLoadToAsm(VectorLoadStmtP);
+
+    /**
+     * @brief Convert a vector store statement to assembly code, an unaligned move to the consecutive elements.
+     *
+     * @param vectorStoreStmt Pointer to the vector store statement.
+     */
+    void convertVectorStoreToAsm(VectorStoreStmtP);
+
+    /**
+     * @brief Convert a vector broadcast statement to assembly code.
+     *
+     * The value is computed in 'rax' and copied to every lane of the register.
+     *
+     * @param vectorBroadcastStmt Pointer to the vector broadcast statement.
+     */
+    void convertVectorBroadcastToAsm(VectorBroadcastStmtP);
+
+    /**
+     * @brief Convert a vector binary statement to assembly code.
+     *
+     * @param vectorBinaryStmt Pointer to the vector binary statement.
+     */
+    void convertVectorBinaryToAsm(VectorBinaryStmtP);
+
+    /**
+     * @brief Convert a vector reduce statement to assembly code.
+     *
+     * The lanes are combined by halving the register until a single lane is left, whose value is sign
+     * extended and saved to the temporary.
+     *
+     * @param vectorReduceStmt Pointer to the vector reduce statement.
+     */
+    void convertVectorReduceToAsm(VectorReduceStmtP);
+
     void readAndGenerateBuiltinFunctionCode(const std::string& builtin);
 
     /**
@@ -358,6 +598,13 @@ inline std::unordered_map<VariableType, int> Generator::typeSizes = {
         {VariableType::charType, 1},
 };
 
+inline std::unordered_map<int, std::string> Generator::packedSuffixes = {
+        {8, "q"},
+        {4, "d"},
+        {2, "w"},
+        {1, "b"},
+};
+
 inline std::unordered_map<int, std::string> Generator::sizeIdentifiers = {
         {8, "QWORD"},
         {4, "DWORD"},
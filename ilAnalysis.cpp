@@ -0,0 +1,519 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#include <climits>
+#include "ilAnalysis.h"
+
+UniExpr *ILAnalysis::cloneUniExpr(UniExprP expr) {
+    return dynamic_cast<UniExprP>(cloneExpr(expr));
+}
+
+ThreeAddressExpr *ILAnalysis::cloneExpr(ThreeAddressExprP expr) {
+    if (auto imInt = dynamic_cast<ImIntValP>(expr)) {
+        return new ImIntVal(imInt->value);
+    } else if (auto temp = dynamic_cast<UniTempP>(expr)) {
+        return new UniTemp(temp->id);
+    } else if (auto subVar = dynamic_cast<SubscriptableVariableValP>(expr)) {
+        return new SubscriptableVariableVal(subVar->var, cloneUniExpr(subVar->index));
+    } else if (auto var = dynamic_cast<VariableValP>(expr)) {
+        auto copy = new VariableVal(var->var);
+        copy->nonNegative = var->nonNegative;
+
+        return copy;
+    } else if (auto logicalNot = dynamic_cast<LogicalNotExprP>(expr)) {
+        return new LogicalNotExpr(cloneUniExpr(logicalNot->expr));
+    } else if (auto numericNeg = dynamic_cast<NumericNegExprP>(expr)) {
+        return new NumericNegExpr(cloneUniExpr(numericNeg->expr));
+    } else if (auto functionCall = dynamic_cast<FunctionCallExprP>(expr)) {
+        return new FunctionCallExpr(functionCall->functionName, functionCall->retType, functionCall->retPtr,
+                                    functionCall->paramCount);
+    } else if (auto addrVar = dynamic_cast<AddrVarExprP>(expr)) {
+        return new AddrVarExpr(dynamic_cast<VariableValP>(cloneExpr(addrVar->addressable)));
+    } else if (auto addrStr = dynamic_cast<AddrStrExprP>(expr)) {
+        return new AddrStrExpr(addrStr->value);
+    } else if (auto binary = dynamic_cast<BinaryExprP>(expr)) {
+        auto copy = new BinaryExpr(cloneUniExpr(binary->left), cloneUniExpr(binary->right), binary->op);
+        copy->nonNegative = binary->nonNegative;
+        copy->narrow = binary->narrow;
+        copy->narrowResult = binary->narrowResult;
+
+        return copy;
+    } else if (auto select = dynamic_cast<SelectExprP>(expr)) {
+        return new SelectExpr(dynamic_cast<BinaryExprP>(cloneExpr(select->comparison)),
+                              cloneUniExpr(select->trueValue), cloneUniExpr(select->falseValue));
+    }
+
+    return nullptr;
+}
+
+ThreeAddressStmt *ILAnalysis::cloneStmt(ThreeAddressStmtP stmt) {
+    if (auto tempAssignment = dynamic_cast<TempAssignmentTAStmtP>(stmt)) {
+        return new TempAssignmentTAStmt(tempAssignment->id, cloneExpr(tempAssignment->expr));
+    } else if (auto varAssignment = dynamic_cast<VarAssignmentTAStmtP>(stmt)) {
+        return new VarAssignmentTAStmt(dynamic_cast<VariableValP>(cloneExpr(varAssignment->var)),
+                                       cloneExpr(varAssignment->expr));
+    } else if (auto functionParamPush = dynamic_cast<FunctionParamPushStmtP>(stmt)) {
+        return new FunctionParamPushStmt(functionParamPush->varType, functionParamPush->isPtr,
+                                         cloneExpr(functionParamPush->expr));
+    } else if (auto functionCall = dynamic_cast<FunctionCallExprP>(stmt)) {
+        auto copy = new FunctionCallExpr(functionCall->functionName, functionCall->retType, functionCall->retPtr,
+                                         functionCall->paramCount);
+        copy->tailCall = functionCall->tailCall;
+        copy->retExtended = functionCall->retExtended;
+
+        return copy;
+    } else if (auto labelStmt = dynamic_cast<LabelStmtP>(stmt)) {
+        return new LabelStmt(labelStmt->labelName);
+    } else if (auto gotoStmt = dynamic_cast<GotoStmtP>(stmt)) {
+        return new GotoStmt(gotoStmt->labelName);
+    } else if (auto gotoIfZeroStmt = dynamic_cast<GotoIfZeroStmtP>(stmt)) {
+        return new GotoIfZeroStmt(gotoIfZeroStmt->labelName, cloneUniExpr(gotoIfZeroStmt->expr));
+    } else if (auto gotoIfNotZeroStmt = dynamic_cast<GotoIfNotZeroStmtP>(stmt)) {
+        return new GotoIfNotZeroStmt(gotoIfNotZeroStmt->labelName, cloneUniExpr(gotoIfNotZeroStmt->expr));
+    } else if (auto gotoIfCompareStmt = dynamic_cast<GotoIfCompareStmtP>(stmt)) {
+        return new GotoIfCompareStmt(gotoIfCompareStmt->labelName,
+                                     dynamic_cast<BinaryExprP>(cloneExpr(gotoIfCompareStmt->comparison)));
+    } else if (auto setReturnValue = dynamic_cast<SetReturnValueStmtP>(stmt)) {
+        return new SetReturnValueStmt(cloneExpr(setReturnValue->expr));
+    } else if (auto scopeEnter = dynamic_cast<ScopeEnterStmtP>(stmt)) {
+        return new ScopeEnterStmt(scopeEnter->vars);
+    } else if (dynamic_cast<ScopeExitStmtP>(stmt)) {
+        return new ScopeExitStmt();
+    } else if (auto functionDeclaration = dynamic_cast<FunctionDeclarationStmtP>(stmt)) {
+        auto copy = new FunctionDeclarationStmt(functionDeclaration->name, functionDeclaration->params);
+        copy->maxTemp = functionDeclaration->maxTemp;
+        copy->retType = functionDeclaration->retType;
+        copy->retPtr = functionDeclaration->retPtr;
+        copy->registerVars = functionDeclaration->registerVars;
+        copy->memoRange = functionDeclaration->memoRange;
+        copy->memoTemp = functionDeclaration->memoTemp;
+
+        return copy;
+    } else if (dynamic_cast<FunctionExitStmtP>(stmt)) {
+        return new FunctionExitStmt();
+    } else if (auto vectorLoad = dynamic_cast<VectorLoadStmtP>(stmt)) {
+        return new VectorLoadStmt(vectorLoad->elementType, vectorLoad->width, vectorLoad->reg,
+                                  dynamic_cast<SubscriptableVariableValP>(cloneExpr(vectorLoad->source)));
+    } else if (auto vectorStore = dynamic_cast<VectorStoreStmtP>(stmt)) {
+        return new VectorStoreStmt(vectorStore->elementType, vectorStore->width,
+                                   dynamic_cast<SubscriptableVariableValP>(cloneExpr(vectorStore->target)),
+                                   vectorStore->reg);
+    } else if (auto vectorBroadcast = dynamic_cast<VectorBroadcastStmtP>(stmt)) {
+        return new VectorBroadcastStmt(vectorBroadcast->elementType, vectorBroadcast->width, vectorBroadcast->reg,
+                                       cloneUniExpr(vectorBroadcast->value));
+    } else if (auto vectorBinary = dynamic_cast<VectorBinaryStmtP>(stmt)) {
+        return new VectorBinaryStmt(vectorBinary->elementType, vectorBinary->width, vectorBinary->reg,
+                                    vectorBinary->left, vectorBinary->right, vectorBinary->op);
+    } else if (auto vectorReduce = dynamic_cast<VectorReduceStmtP>(stmt)) {
+        return new VectorReduceStmt(vectorReduce->elementType, vectorReduce->width, vectorReduce->id,
+                                    vectorReduce->reg, vectorReduce->op);
+    }
+
+    return nullptr;
+}
+
+void ILAnalysis::collectExprTemps(ThreeAddressExprP expr, std::vector<UniTempP> &temps) {
+    if (auto temp = dynamic_cast<UniTempP>(expr)) {
+        temps.push_back(temp);
+    } else if (auto subVar = dynamic_cast<SubscriptableVariableValP>(expr)) {
+        collectExprTemps(subVar->index, temps);
+    } else if (auto logicalNot = dynamic_cast<LogicalNotExprP>(expr)) {
+        collectExprTemps(logicalNot->expr, temps);
+    } else if (auto numericNeg = dynamic_cast<NumericNegExprP>(expr)) {
+        collectExprTemps(numericNeg->expr, temps);
+    } else if (auto addrVar = dynamic_cast<AddrVarExprP>(expr)) {
+        collectExprTemps(addrVar->addressable, temps);
+    } else if (auto binary = dynamic_cast<BinaryExprP>(expr)) {
+        collectExprTemps(binary->left, temps);
+        collectExprTemps(binary->right, temps);
+    } else if (auto select = dynamic_cast<SelectExprP>(expr)) {
+        collectExprTemps(select->comparison, temps);
+        collectExprTemps(select->trueValue, temps);
+        collectExprTemps(select->falseValue, temps);
+    }
+}
+
+std::vector<UniTempP> ILAnalysis::usedTemps(ThreeAddressStmtP stmt) {
+    std::vector<UniTempP> temps;
+
+    if (auto tempAssignment = dynamic_cast<TempAssignmentTAStmtP>(stmt)) {
+        collectExprTemps(tempAssignment->expr, temps);
+    } else if (auto varAssignment = dynamic_cast<VarAssignmentTAStmtP>(stmt)) {
+        collectExprTemps(varAssignment->expr, temps);
+        // The index of a subscripted target is read as well
+        collectExprTemps(varAssignment->var, temps);
+    } else if (auto functionParamPush = dynamic_cast<FunctionParamPushStmtP>(stmt)) {
+        collectExprTemps(functionParamPush->expr, temps);
+    } else if (auto gotoIfZeroStmt = dynamic_cast<GotoIfZeroStmtP>(stmt)) {
+        collectExprTemps(gotoIfZeroStmt->expr, temps);
+    } else if (auto gotoIfNotZeroStmt = dynamic_cast<GotoIfNotZeroStmtP>(stmt)) {
+        collectExprTemps(gotoIfNotZeroStmt->expr, temps);
+    } else if (auto gotoIfCompareStmt = dynamic_cast<GotoIfCompareStmtP>(stmt)) {
+        collectExprTemps(gotoIfCompareStmt->comparison, temps);
+    } else if (auto setReturnValue = dynamic_cast<SetReturnValueStmtP>(stmt)) {
+        collectExprTemps(setReturnValue->expr, temps);
+    } else if (auto vectorLoad = dynamic_cast<VectorLoadStmtP>(stmt)) {
+        collectExprTemps(vectorLoad->source, temps);
+    } else if (auto vectorStore = dynamic_cast<VectorStoreStmtP>(stmt)) {
+        collectExprTemps(vectorStore->target, temps);
+    } else if (auto vectorBroadcast = dynamic_cast<VectorBroadcastStmtP>(stmt)) {
+        collectExprTemps(vectorBroadcast->value, temps);
+    }
+
+    return temps;
+}
+
+int ILAnalysis::definedTemp(ThreeAddressStmtP stmt) {
+    if (auto tempAssignment = dynamic_cast<TempAssignmentTAStmtP>(stmt)) {
+        return tempAssignment->id;
+    } else if (auto vectorReduce = dynamic_cast<VectorReduceStmtP>(stmt)) {
+        return vectorReduce->id;
+    }
+
+    return -1;
+}
+
+void ILAnalysis::collectExprReads(ThreeAddressExprP expr, std::vector<VariableValP> &scalarReads,
+                                  std::vector<SubscriptableVariableValP> &elementReads) {
+    if (auto subVar = dynamic_cast<SubscriptableVariableValP>(expr)) {
+        // A pointer base is loaded before being subscripted
+        if (subVar->var.ptrType) scalarReads.push_back(subVar);
+
+        elementReads.push_back(subVar);
+        collectExprReads(subVar->index, scalarReads, elementReads);
+    } else if (auto var = dynamic_cast<VariableValP>(expr)) {
+        scalarReads.push_back(var);
+    } else if (auto logicalNot = dynamic_cast<LogicalNotExprP>(expr)) {
+        collectExprReads(logicalNot->expr, scalarReads, elementReads);
+    } else if (auto numericNeg = dynamic_cast<NumericNegExprP>(expr)) {
+        collectExprReads(numericNeg->expr, scalarReads, elementReads);
+    } else if (auto addrVar = dynamic_cast<AddrVarExprP>(expr)) {
+        // Taking an address only reads the value of a pointer and the index, never the memory itself
+        if (addrVar->addressable->var.ptrType) scalarReads.push_back(addrVar->addressable);
+
+        if (auto addrSubVar = dynamic_cast<SubscriptableVariableValP>(addrVar->addressable)) {
+            collectExprReads(addrSubVar->index, scalarReads, elementReads);
+        }
+    } else if (auto binary = dynamic_cast<BinaryExprP>(expr)) {
+        collectExprReads(binary->left, scalarReads, elementReads);
+        collectExprReads(binary->right, scalarReads, elementReads);
+    } else if (auto select = dynamic_cast<SelectExprP>(expr)) {
+        collectExprReads(select->comparison, scalarReads, elementReads);
+        collectExprReads(select->trueValue, scalarReads, elementReads);
+        collectExprReads(select->falseValue, scalarReads, elementReads);
+    }
+}
+
+void ILAnalysis::collectStmtReads(ThreeAddressStmtP stmt, std::vector<VariableValP> &scalarReads,
+                                  std::vector<SubscriptableVariableValP> &elementReads) {
+    if (auto tempAssignment = dynamic_cast<TempAssignmentTAStmtP>(stmt)) {
+        collectExprReads(tempAssignment->expr, scalarReads, elementReads);
+    } else if (auto varAssignment = dynamic_cast<VarAssignmentTAStmtP>(stmt)) {
+        collectExprReads(varAssignment->expr, scalarReads, elementReads);
+
+        // Storing to an element reads the index and the pointer base, but not the element itself
+        if (auto subVar = dynamic_cast<SubscriptableVariableValP>(varAssignment->var)) {
+            if (subVar->var.ptrType) scalarReads.push_back(subVar);
+
+            collectExprReads(subVar->index, scalarReads, elementReads);
+        }
+    } else if (auto functionParamPush = dynamic_cast<FunctionParamPushStmtP>(stmt)) {
+        collectExprReads(functionParamPush->expr, scalarReads, elementReads);
+    } else if (auto gotoIfZeroStmt = dynamic_cast<GotoIfZeroStmtP>(stmt)) {
+        collectExprReads(gotoIfZeroStmt->expr, scalarReads, elementReads);
+    } else if (auto gotoIfNotZeroStmt = dynamic_cast<GotoIfNotZeroStmtP>(stmt)) {
+        collectExprReads(gotoIfNotZeroStmt->expr, scalarReads, elementReads);
+    } else if (auto gotoIfCompareStmt = dynamic_cast<GotoIfCompareStmtP>(stmt)) {
+        collectExprReads(gotoIfCompareStmt->comparison, scalarReads, elementReads);
+    } else if (auto setReturnValue = dynamic_cast<SetReturnValueStmtP>(stmt)) {
+        collectExprReads(setReturnValue->expr, scalarReads, elementReads);
+    } else if (auto vectorLoad = dynamic_cast<VectorLoadStmtP>(stmt)) {
+        collectExprReads(vectorLoad->source, scalarReads, elementReads);
+    } else if (auto vectorStore = dynamic_cast<VectorStoreStmtP>(stmt)) {
+        if (vectorStore->target->var.ptrType) scalarReads.push_back(vectorStore->target);
+
+        collectExprReads(vectorStore->target->index, scalarReads, elementReads);
+    } else if (auto vectorBroadcast = dynamic_cast<VectorBroadcastStmtP>(stmt)) {
+        collectExprReads(vectorBroadcast->value, scalarReads, elementReads);
+    }
+}
+
+bool ILAnalysis::readsVariable(ThreeAddressStmtP stmt, const std::string &name) {
+    std::vector<VariableValP> scalarReads;
+    std::vector<SubscriptableVariableValP> elementReads;
+
+    collectStmtReads(stmt, scalarReads, elementReads);
+
+    for (auto var: scalarReads) {
+        if (var->var.name == name) return true;
+    }
+
+    for (auto subVar: elementReads) {
+        if (subVar->var.name == name) return true;
+    }
+
+    return false;
+}
+
+void ILAnalysis::replaceVariableReads(ThreeAddressStmtP stmt, const std::string &name,
+                                      const std::function<UniExpr *()> &makeValue) {
+    replaceReads(stmt, [&name](UniExprP expr) {
+        auto var = dynamic_cast<VariableValP>(expr);
+
+        return var && !dynamic_cast<SubscriptableVariableValP>(var) && var->var.name == name;
+    }, makeValue);
+}
+
+void ILAnalysis::replaceTempReads(ThreeAddressStmtP stmt, int id, const std::function<UniExpr *()> &makeValue) {
+    replaceReads(stmt, [id](UniExprP expr) {
+        auto temp = dynamic_cast<UniTempP>(expr);
+
+        return temp && temp->id == id;
+    }, makeValue);
+}
+
+void ILAnalysis::replaceReads(ThreeAddressStmtP stmt, const std::function<bool(UniExprP)> &matches,
+                              const std::function<UniExpr *()> &makeValue) {
+    if (auto tempAssignment = dynamic_cast<TempAssignmentTAStmtP>(stmt)) {
+        replaceExprReads(tempAssignment->expr, matches, makeValue);
+    } else if (auto varAssignment = dynamic_cast<VarAssignmentTAStmtP>(stmt)) {
+        replaceExprReads(varAssignment->expr, matches, makeValue);
+
+        if (auto subVar = dynamic_cast<SubscriptableVariableValP>(varAssignment->var)) {
+            replaceUniExprReads(subVar->index, matches, makeValue);
+        }
+    } else if (auto functionParamPush = dynamic_cast<FunctionParamPushStmtP>(stmt)) {
+        replaceExprReads(functionParamPush->expr, matches, makeValue);
+    } else if (auto gotoIfZeroStmt = dynamic_cast<GotoIfZeroStmtP>(stmt)) {
+        replaceUniExprReads(gotoIfZeroStmt->expr, matches, makeValue);
+    } else if (auto gotoIfNotZeroStmt = dynamic_cast<GotoIfNotZeroStmtP>(stmt)) {
+        replaceUniExprReads(gotoIfNotZeroStmt->expr, matches, makeValue);
+    } else if (auto gotoIfCompareStmt = dynamic_cast<GotoIfCompareStmtP>(stmt)) {
+        replaceUniExprReads(gotoIfCompareStmt->comparison->left, matches, makeValue);
+        replaceUniExprReads(gotoIfCompareStmt->comparison->right, matches, makeValue);
+    } else if (auto setReturnValue = dynamic_cast<SetReturnValueStmtP>(stmt)) {
+        replaceExprReads(setReturnValue->expr, matches, makeValue);
+    } else if (auto vectorLoad = dynamic_cast<VectorLoadStmtP>(stmt)) {
+        replaceUniExprReads(vectorLoad->source->index, matches, makeValue);
+    } else if (auto vectorStore = dynamic_cast<VectorStoreStmtP>(stmt)) {
+        replaceUniExprReads(vectorStore->target->index, matches, makeValue);
+    } else if (auto vectorBroadcast = dynamic_cast<VectorBroadcastStmtP>(stmt)) {
+        replaceUniExprReads(vectorBroadcast->value, matches, makeValue);
+    }
+}
+
+void ILAnalysis::replaceExprReads(ThreeAddressExpr *&expr, const std::function<bool(UniExprP)> &matches,
+                                  const std::function<UniExpr *()> &makeValue) {
+    if (auto uni = dynamic_cast<UniExprP>(expr)) {
+        UniExpr *replaced = uni;
+
+        replaceUniExprReads(replaced, matches, makeValue);
+        expr = replaced;
+    } else if (auto addrVar = dynamic_cast<AddrVarExprP>(expr)) {
+        // The address of the variable itself is kept, only an index is read
+        if (auto addrSubVar = dynamic_cast<SubscriptableVariableValP>(addrVar->addressable)) {
+            replaceUniExprReads(addrSubVar->index, matches, makeValue);
+        }
+    } else if (auto binary = dynamic_cast<BinaryExprP>(expr)) {
+        replaceUniExprReads(binary->left, matches, makeValue);
+        replaceUniExprReads(binary->right, matches, makeValue);
+    } else if (auto select = dynamic_cast<SelectExprP>(expr)) {
+        replaceUniExprReads(select->comparison->left, matches, makeValue);
+        replaceUniExprReads(select->comparison->right, matches, makeValue);
+        replaceUniExprReads(select->trueValue, matches, makeValue);
+        replaceUniExprReads(select->falseValue, matches, makeValue);
+    }
+}
+
+void ILAnalysis::replaceUniExprReads(UniExpr *&expr, const std::function<bool(UniExprP)> &matches,
+                                     const std::function<UniExpr *()> &makeValue) {
+    if (matches(expr)) {
+        delete expr;
+        expr = makeValue();
+    } else if (auto subVar = dynamic_cast<SubscriptableVariableValP>(expr)) {
+        replaceUniExprReads(subVar->index, matches, makeValue);
+    } else if (auto logicalNot = dynamic_cast<LogicalNotExprP>(expr)) {
+        replaceUniExprReads(logicalNot->expr, matches, makeValue);
+    } else if (auto numericNeg = dynamic_cast<NumericNegExprP>(expr)) {
+        replaceUniExprReads(numericNeg->expr, matches, makeValue);
+    }
+}
+
+bool ILAnalysis::evaluateOperator(ExprOperator op, long long left, long long right, long long &result) {
+    // Overflowing arithmetic wraps around like the registers do
+    auto uLeft = (unsigned long long) left;
+    auto uRight = (unsigned long long) right;
+
+    switch (op) {
+        case ExprOperator::add:
+            result = (long long) (uLeft + uRight);
+            return true;
+        case ExprOperator::sub:
+            result = (long long) (uLeft - uRight);
+            return true;
+        case ExprOperator::mult:
+            result = (long long) (uLeft * uRight);
+            return true;
+        case ExprOperator::div:
+        case ExprOperator::mod:
+            if (right == 0 || (left == LLONG_MIN && right == -1)) return false;
+
+            result = op == ExprOperator::div ? left / right : left % right;
+            return true;
+        case ExprOperator::logicalOr:
+            result = left != 0 || right != 0;
+            return true;
+        case ExprOperator::logicalAnd:
+            result = left != 0 && right != 0;
+            return true;
+        case ExprOperator::equals:
+            result = left == right;
+            return true;
+        case ExprOperator::notEquals:
+            result = left != right;
+            return true;
+        case ExprOperator::biggerThan:
+            result = left > right;
+            return true;
+        case ExprOperator::biggerThanEquals:
+            result = left >= right;
+            return true;
+        case ExprOperator::lessThan:
+            result = left < right;
+            return true;
+        case ExprOperator::lessThanEquals:
+            result = left <= right;
+            return true;
+    }
+
+    return false;
+}
+
+void ILAnalysis::renameVariables(ThreeAddressStmtP stmt, const std::unordered_map<std::string, std::string> &names) {
+    forEachVariable(stmt, [&names](Variable &var) {
+        if (names.contains(var.name)) var.name = names.at(var.name);
+    });
+}
+
+void ILAnalysis::forEachVariable(ThreeAddressStmtP stmt, const std::function<void(Variable &)> &visit) {
+    if (auto tempAssignment = dynamic_cast<TempAssignmentTAStmtP>(stmt)) {
+        forEachExprVariable(tempAssignment->expr, visit);
+    } else if (auto varAssignment = dynamic_cast<VarAssignmentTAStmtP>(stmt)) {
+        forEachExprVariable(varAssignment->var, visit);
+        forEachExprVariable(varAssignment->expr, visit);
+    } else if (auto functionParamPush = dynamic_cast<FunctionParamPushStmtP>(stmt)) {
+        forEachExprVariable(functionParamPush->expr, visit);
+    } else if (auto gotoIfZeroStmt = dynamic_cast<GotoIfZeroStmtP>(stmt)) {
+        forEachExprVariable(gotoIfZeroStmt->expr, visit);
+    } else if (auto gotoIfNotZeroStmt = dynamic_cast<GotoIfNotZeroStmtP>(stmt)) {
+        forEachExprVariable(gotoIfNotZeroStmt->expr, visit);
+    } else if (auto gotoIfCompareStmt = dynamic_cast<GotoIfCompareStmtP>(stmt)) {
+        forEachExprVariable(gotoIfCompareStmt->comparison, visit);
+    } else if (auto setReturnValue = dynamic_cast<SetReturnValueStmtP>(stmt)) {
+        forEachExprVariable(setReturnValue->expr, visit);
+    } else if (auto scopeEnter = dynamic_cast<ScopeEnterStmtP>(stmt)) {
+        for (auto &var: scopeEnter->vars) visit(var);
+    } else if (auto vectorLoad = dynamic_cast<VectorLoadStmtP>(stmt)) {
+        forEachExprVariable(vectorLoad->source, visit);
+    } else if (auto vectorStore = dynamic_cast<VectorStoreStmtP>(stmt)) {
+        forEachExprVariable(vectorStore->target, visit);
+    } else if (auto vectorBroadcast = dynamic_cast<VectorBroadcastStmtP>(stmt)) {
+        forEachExprVariable(vectorBroadcast->value, visit);
+    }
+}
+
+void ILAnalysis::forEachExprVariable(ThreeAddressExprP expr, const std::function<void(Variable &)> &visit) {
+    if (auto var = dynamic_cast<VariableValP>(expr)) {
+        visit(var->var);
+
+        if (auto subVar = dynamic_cast<SubscriptableVariableValP>(var)) forEachExprVariable(subVar->index, visit);
+    } else if (auto logicalNot = dynamic_cast<LogicalNotExprP>(expr)) {
+        forEachExprVariable(logicalNot->expr, visit);
+    } else if (auto numericNeg = dynamic_cast<NumericNegExprP>(expr)) {
+        forEachExprVariable(numericNeg->expr, visit);
+    } else if (auto addrVar = dynamic_cast<AddrVarExprP>(expr)) {
+        forEachExprVariable(addrVar->addressable, visit);
+    } else if (auto binary = dynamic_cast<BinaryExprP>(expr)) {
+        forEachExprVariable(binary->left, visit);
+        forEachExprVariable(binary->right, visit);
+    } else if (auto select = dynamic_cast<SelectExprP>(expr)) {
+        forEachExprVariable(select->comparison, visit);
+        forEachExprVariable(select->trueValue, visit);
+        forEachExprVariable(select->falseValue, visit);
+    }
+}
+
+VariableValP ILAnalysis::assignedVariable(ThreeAddressStmtP stmt) {
+    if (auto varAssignment = dynamic_cast<VarAssignmentTAStmtP>(stmt)) {
+        return varAssignment->var;
+    }
+
+    return nullptr;
+}
+
+FunctionCallExprP ILAnalysis::getCall(ThreeAddressStmtP stmt) {
+    if (auto functionCall = dynamic_cast<FunctionCallExprP>(stmt)) {
+        return functionCall;
+    } else if (auto tempAssignment = dynamic_cast<TempAssignmentTAStmtP>(stmt)) {
+        return dynamic_cast<FunctionCallExprP>(tempAssignment->expr);
+    }
+
+    return nullptr;
+}
+
+std::string ILAnalysis::jumpTarget(ThreeAddressStmtP stmt) {
+    if (auto gotoStmt = dynamic_cast<GotoStmtP>(stmt)) {
+        return gotoStmt->labelName;
+    } else if (auto gotoIfZeroStmt = dynamic_cast<GotoIfZeroStmtP>(stmt)) {
+        return gotoIfZeroStmt->labelName;
+    } else if (auto gotoIfNotZeroStmt = dynamic_cast<GotoIfNotZeroStmtP>(stmt)) {
+        return gotoIfNotZeroStmt->labelName;
+    } else if (auto gotoIfCompareStmt = dynamic_cast<GotoIfCompareStmtP>(stmt)) {
+        return gotoIfCompareStmt->labelName;
+    }
+
+    return "";
+}
+
+bool ILAnalysis::isJump(ThreeAddressStmtP stmt) {
+    return dynamic_cast<GotoStmtP>(stmt) || dynamic_cast<GotoIfZeroStmtP>(stmt) ||
+           dynamic_cast<GotoIfNotZeroStmtP>(stmt) || dynamic_cast<GotoIfCompareStmtP>(stmt);
+}
+
+void ILAnalysis::setJumpTarget(ThreeAddressStmtP stmt, const std::string &label) {
+    if (auto gotoStmt = dynamic_cast<GotoStmtP>(stmt)) {
+        gotoStmt->labelName = label;
+    } else if (auto gotoIfZeroStmt = dynamic_cast<GotoIfZeroStmtP>(stmt)) {
+        gotoIfZeroStmt->labelName = label;
+    } else if (auto gotoIfNotZeroStmt = dynamic_cast<GotoIfNotZeroStmtP>(stmt)) {
+        gotoIfNotZeroStmt->labelName = label;
+    } else if (auto gotoIfCompareStmt = dynamic_cast<GotoIfCompareStmtP>(stmt)) {
+        gotoIfCompareStmt->labelName = label;
+    }
+}
+
+std::unordered_set<std::string> ILAnalysis::addressTakenVariables(const std::list<ThreeAddressStmtP> &stmts) {
+    std::unordered_set<std::string> addressTaken;
+
+    auto checkExpr = [&addressTaken](ThreeAddressExprP expr) {
+        if (auto addrVar = dynamic_cast<AddrVarExprP>(expr)) {
+            // The address held by a pointer is not the address of the pointer variable itself
+            if (!addrVar->addressable->var.ptrType) addressTaken.insert(addrVar->addressable->var.name);
+        }
+    };
+
+    for (auto stmt: stmts) {
+        if (auto tempAssignment = dynamic_cast<TempAssignmentTAStmtP>(stmt)) {
+            checkExpr(tempAssignment->expr);
+        } else if (auto varAssignment = dynamic_cast<VarAssignmentTAStmtP>(stmt)) {
+            checkExpr(varAssignment->expr);
+        } else if (auto functionParamPush = dynamic_cast<FunctionParamPushStmtP>(stmt)) {
+            checkExpr(functionParamPush->expr);
+        } else if (auto setReturnValue = dynamic_cast<SetReturnValueStmtP>(stmt)) {
+            checkExpr(setReturnValue->expr);
+        }
+    }
+
+    return addressTaken;
+}
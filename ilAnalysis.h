@@ -0,0 +1,197 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#ifndef COMPILER_ILANALYSIS_H
+#define COMPILER_ILANALYSIS_H
+
+#include <vector>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
+#include "threeAddressExpressionsAndStatements.h"
+
+/**
+ * @brief Helpers used by the optimization passes to inspect, copy and rewrite IL statements.
+ *
+ * The IL has no def-use chains of its own, every pass asks these helpers which temporaries and
+ * variables a statement reads or writes.
+ */
+class ILAnalysis {
+public:
+    /**
+     * @brief Creates a deep copy of an IL expression.
+     *
+     * @param expr The expression to copy.
+     * @return The copied expression, owned by the caller.
+     */
+    static ThreeAddressExpr *cloneExpr(ThreeAddressExprP expr);
+
+    /**
+     * @brief Creates a deep copy of a uni expression.
+     *
+     * @param expr The expression to copy.
+     * @return The copied expression, owned by the caller.
+     */
+    static UniExpr *cloneUniExpr(UniExprP expr);
+
+    /**
+     * @brief Creates a deep copy of an IL statement.
+     *
+     * @param stmt The statement to copy.
+     * @return The copied statement, owned by the caller.
+     */
+    static ThreeAddressStmt *cloneStmt(ThreeAddressStmtP stmt);
+
+    /**
+     * @brief Collects the temporaries read by an expression.
+     *
+     * The collected nodes point into the expression itself so a caller can rename a temporary in place.
+     *
+     * @param expr The expression to scan.
+     * @param temps The vector the temporaries are appended to.
+     */
+    static void collectExprTemps(ThreeAddressExprP expr, std::vector<UniTempP> &temps);
+
+    /**
+     * @brief Collects the temporaries read by a statement, including the index of a subscripted assignment target.
+     *
+     * @param stmt The statement to scan.
+     * @return The temporary nodes read by the statement.
+     */
+    static std::vector<UniTempP> usedTemps(ThreeAddressStmtP stmt);
+
+    /**
+     * @brief Returns the id of the temporary assigned by the statement, or -1 if it does not assign a temporary.
+     */
+    static int definedTemp(ThreeAddressStmtP stmt);
+
+    /**
+     * @brief Collects the variables whose value is read by an expression.
+     *
+     * Plain variables and pointers used as a subscript base are appended to 'scalarReads',
+     * subscripted loads (array elements or values behind pointers) are appended to 'elementReads'.
+     *
+     * @param expr The expression to scan.
+     * @param scalarReads The vector the read variables are appended to.
+     * @param elementReads The vector the subscripted loads are appended to.
+     */
+    static void collectExprReads(ThreeAddressExprP expr, std::vector<VariableValP> &scalarReads,
+                                 std::vector<SubscriptableVariableValP> &elementReads);
+
+    /**
+     * @brief Collects the variables whose value is read by a statement, in the same form as 'collectExprReads'.
+     *
+     * @param stmt The statement to scan.
+     * @param scalarReads The vector the read variables are appended to.
+     * @param elementReads The vector the subscripted loads are appended to.
+     */
+    static void collectStmtReads(ThreeAddressStmtP stmt, std::vector<VariableValP> &scalarReads,
+                                 std::vector<SubscriptableVariableValP> &elementReads);
+
+    /**
+     * @brief Checks if a statement reads the variable with the given name (its value or one of its elements).
+     */
+    static bool readsVariable(ThreeAddressStmtP stmt, const std::string &name);
+
+    /**
+     * @brief Replaces every read of a plain variable in a statement by a new expression.
+     *
+     * @param stmt The statement to rewrite.
+     * @param name The name of the variable.
+     * @param makeValue Creates the expression replacing one read.
+     */
+    static void replaceVariableReads(ThreeAddressStmtP stmt, const std::string &name,
+                                     const std::function<UniExpr *()> &makeValue);
+
+    /**
+     * @brief Replaces every read of a temporary in a statement by a new expression.
+     *
+     * @param stmt The statement to rewrite.
+     * @param id The id of the temporary.
+     * @param makeValue Creates the expression replacing one read.
+     */
+    static void replaceTempReads(ThreeAddressStmtP stmt, int id, const std::function<UniExpr *()> &makeValue);
+
+    /**
+     * @brief Computes a binary operator on two constants the way the Generator's code does on 64 bit registers.
+     *
+     * @param op The operator.
+     * @param left The left operand.
+     * @param right The right operand.
+     * @param result Set to the result.
+     * @return Whether the result is defined (false for a division that would trap).
+     */
+    static bool evaluateOperator(ExprOperator op, long long left, long long right, long long &result);
+
+    /**
+     * @brief Renames every occurrence of the given variables in a statement, declarations included.
+     *
+     * @param stmt The statement to rewrite.
+     * @param names Maps the old names to the new ones, other variables are left as is.
+     */
+    static void renameVariables(ThreeAddressStmtP stmt, const std::unordered_map<std::string, std::string> &names);
+
+    /**
+     * @brief Visits every occurrence of a variable in a statement, declarations included.
+     *
+     * @param stmt The statement to visit.
+     * @param visit Called with each occurrence, which it may change.
+     */
+    static void forEachVariable(ThreeAddressStmtP stmt, const std::function<void(Variable &)> &visit);
+
+    /**
+     * @brief Returns the variable assigned by a variable assignment statement, or nullptr for other statements.
+     */
+    static VariableValP assignedVariable(ThreeAddressStmtP stmt);
+
+    /**
+     * @brief Returns the function call performed by the statement (a call statement or a temporary
+     * assigned with a call's return value), or nullptr if the statement does not call a function.
+     */
+    static FunctionCallExprP getCall(ThreeAddressStmtP stmt);
+
+    /**
+     * @brief Returns the label a goto statement (conditional or not) jumps to, or an empty string.
+     */
+    static std::string jumpTarget(ThreeAddressStmtP stmt);
+
+    /**
+     * @brief Checks if the statement ends a basic block by jumping (conditional or unconditional goto).
+     */
+    static bool isJump(ThreeAddressStmtP stmt);
+
+    /**
+     * @brief Changes the label a goto statement (conditional or not) jumps to, other statements are left as is.
+     */
+    static void setJumpTarget(ThreeAddressStmtP stmt, const std::string &label);
+
+    /**
+     * @brief Collects the names of the variables whose address is taken anywhere in the statements.
+     *
+     * Those variables may be read and written through pointers and by called functions.
+     *
+     * @param stmts The statements to scan.
+     * @return The names of the address taken variables.
+     */
+    static std::unordered_set<std::string> addressTakenVariables(const std::list<ThreeAddressStmtP> &stmts);
+
+    // Disallow creating an instance of this object
+    ILAnalysis() = delete;
+
+private:
+    static void forEachExprVariable(ThreeAddressExprP expr, const std::function<void(Variable &)> &visit);
+
+    static void replaceReads(ThreeAddressStmtP stmt, const std::function<bool(UniExprP)> &matches,
+                             const std::function<UniExpr *()> &makeValue);
+
+    static void replaceExprReads(ThreeAddressExpr *&expr, const std::function<bool(UniExprP)> &matches,
+                                 const std::function<UniExpr *()> &makeValue);
+
+    static void replaceUniExprReads(UniExpr *&expr, const std::function<bool(UniExprP)> &matches,
+                                    const std::function<UniExpr *()> &makeValue);
+};
+
+#endif //COMPILER_ILANALYSIS_H
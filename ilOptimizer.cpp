@@ -0,0 +1,174 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#include "ilOptimizer.h"
+
+void ILOptimizer::optimizeProgram() {
+    std::vector<ILFunction> functions = splitFunctions();
+
+    // Tail recursive functions become loops first, so the inliner no longer sees them as recursive
+    for (auto &function: functions) {
+        eliminateTailRecursion(function);
+    }
+
+    // Calls computing constants are replaced by their results before the functions are cloned or inlined
+    analyzeFunctionEffects(functions);
+    evaluateConstantCalls(functions);
+
+    specializeFunctions(functions);
+    inlineFunctions(functions);
+
+    for (auto &function: functions) {
+        functionDeclarations[function.declaration->name] = function.declaration;
+    }
+
+    analyzeFunctionEffects(functions);
+
+    if (options.memoize) memoizeFunctions(functions);
+
+    for (auto &function: functions) {
+        optimizeFunction(function);
+    }
+
+    joinFunctions(functions);
+}
+
+std::vector<ILFunction> ILOptimizer::splitFunctions() {
+    std::vector<ILFunction> functions;
+    auto &programStmts = this->ilProgram->ilStmts;
+
+    while (!programStmts.empty()) {
+        auto declaration = dynamic_cast<FunctionDeclarationStmtP>(programStmts.front());
+        functions.emplace_back(declaration);
+
+        // Move every statement up to and including the function exit to the function's list
+        auto functionEnd = programStmts.begin();
+
+        while (!dynamic_cast<FunctionExitStmtP>(*functionEnd)) ++functionEnd;
+
+        functions.back().stmts.splice(functions.back().stmts.end(), programStmts,
+                                      programStmts.begin(), std::next(functionEnd));
+    }
+
+    return functions;
+}
+
+void ILOptimizer::joinFunctions(std::vector<ILFunction> &functions) {
+    for (auto &function: functions) {
+        this->ilProgram->ilStmts.splice(this->ilProgram->ilStmts.end(), function.stmts);
+    }
+}
+
+void ILOptimizer::optimizeFunction(ILFunction &function) {
+    // Calls without side effects are merged and removed like the operators, leaving their arguments unread
+    bool merged = mergePureCalls(function);
+
+    if (removeDeadCalls(function) || merged) {
+        while (removeDeadTemps(function));
+    }
+
+    hoistLoopInvariants(function);
+    unswitchLoops(function);
+    recognizeIdioms(function);
+
+    bool vectorized = vectorizeLoops(function);
+    bool unrolled = unrollLoops(function);
+    bool reduced = reduceInductionVariables(function);
+
+    // These leave behind computations nothing reads, removing one may leave its operands unread
+    if (vectorized || unrolled || reduced) {
+        while (removeDeadTemps(function));
+    }
+
+    // The ranges it marks for the Generator must describe the final statements
+    analyzeValueRanges(function);
+
+    // Branches the ranges didn't remove may be made branchless
+    convertIfs(function);
+
+    // The statements returning the call's value are removed
+    markTailCalls(function);
+
+    // Runs last, no other pass reads the fused jumps
+    fuseCompareBranches(function);
+}
+
+BinaryExpr *ILOptimizer::addConstant(UniExpr *value, long long constant) {
+    if (constant < 0) return new BinaryExpr(value, new ImIntVal(std::to_string(-constant)), ExprOperator::sub);
+
+    return new BinaryExpr(value, new ImIntVal(std::to_string(constant)), ExprOperator::add);
+}
+
+bool ILOptimizer::removeDeadTemps(ILFunction &function) {
+    ControlFlowGraph cfg(function.stmts);
+    bool removed = false;
+
+    cfg.computeTempLiveness();
+
+    for (const BasicBlock &block: cfg.blocks) {
+        std::unordered_set<int> live = cfg.tempLiveOut[block.id];
+
+        std::vector<ILStmtIterator> blockStmts;
+
+        for (auto it = block.begin; it != block.end; ++it) {
+            blockStmts.push_back(it);
+        }
+
+        // Walk the block backwards keeping the set of temporaries read later on
+        for (auto it = blockStmts.rbegin(); it != blockStmts.rend(); ++it) {
+            int defined = ILAnalysis::definedTemp(**it);
+
+            if (defined != -1 && !live.contains(defined) && !ILAnalysis::getCall(**it)) {
+                delete **it;
+                function.stmts.erase(*it);
+                removed = true;
+                continue;
+            }
+
+            if (defined != -1) live.erase(defined);
+
+            for (auto temp: ILAnalysis::usedTemps(**it)) {
+                live.insert(temp->id);
+            }
+        }
+    }
+
+    return removed;
+}
+
+bool ILOptimizer::removeUnreachableCode(ILFunction &function) {
+    ControlFlowGraph cfg(function.stmts);
+    bool removed = false;
+
+    for (const BasicBlock &block: cfg.blocks) {
+        if (cfg.reachable[block.id]) continue;
+
+        std::vector<ILStmtIterator> deadStmts;
+        std::vector<ILStmtIterator> openScopes;
+
+        for (auto it = block.begin; it != block.end; ++it) {
+            if (dynamic_cast<ScopeEnterStmtP>(*it)) {
+                openScopes.push_back(it);
+            } else if (dynamic_cast<ScopeExitStmtP>(*it)) {
+                // A scope entered and exited inside the block has no effect, other scope statements stay
+                // so the scopes remain balanced
+                if (!openScopes.empty()) {
+                    deadStmts.push_back(openScopes.back());
+                    deadStmts.push_back(it);
+                    openScopes.pop_back();
+                }
+            } else if (!dynamic_cast<FunctionDeclarationStmtP>(*it) && !dynamic_cast<FunctionExitStmtP>(*it)) {
+                deadStmts.push_back(it);
+            }
+        }
+
+        for (auto it: deadStmts) {
+            delete *it;
+            function.stmts.erase(it);
+            removed = true;
+        }
+    }
+
+    return removed;
+}
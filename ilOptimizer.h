@@ -0,0 +1,1054 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#ifndef COMPILER_ILOPTIMIZER_H
+#define COMPILER_ILOPTIMIZER_H
+
+#include <list>
+#include <map>
+#include <algorithm>
+#include <climits>
+#include <cstdlib>
+#include <optional>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include "threeAddressExpressionsAndStatements.h"
+#include "controlFlowGraph.h"
+#include "compilerOptions.h"
+#include "ilAnalysis.h"
+#include "frameLayout.h"
+
+/**
+ * @brief The IL statements of a single function, from its declaration to its function exit statement.
+ */
+class ILFunction {
+public:
+    FunctionDeclarationStmtP declaration;
+    std::list<ThreeAddressStmtP> stmts;
+
+    explicit ILFunction(FunctionDeclarationStmtP declaration) : declaration(declaration) {
+
+    }
+
+    /**
+     * @brief Allocates a new temporary that is not used anywhere else in the function.
+     *
+     * @return The id of the new temporary.
+     */
+    int newTemp() {
+        return ++declaration->maxTemp;
+    }
+};
+
+/**
+ * @brief What a function may do besides computing its return value, from the least to the most.
+ */
+enum class FunctionPurity {
+    pure,           // Computes only from its arguments
+    readOnly,       // Also reads memory through pointers
+    sideEffecting,  // Writes memory through pointers, does input or output or exits
+};
+
+/**
+ * @brief The effects of calling a function, including the effects of the functions it calls.
+ */
+class FunctionEffects {
+public:
+    FunctionPurity purity = FunctionPurity::pure;
+    // Whether a call may trap or run forever (divisions, loads, loops or recursion), so it can't run on a path
+    // that did not make it before
+    bool mayNotReturn = false;
+};
+
+/**
+ * @brief A variable of a function run at compile time, an array holds a value for each element.
+ */
+class EvaluatedVariable {
+public:
+    Variable var;
+    // Empty until assigned, reading a variable never assigned stops the run
+    std::vector<std::optional<long long>> values;
+
+    explicit EvaluatedVariable(const Variable &var) : var(var), values(std::max(var.arrSize, 1)) {
+
+    }
+};
+
+/**
+ * @brief The interval of values a temporary or a variable may hold, as a 64 bit register holds it.
+ */
+class ValueRange {
+public:
+    long long min = LLONG_MIN;
+    long long max = LLONG_MAX;
+
+    ValueRange() = default;
+
+    ValueRange(long long min, long long max) : min(min), max(max) {
+
+    }
+
+    bool operator==(const ValueRange &other) const = default;
+
+    /**
+     * @brief Checks if every value of the range is also in 'other'.
+     */
+    bool within(const ValueRange &other) const {
+        return min >= other.min && max <= other.max;
+    }
+
+    /**
+     * @brief Returns the smallest range holding the values of both ranges.
+     */
+    ValueRange join(const ValueRange &other) const {
+        return {std::min(min, other.min), std::max(max, other.max)};
+    }
+};
+
+/**
+ * @brief The ranges known at some point of a function, temporaries and variables without a range may hold any
+ * value of their type.
+ */
+class RangeState {
+public:
+    // Whether any path reaches the point, the ranges are meaningless otherwise
+    bool reached = false;
+    std::unordered_map<int, ValueRange> temps;
+    std::unordered_map<std::string, ValueRange> vars;
+    // The range of the value set to be returned, none before it is set
+    std::optional<ValueRange> returned;
+
+    bool operator==(const RangeState &other) const = default;
+};
+
+/**
+ * @brief Describes what the statements of a loop write, used to decide which computations stay the same
+ * on every iteration.
+ */
+class LoopEffects {
+public:
+    // Variables assigned directly inside the loop
+    std::unordered_set<std::string> assignedVars;
+    // Arrays with an element assigned inside the loop
+    std::unordered_set<std::string> storedArrays;
+    // Variables declared by scopes inside the loop (they may shadow outer variables)
+    std::unordered_set<std::string> declaredVars;
+    // Number of assignments to each temporary inside the loop
+    std::unordered_map<int, int> tempDefs;
+    // Whether the loop stores through a pointer
+    bool pointerStore = false;
+    // Whether the loop calls a function that may write memory
+    bool hasCall = false;
+    // Whether the loop writes to a variable whose address is taken (directly, through a pointer or by a call)
+    bool aliasedWrite = false;
+};
+
+/**
+ * @brief An assignment stepping an induction variable by a constant, either 'i = i + c' or
+ * 'tempN := i + c' followed by 'i = tempN'.
+ */
+class InductionStep {
+public:
+    // The assignment to the induction variable
+    ILStmtIterator assignment;
+    // The signed constant added on each step
+    long long step;
+
+    InductionStep(ILStmtIterator assignment, long long step) : assignment(assignment), step(step) {
+
+    }
+};
+
+/**
+ * @brief An element access 'base[i + offset]' whose index follows an induction variable 'i'.
+ */
+class DerivedAccess {
+public:
+    SubscriptableVariableValP access;
+    long long offset;
+
+    DerivedAccess(SubscriptableVariableValP access, long long offset) : access(access), offset(offset) {
+
+    }
+};
+
+/**
+ * @brief A loop stepping a variable by a constant once per iteration and exiting only when a comparison of the
+ * variable with a loop-invariant bound fails at the bottom of the loop.
+ */
+class CountedLoop {
+public:
+    // The label the bottom test jumps back to, the first statement of the loop
+    ILStmtIterator begin;
+    // The bottom test, the last statement of the loop
+    ILStmtIterator testJump;
+    // The label of the block with the bottom test
+    std::string conditionLabel;
+    // Whether the loop is entered at its bottom test (a while loop) rather than at its first statement
+    bool topTest = false;
+    Variable inductionVar = Variable("", VariableType::intType, false);
+    // The single assignment stepping the induction variable
+    ILStmtIterator stepAssignment;
+    long long step = 0;
+    // The comparison computed for the bottom test and the side of the induction variable
+    BinaryExprP comparison = nullptr;
+    bool inductionOnLeft = true;
+    // Number of statements of one iteration, excluding labels
+    int iterationSize = 0;
+};
+
+/**
+ * @brief A variable accumulated by every iteration of a vectorized loop, kept in the lanes of a vector register.
+ */
+class VectorReduction {
+public:
+    Variable var;
+    // 'add' for sums (subtracted elements are accumulated with 'sub'), 'min' or 'max'
+    VectorOperator op;
+    int reg;
+
+    VectorReduction(Variable var, VectorOperator op, int reg) : var(std::move(var)), op(op), reg(reg) {
+
+    }
+};
+
+/**
+ * @brief The vector statements running 'lanes' iterations of a counted loop at once.
+ */
+class VectorizedLoop {
+public:
+    VariableType elementType = VariableType::intType;
+    int width = 0;
+    int lanes = 0;
+    // Broadcasts of loop-invariant values and reduction initializations, run once before the vector loop
+    std::list<ThreeAddressStmtP> setup;
+    // The body of the vector loop, without the induction variable's step
+    std::list<ThreeAddressStmtP> body;
+    std::vector<VectorReduction> reductions;
+    // The variables subscripted by the vector loads and stores
+    std::vector<Variable> loadBases;
+    std::vector<Variable> storeBases;
+    // Number of vector registers used
+    int regCount = 0;
+
+    ~VectorizedLoop() {
+        for (auto stmt: setup) delete stmt;
+        for (auto stmt: body) delete stmt;
+    }
+};
+
+/**
+ * @brief The ILOptimizer class rewrites the IL program generated by the ILGenerator to a faster equivalent.
+ *
+ * The program is split to functions and each function goes through the optimization passes
+ * before the functions are joined back to a single statement list.
+ */
+class ILOptimizer {
+public:
+    /**
+     * @brief Constructor for the ILOptimizer class.
+     *
+     * @param ilProgram The IL program to optimize in place.
+     * @param options The compiler options selecting the passes.
+     */
+    ILOptimizer(ThreeAddressProgramP ilProgram, const CompilerOptions &options) : options(options) {
+        this->ilProgram = ilProgram;
+    }
+
+    /**
+     * @brief Runs the optimization passes over every function of the program.
+     */
+    void optimizeProgram();
+
+private:
+    // Number of register variables a function may have, one for each callee-saved register the Generator gives them
+    static const int MAX_REGISTER_VARS = 4;
+    // Prefix of compiler generated variable names, identifiers in the source can't start with it
+    inline static const std::string GENERATED_VAR_PREFIX = "$";
+    // Statement budgets of a fully unrolled loop and of the unrolled body of a partially unrolled loop
+    static const int FULL_UNROLL_BUDGET = 64;
+    static const int PARTIAL_UNROLL_BUDGET = 96;
+    // Largest loop (in statements) that is unswitched, and the number of statements unswitching may add to a function
+    static const int UNSWITCH_LOOP_LIMIT = 64;
+    static const int UNSWITCH_GROWTH_BUDGET = 128;
+    // Vector registers a vectorized loop may use, the Generator keeps the rest for scratch
+    static const int MAX_VECTOR_REGS = 12;
+    // Vector register widths in bytes for SSE2 and AVX2
+    static const int SSE_VECTOR_WIDTH = 16;
+    static const int AVX_VECTOR_WIDTH = 32;
+    // Number of pointer pairs whose overlap is tested at run time before entering a vector loop
+    static const int MAX_ALIAS_CHECKS = 6;
+    // Fewest iterations a loop with a constant start and bound needs to be replaced by a runtime routine call
+    static const int IDIOM_MIN_ITERATIONS = 16;
+    // Instructions saved by inlining a call (the overflow check, the prologue, 'leave' and 'ret') and each
+    // parameter push, the factor for calls inside loops, the largest function inlined (in statements) and the
+    // number of statements inlining may add to a function
+    static const int INLINE_CALL_COST = 10;
+    static const int INLINE_PARAM_COST = 2;
+    static const int INLINE_LOOP_WEIGHT = 4;
+    static const int INLINE_SIZE_LIMIT = 40;
+    static const int INLINE_GROWTH_BUDGET = 160;
+    // Clones a function may get for constant arguments, the weight a set of constants needs (calls in loops weigh
+    // 'SPECIALIZE_LOOP_WEIGHT') and the largest function cloned, in statements
+    static const int MAX_SPECIALIZATIONS = 2;
+    static const int SPECIALIZE_MIN_WEIGHT = 2;
+    static const int SPECIALIZE_LOOP_WEIGHT = 4;
+    static const int SPECIALIZE_SIZE_LIMIT = 120;
+    // Statements a call run at compile time may execute, counting its nested calls, and the nested calls it may make
+    static const int EVAL_STEP_LIMIT = 100000;
+    static const int EVAL_DEPTH_LIMIT = 100;
+    // Most parameters a memoized function may have, each one divides the table's entries between more arguments
+    static const int MAX_MEMO_PARAMS = 2;
+    // Times the ranges entering a block may grow before they are widened, and the passes then narrowing them back
+    static const int RANGE_WIDEN_PASSES = 3;
+    static const int RANGE_NARROW_PASSES = 2;
+    // Most passes over a function's blocks the range analysis may take before giving up
+    static const int RANGE_PASS_LIMIT = 100;
+    // Costs an if-conversion weighs, in rough cycles: each statement of an arm and each variable or element it
+    // loads, each select (the comparison it repeats, its conditional move stands for the arm's store), the latency
+    // a select adds to each iteration when the loop's next comparison reads its variable, and the expected cost of
+    // a branch without a profile, a misprediction penalty of about 16 cycles paid one time in four
+    static const int IF_CONVERSION_STMT_COST = 1;
+    static const int IF_CONVERSION_LOAD_COST = 1;
+    static const int IF_CONVERSION_SELECT_COST = 1;
+    static const int IF_CONVERSION_CHAIN_COST = 4;
+    static const int IF_CONVERSION_BRANCH_COST = 4;
+    // The comparison holding exactly when each relational or equality operator's comparison doesn't
+    inline static const std::unordered_map<ExprOperator, ExprOperator> invertedComparisons = {
+            {ExprOperator::equals,           ExprOperator::notEquals},
+            {ExprOperator::notEquals,        ExprOperator::equals},
+            {ExprOperator::biggerThan,       ExprOperator::lessThanEquals},
+            {ExprOperator::biggerThanEquals, ExprOperator::lessThan},
+            {ExprOperator::lessThan,         ExprOperator::biggerThanEquals},
+            {ExprOperator::lessThanEquals,   ExprOperator::biggerThan},
+    };
+    // Size in bytes of each variable type, as laid out by the Generator
+    inline static const std::unordered_map<VariableType, int> typeSizes = {
+            {VariableType::longType, 8},
+            {VariableType::intType,  4},
+            {VariableType::charType, 1},
+    };
+
+    // The program being optimized
+    ThreeAddressProgramP ilProgram;
+    // The options given to the compiler
+    const CompilerOptions &options;
+    // The declarations of the functions defined in the program, by name
+    std::unordered_map<std::string, FunctionDeclarationStmtP> functionDeclarations;
+    // The effects of calling each function defined in the program, by name
+    std::unordered_map<std::string, FunctionEffects> functionEffects;
+    // The range of the value each optimized function leaves in the return register, before the caller extends it
+    // from the return type
+    std::unordered_map<std::string, ValueRange> returnRanges;
+
+    /**
+     * @brief Splits the program statement list to the functions' statement lists.
+     */
+    std::vector<ILFunction> splitFunctions();
+
+    /**
+     * @brief Moves the functions' statements back to the program statement list.
+     */
+    void joinFunctions(std::vector<ILFunction> &functions);
+
+    /**
+     * @brief Builds the call graph of the functions defined in the program, calls to builtin functions are left out.
+     *
+     * @param functions The functions of the program.
+     * @return The names of the functions each function calls, by the caller's name.
+     */
+    static std::unordered_map<std::string, std::unordered_set<std::string>>
+    buildCallGraph(const std::vector<ILFunction> &functions);
+
+    /**
+     * @brief Returns the names of the functions that can reach themselves through the call graph.
+     */
+    static std::unordered_set<std::string>
+    findRecursiveFunctions(const std::unordered_map<std::string, std::unordered_set<std::string>> &callees);
+
+    /**
+     * @brief Interprocedural side effect analysis.
+     *
+     * Each function is classified by its own statements, stores through pointers and builtin calls make it
+     * side-effecting and loads through pointers read-only, and then takes the effects of the functions it calls,
+     * repeated until the recursive functions agree. The results are kept in 'functionEffects'.
+     *
+     * @param functions The functions of the program.
+     */
+    void analyzeFunctionEffects(std::vector<ILFunction> &functions);
+
+    /**
+     * @brief Checks if evaluating the expressions of a statement may trap.
+     */
+    static bool stmtMayTrap(ThreeAddressStmtP stmt);
+
+    /**
+     * @brief Returns the purity of the called function, side-effecting for builtin functions.
+     */
+    FunctionPurity callPurity(FunctionCallExprP call) const;
+
+    /**
+     * @brief Merges repeated calls to pure and read-only functions inside basic blocks.
+     *
+     * The arguments are compared by value numbering, a call passing the same values as an earlier call whose
+     * result is still held by its temporary is replaced by a copy of that temporary. Calls to read-only functions
+     * are merged only with no store or side-effecting call between them.
+     *
+     * @param function The function to optimize.
+     * @return Whether any call was merged.
+     */
+    bool mergePureCalls(ILFunction &function);
+
+    /**
+     * @brief Removes the calls to pure and read-only functions whose result is never read, with their pushes.
+     *
+     * Like the operators the functions are made of, the calls are assumed to return.
+     *
+     * @param function The function to clean up.
+     * @return Whether any call was removed.
+     */
+    bool removeDeadCalls(ILFunction &function);
+
+    /**
+     * @brief Checks if a call to a pure or read-only function returns the same value on every iteration of a loop.
+     *
+     * @param function The function making the call.
+     * @param call The call statement.
+     * @param effects The effects of the loop.
+     * @param addressTaken The variables of the function whose address is taken.
+     * @param alwaysExecuted Whether the call runs on every entry to the loop.
+     * @param pushes Filled with the parameter pushes of the call.
+     * @return Whether the call and its pushes can move to the loop's preheader.
+     */
+    bool isInvariantCall(ILFunction &function, ILStmtIterator call, const LoopEffects &effects,
+                         const std::unordered_set<std::string> &addressTaken, bool alwaysExecuted,
+                         std::vector<ILStmtIterator> &pushes) const;
+
+    /**
+     * @brief Compile-time function evaluation.
+     *
+     * Calls to pure functions whose arguments are all constants are run by an interpreter of the IL and replaced
+     * by their result, which is then propagated through the caller. A run stops at 'EVAL_STEP_LIMIT' statements
+     * or 'EVAL_DEPTH_LIMIT' nested calls, or on anything it can't compute (pointers, variables read before they are
+     * assigned, traps), and the call is then left as is.
+     *
+     * @param functions The functions of the program.
+     */
+    void evaluateConstantCalls(std::vector<ILFunction> &functions);
+
+    /**
+     * @brief Runs a function of the program on constant arguments.
+     *
+     * @param functionsByName The functions of the program, by name.
+     * @param labels The position of each label, by the name of the function it is in.
+     * @param function The function to run.
+     * @param args The arguments, the first parameter's first.
+     * @param depth The number of calls the run is nested in.
+     * @param steps The number of statements run so far, shared with the nested calls.
+     * @param result Set to the returned value, before it is extended from the return type.
+     * @return Whether the function returned within the limits.
+     */
+    bool evaluateFunction(
+            const std::unordered_map<std::string, ILFunction *> &functionsByName,
+            const std::unordered_map<std::string, std::unordered_map<std::string, ILStmtIterator>> &labels,
+            ILFunction &function, const std::vector<long long> &args, int depth, int &steps, long long &result) const;
+
+    /**
+     * @brief Automatic memoization, enabled by '-fmemoize'.
+     *
+     * Pure recursive functions with up to 'MAX_MEMO_PARAMS' integer parameters cache their results in a table of
+     * '-fmemoize-size' entries, shared equally between the parameters: each argument must be between 0 and the
+     * table's range for the call to be cached. The Generator emits the table and its lookup, the function's
+     * declaration gets the range and a temporary keeping the call's entry.
+     *
+     * @param functions The functions of the program.
+     */
+    void memoizeFunctions(std::vector<ILFunction> &functions);
+
+    /**
+     * @brief Function inlining.
+     *
+     * Calls to non-recursive functions defined in the program are replaced by a copy of the callee's body, callees
+     * before their callers. The pushes become assignments to the callee's parameters, declared with the return
+     * value in a scope around the copy, and the copy's variables, temporaries and labels are renamed so they can't
+     * clash with the caller's. A call is inlined when the callee has at most 'INLINE_SIZE_LIMIT' statements, no more
+     * than the instructions the call costs (scaled by 'INLINE_LOOP_WEIGHT' in loops) or is the callee's only call,
+     * and the caller has not grown by 'INLINE_GROWTH_BUDGET' statements. Functions no longer called are removed.
+     * With '--inline-report' every decision is printed.
+     *
+     * @param functions The functions of the program.
+     */
+    void inlineFunctions(std::vector<ILFunction> &functions);
+
+    /**
+     * @brief Function specialization.
+     *
+     * Calls passing constants for parameters the callee reads are grouped by the constants passed. The heaviest
+     * groups of each function, up to 'MAX_SPECIALIZATIONS', get a clone of the function without those parameters.
+     * The constants are propagated and folded in the clone, and the group's calls are redirected to it. A group
+     * needs a weight of 'SPECIALIZE_MIN_WEIGHT', unless it holds every call of the function. The clones then go
+     * through the other passes like any function.
+     *
+     * @param functions The functions of the program, the clones are appended to them.
+     */
+    void specializeFunctions(std::vector<ILFunction> &functions);
+
+    /**
+     * @brief Creates a copy of a function with constants for some of its parameters.
+     *
+     * @param function The function to copy.
+     * @param constants The constants by parameter index, already truncated to the parameters' types.
+     * @param suffix The suffix appended to the function's name and labels.
+     * @return The copy, without the parameters given constants.
+     */
+    static ILFunction specializeFunction(const ILFunction &function, const std::map<int, long long> &constants,
+                                         const std::string &suffix);
+
+    /**
+     * @brief Returns the value a variable of the given type holds after being assigned a constant.
+     */
+    static long long truncateToType(long long value, VariableType type);
+
+    /**
+     * @brief Constant folding and propagation inside basic blocks.
+     *
+     * Operators on constants are computed, temporaries assigned a constant are replaced by it in the rest of
+     * their block, and conditional jumps on constants become unconditional jumps or are removed.
+     *
+     * @param function The function to optimize.
+     * @return Whether anything was folded.
+     */
+    static bool foldConstants(ILFunction &function);
+
+    /**
+     * @brief Folds the operators on constants of an expression, replacing the expression when it becomes a constant.
+     *
+     * @return Whether anything was folded.
+     */
+    static bool foldExpr(ThreeAddressExpr *&expr);
+
+    /**
+     * @brief Folds the operators on constants of a uni expression, replacing it when it becomes a constant.
+     *
+     * @return Whether anything was folded.
+     */
+    static bool foldUniExpr(UniExpr *&expr);
+
+    /**
+     * @brief Returns the end label of a function laid out as generated (its declaration, its scope and the end label
+     * followed by the function exit), or nullptr for other layouts.
+     */
+    static LabelStmtP functionEndLabel(const ILFunction &function);
+
+    /**
+     * @brief Tail recursion elimination.
+     *
+     * A call of the function to itself whose value is returned right away, or that ends the body of the function,
+     * is replaced by assignments of the arguments to the parameters and a jump back to the start of the body.
+     * Only calls outside scopes with variables are replaced, and none in functions whose variables' addresses are
+     * taken, as an address from a previous call could then point at a variable of the current one.
+     *
+     * @param function The function to optimize.
+     * @return Whether any call was replaced.
+     */
+    static bool eliminateTailRecursion(ILFunction &function);
+
+    /**
+     * @brief Value range analysis.
+     *
+     * Finds the range of every temporary and of the function's scalar variables at each statement, starting from
+     * their types and the constants assigned, narrowed by the conditions jumped on and widened on loops until they
+     * stop growing. Then:
+     * - Comparisons and conditional jumps whose result is known are folded, with the code they make unreachable.
+     * - Divisions and remainders of non-negative values, or of values that fit in 32 bits, are marked so the
+     *   Generator uses shifts, masks and the cheaper unsigned or 32 bit divisions.
+     * - Additions, subtractions and multiplications whose result is non-negative and fits in 32 bits are marked so
+     *   the Generator computes them on 32 bit registers, and the reads of non-negative variables so their loads zero
+     *   extend them.
+     * - Calls to functions whose returned values already fit their return type are marked so the Generator
+     *   doesn't extend them again.
+     *
+     * The range of the values the function returns is kept in 'returnRanges' for its callers.
+     *
+     * @param function The function to optimize.
+     * @return Whether anything was folded.
+     */
+    bool analyzeValueRanges(ILFunction &function);
+
+    /**
+     * @brief Computes the range of an expression's value.
+     *
+     * @param expr The expression.
+     * @param state The ranges before the expression is evaluated.
+     * @param tracked The variables whose ranges are tracked.
+     */
+    ValueRange exprRange(ThreeAddressExprP expr, const RangeState &state,
+                         const std::unordered_set<std::string> &tracked) const;
+
+    /**
+     * @brief Computes the range of a binary operator's result from the ranges of its operands.
+     */
+    static ValueRange binaryRange(ExprOperator op, const ValueRange &left, const ValueRange &right);
+
+    /**
+     * @brief Updates the ranges with the effect of a statement.
+     *
+     * @param stmt The statement.
+     * @param previous The statement before it in its block, or nullptr.
+     * @param state The ranges before the statement, updated to the ranges after it.
+     * @param tracked The variables whose ranges are tracked.
+     */
+    void transferRanges(ThreeAddressStmtP stmt, ThreeAddressStmtP previous, RangeState &state,
+                        const std::unordered_set<std::string> &tracked) const;
+
+    /**
+     * @brief Narrows the ranges by the condition a block's last statement jumps on.
+     *
+     * @param block The block.
+     * @param taken Whether the jump is taken.
+     * @param state The ranges at the end of the block, marked unreached when the condition can't hold.
+     * @param tracked The variables whose ranges are tracked.
+     */
+    void refineByCondition(const BasicBlock &block, bool taken, RangeState &state,
+                           const std::unordered_set<std::string> &tracked) const;
+
+    /**
+     * @brief Returns the range of a variable's values.
+     */
+    static ValueRange typeRange(VariableType type, bool isPtr);
+
+    /**
+     * @brief Marks the calls whose value the function returns right away as tail calls, which the Generator turns
+     * to a jump reusing the function's frame.
+     *
+     * The called function must be defined in the program and take parameters of the same total size, as it pops
+     * them for the caller. Functions with variables whose address is taken or with arrays are left as is, their
+     * frame may still be read by the called function.
+     *
+     * @param function The function to optimize.
+     * @return Whether any call was marked.
+     */
+    bool markTailCalls(ILFunction &function);
+
+    /**
+     * @brief Turns ifs in loops, with or without an else, whose arms only assign scalar variables and temporaries
+     * without calls or trapping expressions, to branchless code when it costs less than the branch. Both arms are
+     * evaluated into new temporaries and each assigned variable selects its value with a conditional move (or takes
+     * the comparison's value when the arms assign it 1 and 0).
+     *
+     * @param function The function to optimize.
+     * @return Whether any if was converted.
+     */
+    static bool convertIfs(ILFunction &function);
+
+    /**
+     * @brief Converts the ifs 'convertIfs' can convert whose converted code costs less than their branch, all
+     * found in one control flow graph. The ifs in their arms are left to the next graph.
+     *
+     * @return Whether an if was converted.
+     */
+    static bool convertIf(ILFunction &function);
+
+    /**
+     * @brief Checks if a select would carry its variable's value to the loop's next comparison: the if's
+     * condition block reads the variable before assigning it, and no block of the loop running before it every
+     * iteration assigns it.
+     *
+     * @param cfg The control flow graph of the function.
+     * @param loop The innermost loop containing the if.
+     * @param block The block ending with the if's conditional jump.
+     * @param name The name of the variable the select assigns.
+     * @return Whether the select is on a dependency chain between iterations.
+     */
+    static bool selectFeedsLoop(const ControlFlowGraph &cfg, const NaturalLoop &loop, const BasicBlock &block,
+                                const std::string &name);
+
+    /**
+     * @brief Creates the comparison holding when a block's conditional jump falls through, the comparison assigned
+     * to its condition right before it if there is one, or nullptr if the condition can't be compared by a
+     * select.
+     */
+    static BinaryExpr *fallThroughComparison(const BasicBlock &block);
+
+    /**
+     * @brief Checks if an arm of an if can be evaluated on both paths and adds its cost.
+     *
+     * @param arm The block of the arm, a leading label and a trailing goto are skipped.
+     * @param mergeLiveIn The temporaries live where the arms meet, the arm must not define them.
+     * @param cost Increased by the cost of the arm's assignments and of the loads they make.
+     * @param assigned The variables assigned by the arms, by name.
+     * @return Whether the arm can be speculated.
+     */
+    static bool canSpeculateArm(const BasicBlock &arm, const std::unordered_set<int> &mergeLiveIn, int &cost,
+                                std::map<std::string, Variable> &assigned);
+
+    /**
+     * @brief Copies an arm of an if into assignments of new temporaries, evaluated whichever arm is taken.
+     *
+     * @param function The function of the if, its new temporaries are allocated.
+     * @param arm The block of the arm, already checked by 'canSpeculateArm'.
+     * @param assigned The variables assigned by the arms, by name.
+     * @param speculated The list the copied statements are appended to.
+     * @param values Set to the value the arm leaves in each variable it assigns.
+     */
+    static void speculateArm(ILFunction &function, const BasicBlock &arm,
+                             const std::map<std::string, Variable> &assigned,
+                             std::list<ThreeAddressStmtP> &speculated, std::map<std::string, UniExprP> &values);
+
+    /**
+     * @brief Fuses comparisons only read by the conditional jump right after them into the jump, which the
+     * Generator turns to a compare and a conditional jump instead of materializing the comparison's value.
+     *
+     * A jump taken when the comparison is zero jumps on the inverted comparison.
+     *
+     * @param function The function to optimize.
+     * @return Whether any jump was fused.
+     */
+    static bool fuseCompareBranches(ILFunction &function);
+
+    /**
+     * @brief Checks if a call is in tail position, followed only by the return of its value, labels and scope exits
+     * up to the function's scope exit or a jump to the function's end.
+     *
+     * @param function The function making the call.
+     * @param call The call statement.
+     * @param endLabel The function's end label.
+     * @param setReturn Set to the statement returning the call's value, or the end of the statements.
+     * @param exitJump Set to the jump to the function's end, or the end of the statements.
+     * @return Whether the call is a tail call.
+     */
+    static bool findTailCall(ILFunction &function, ILStmtIterator call, const std::string &endLabel,
+                             ILStmtIterator &setReturn, ILStmtIterator &exitJump);
+
+    /**
+     * @brief Checks if a function takes the address of a variable or declares an array, so pointers into its frame
+     * may be passed on.
+     */
+    static bool hasFrameAddresses(const ILFunction &function);
+
+    /**
+     * @brief Returns the size in bytes of a function's return value, 0 for void functions.
+     */
+    static int returnValueSize(FunctionDeclarationStmtP declaration);
+
+    /**
+     * @brief Returns the number of statements of a function, excluding labels, scopes and the function's bounds.
+     */
+    static int inlineSize(const ILFunction &function);
+
+    /**
+     * @brief Checks if a function has the layout generated for it and never returns from inside a scope with
+     * variables, so its body can be copied with the returns jumping to the end of the copy.
+     */
+    static bool hasInlinableBody(const ILFunction &function);
+
+    /**
+     * @brief Finds the parameter pushes of a call.
+     *
+     * @param caller The function making the call.
+     * @param call The call statement.
+     * @param paramCount The number of parameters of the called function.
+     * @param pushes Filled with the pushes, the first parameter's first.
+     * @return Whether the call's pushes were found with no other call's pushes among them.
+     */
+    static bool collectCallArguments(ILFunction &caller, ILStmtIterator call, int paramCount,
+                                     std::vector<ILStmtIterator> &pushes);
+
+    /**
+     * @brief Replaces a call by a copy of the called function's body.
+     *
+     * @param caller The function making the call.
+     * @param call The call statement, deleted.
+     * @param pushes The parameter pushes of the call, the first parameter's first.
+     * @param callee The called function.
+     * @param suffix The suffix appended to the copied variables and labels.
+     * @param tempBase The number added to the copied temporaries.
+     */
+    static void inlineCall(ILFunction &caller, ILStmtIterator call, const std::vector<ILStmtIterator> &pushes,
+                           const ILFunction &callee, const std::string &suffix, int tempBase);
+
+    /**
+     * @brief Runs the optimization passes over a single function.
+     *
+     * @param function The function to optimize.
+     */
+    void optimizeFunction(ILFunction &function);
+
+    /**
+     * @brief Loop-invariant code motion.
+     *
+     * Moves temporary assignments whose value does not change between iterations, and that are safe to
+     * execute speculatively, from the loop to the loop preheader. Calls to pure functions with invariant arguments
+     * move with their pushes, and so do calls to read-only functions in loops that write no memory. Inner loops are
+     * handled first so computations can move out of several loops.
+     *
+     * @param function The function to optimize.
+     * @return Whether any statement was moved.
+     */
+    bool hoistLoopInvariants(ILFunction &function);
+
+    /**
+     * @brief Induction variable strength reduction for array indexing.
+     *
+     * For a variable 'i' that a loop only steps by constants, every access 'arr[i + c]' in the loop is
+     * rewritten to go through a register pointer variable that holds '&arr[i]', initialized in the preheader
+     * and stepped by the element size next to every step of 'i'. When 'i' is then only read by comparisons with
+     * loop-invariant bounds and is dead after the loop, the comparisons are made on the pointer instead
+     * and 'i' is no longer stepped.
+     *
+     * @param function The function to optimize.
+     * @return Whether any loop was rewritten.
+     */
+    bool reduceInductionVariables(ILFunction &function);
+
+    /**
+     * @brief Finds the steps of an induction variable in a loop.
+     *
+     * @param cfg The control flow graph of the function.
+     * @param loop The loop to scan.
+     * @param name The name of the variable.
+     * @param steps The vector the variable's steps are appended to.
+     * @return Whether every assignment to the variable inside the loop is a constant step.
+     */
+    static bool findInductionSteps(const ControlFlowGraph &cfg, const NaturalLoop &loop, const std::string &name,
+                                   std::vector<InductionStep> &steps);
+
+    /**
+     * @brief Matches an expression of the form 'name + c', 'c + name' or 'name - c'.
+     *
+     * @param expr The expression to match.
+     * @param name The name of the variable.
+     * @param constant Set to the signed constant added to the variable.
+     * @return Whether the expression matches.
+     */
+    static bool matchVariablePlusConstant(ThreeAddressExprP expr, const std::string &name, long long &constant);
+
+    /**
+     * @brief Checks if a temporary used as an index holds 'i + c' for the current value of an induction variable.
+     *
+     * The temporary is either assigned earlier in the same block, or assigned once in the loop in a block
+     * dominating the use with no step of 'i' in between.
+     *
+     * @param cfg The control flow graph of the function.
+     * @param loop The loop of the induction variable.
+     * @param useBlock The block of the statement using the temporary.
+     * @param use The statement using the temporary.
+     * @param temp The temporary.
+     * @param name The name of the induction variable.
+     * @param steps The steps of the induction variable in the loop.
+     * @param offset Set to the constant 'c'.
+     * @return Whether the temporary holds 'i + c'.
+     */
+    static bool matchIndexOffset(const ControlFlowGraph &cfg, const NaturalLoop &loop, int useBlock,
+                                 ILStmtIterator use, int temp, const std::string &name,
+                                 const std::vector<InductionStep> &steps, long long &offset);
+
+    /**
+     * @brief Returns the blocks of a loop reachable from a block without going back through the loop's header.
+     */
+    static std::set<int> forwardReachable(const ControlFlowGraph &cfg, const NaturalLoop &loop, int from);
+
+    /**
+     * @brief Creates the expression 'value + constant', or 'value - |constant|' for a negative constant.
+     */
+    static BinaryExpr *addConstant(UniExpr *value, long long constant);
+
+    /**
+     * @brief Checks if a variable may be read after leaving a loop before it is assigned again.
+     */
+    static bool isVariableLiveAfterLoop(const ControlFlowGraph &cfg, const NaturalLoop &loop,
+                                        const std::string &name);
+
+    /**
+     * @brief Removes assignments to temporaries that are never read afterwards.
+     *
+     * Assignments of function call results are kept for the call's side effects.
+     *
+     * @param function The function to clean up.
+     * @return Whether any assignment was removed.
+     */
+    static bool removeDeadTemps(ILFunction &function);
+
+    /**
+     * @brief Removes the statements of blocks that can't be reached from the function entry.
+     *
+     * Scope statements are kept unless the scope is entered and exited inside the same block, so the scopes
+     * stay balanced.
+     *
+     * @param function The function to clean up.
+     * @return Whether any statement was removed.
+     */
+    static bool removeUnreachableCode(ILFunction &function);
+
+    /**
+     * @brief Checks if a loop is laid out as a contiguous run of statements with balanced scopes.
+     *
+     * @param cfg The control flow graph of the function.
+     * @param loop The loop to check.
+     * @param begin Set to the first statement of the loop.
+     * @param last Set to the last statement of the loop.
+     * @return Whether the loop is contiguous.
+     */
+    static bool findLoopRange(const ControlFlowGraph &cfg, const NaturalLoop &loop, ILStmtIterator &begin,
+                              ILStmtIterator &last);
+
+    /**
+     * @brief Loop unswitching.
+     *
+     * A loop containing a conditional jump on a loop-invariant value is replaced by a test of the value
+     * before the loop and two copies of the loop, each with the jump resolved to one of its outcomes.
+     * Loops bigger than 'UNSWITCH_LOOP_LIMIT' are left as is and the copies added to a function stop once they
+     * reach 'UNSWITCH_GROWTH_BUDGET' statements, so unswitching on several conditions can't blow up the code.
+     *
+     * @param function The function to optimize.
+     * @return Whether any loop was unswitched.
+     */
+    static bool unswitchLoops(ILFunction &function);
+
+    /**
+     * @brief Loop idiom recognition.
+     *
+     * Counted while loops stepping by one whose whole body is a known idiom are replaced by a test of the loop's
+     * condition and code doing all the iterations at once:
+     * - Fills 'a[i] = v' and copies 'a[i] = b[i]' call the '_fill' and '_copyBytes' runtime routines ('rep stos'
+     *   and 'rep movsb').
+     * - Searches for the first maximum or minimum and its index call the '_maxIndex' and '_minIndex' routines.
+     * - Sums of a loop-invariant value 's = s + k' become 's = s + k * count', alone or next to a fill or a copy.
+     *
+     * The routines used are added to the program's builtin functions, so only they are generated.
+     *
+     * @param function The function to optimize.
+     * @return Whether any loop was replaced.
+     */
+    bool recognizeIdioms(ILFunction &function);
+
+    /**
+     * @brief Loop vectorization.
+     *
+     * Innermost counted loops stepping by one, whose iterations load and store consecutive elements of a single
+     * type and combine them with '+' and '-', fill arrays with invariant values or accumulate sums, minimums and
+     * maximums, get a vector loop running a whole register of iterations at once (16 bytes with SSE2, 32 with
+     * '-mavx2'). The original loop runs the remaining iterations, and also all of them when two of the pointers
+     * accessed are too close for the lanes to be independent.
+     *
+     * @param function The function to optimize.
+     * @return Whether any loop was vectorized.
+     */
+    bool vectorizeLoops(ILFunction &function);
+
+    /**
+     * @brief Builds the vector statements for the body of a counted loop.
+     *
+     * @param cfg The control flow graph of the function.
+     * @param loop The loop to vectorize.
+     * @param counted The loop's description.
+     * @param addressTaken The variables of the function whose address is taken.
+     * @param vectorized Filled with the vector statements, its width must be set.
+     * @return Whether every statement of the loop has a vector form.
+     */
+    static bool vectorizeBody(const ControlFlowGraph &cfg, const NaturalLoop &loop, const CountedLoop &counted,
+                              const std::unordered_set<std::string> &addressTaken, VectorizedLoop &vectorized);
+
+    /**
+     * @brief Loop unrolling.
+     *
+     * Innermost counted loops with a constant number of iterations that fits 'FULL_UNROLL_BUDGET' are replaced by
+     * copies of their body. Other counted loops comparing with '<', '<=', '>' or '>=' in the direction of their
+     * step get an unrolled copy running 'unrollFactor' iterations per test while they all fit the bound, followed
+     * by the original loop for the remaining iterations.
+     *
+     * @param function The function to optimize.
+     * @return Whether any loop was unrolled.
+     */
+    bool unrollLoops(ILFunction &function);
+
+    /**
+     * @brief Checks if a loop is a counted loop laid out as a contiguous run of statements after its preheader.
+     *
+     * @param cfg The control flow graph of the function, with temporary liveness computed.
+     * @param loop The loop to check.
+     * @param addressTaken The variables of the function whose address is taken.
+     * @param counted Filled with the loop's description.
+     * @return Whether the loop is a counted loop.
+     */
+    static bool findCountedLoop(const ControlFlowGraph &cfg, const NaturalLoop &loop,
+                                const std::unordered_set<std::string> &addressTaken, CountedLoop &counted);
+
+    /**
+     * @brief Checks if a loop is an innermost counted loop stepping its variable by one up to a bound it can't
+     * wrap around before reaching, entered straight from its preheader and with no temporary read after it.
+     *
+     * @param cfg The control flow graph of the function, with temporary liveness computed.
+     * @param loops The loops of the function.
+     * @param loop The loop to check.
+     * @param addressTaken The variables of the function whose address is taken.
+     * @param counted Filled with the loop's description.
+     * @param bound Set to the bound the variable is compared with.
+     * @return Whether the loop matches.
+     */
+    static bool findUnitStrideLoop(const ControlFlowGraph &cfg, const std::vector<NaturalLoop> &loops,
+                                   const NaturalLoop &loop, const std::unordered_set<std::string> &addressTaken,
+                                   CountedLoop &counted, UniExprP &bound);
+
+    /**
+     * @brief Finds the constant assigned to a variable on every path entering a loop.
+     *
+     * Only the chain of single predecessors ending at the preheader is searched.
+     *
+     * @return Whether a constant was found.
+     */
+    static bool findEntryConstant(const ControlFlowGraph &cfg, const NaturalLoop &loop, const std::string &name,
+                                  long long &value);
+
+    /**
+     * @brief Evaluates the comparison of a counted loop for a given value of its induction variable.
+     */
+    static bool evaluateCountedCondition(const CountedLoop &counted, long long value, long long bound);
+
+    /**
+     * @brief Copies the statements of one iteration of a loop without stepping the induction variable.
+     *
+     * The labels jumped to inside the iteration are renamed, others are dropped. Every read of the induction
+     * variable is replaced by the value it has at that point of the iteration.
+     *
+     * @param counted The loop to copy.
+     * @param suffix The suffix appended to the copied labels.
+     * @param inductionValue Creates the value of the induction variable, before or after its step.
+     * @return The copied statements, without the bottom test.
+     */
+    static std::list<ThreeAddressStmtP> copyIteration(const CountedLoop &counted, const std::string &suffix,
+                                                      const std::function<UniExpr *(bool afterStep)> &inductionValue);
+
+    /**
+     * @brief Collects what the statements in the loop write.
+     *
+     * @param cfg The control flow graph of the function.
+     * @param loop The loop to scan.
+     * @param addressTaken The variables of the function whose address is taken.
+     * @param nonWritingFunctions The functions known not to write memory, calls to them write nothing.
+     */
+    static LoopEffects collectLoopEffects(const ControlFlowGraph &cfg, const NaturalLoop &loop,
+                                          const std::unordered_set<std::string> &addressTaken,
+                                          const std::unordered_set<std::string> &nonWritingFunctions = {});
+
+    /**
+     * @brief Checks if an expression evaluates to the same value on every iteration of a loop.
+     */
+    static bool isLoopInvariant(ThreeAddressExprP expr, const LoopEffects &effects,
+                                const std::unordered_set<std::string> &addressTaken);
+
+    /**
+     * @brief Checks if an expression may trap (division by a non constant or a load through a pointer or
+     * an unknown index), so it can't be evaluated on a path that did not evaluate it before.
+     */
+    static bool mayTrap(ThreeAddressExprP expr);
+
+    /**
+     * @brief Returns the position in the preheader block where hoisted statements are inserted.
+     */
+    static ILStmtIterator preheaderInsertPoint(const BasicBlock &preheader);
+};
+
+#endif //COMPILER_ILOPTIMIZER_H
@@ -0,0 +1,418 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#include "ilOptimizer.h"
+
+bool ILOptimizer::fuseCompareBranches(ILFunction &function) {
+    ControlFlowGraph cfg(function.stmts);
+    bool fused = false;
+
+    cfg.computeTempLiveness();
+
+    for (const BasicBlock &block: cfg.blocks) {
+        if (block.begin == std::prev(block.end)) continue;
+
+        ILStmtIterator jump = std::prev(block.end);
+        ILStmtIterator compare = std::prev(jump);
+        auto gotoIfZeroStmt = dynamic_cast<GotoIfZeroStmtP>(*jump);
+        auto gotoIfNotZeroStmt = dynamic_cast<GotoIfNotZeroStmtP>(*jump);
+        auto tempAssignment = dynamic_cast<TempAssignmentTAStmtP>(*compare);
+
+        if ((!gotoIfZeroStmt && !gotoIfNotZeroStmt) || !tempAssignment) continue;
+
+        auto condition = dynamic_cast<UniTempP>(gotoIfZeroStmt ? gotoIfZeroStmt->expr : gotoIfNotZeroStmt->expr);
+        auto comparison = dynamic_cast<BinaryExprP>(tempAssignment->expr);
+
+        // The comparison's value must not be needed after the jump, on either path
+        if (!condition || condition->id != tempAssignment->id || !comparison ||
+            !invertedComparisons.contains(comparison->op) || cfg.tempLiveOut[block.id].contains(condition->id)) {
+            continue;
+        }
+
+        if (gotoIfZeroStmt) comparison->op = invertedComparisons.at(comparison->op);
+
+        tempAssignment->expr = nullptr;
+        delete tempAssignment;
+        function.stmts.erase(compare);
+
+        std::string label = ILAnalysis::jumpTarget(*jump);
+
+        delete *jump;
+        *jump = new GotoIfCompareStmt(label, comparison);
+        fused = true;
+    }
+
+    return fused;
+}
+
+bool ILOptimizer::convertIfs(ILFunction &function) {
+    bool converted = false;
+
+    // The blocks change with each conversion, an if becomes convertible once the ifs in its arms are converted
+    while (convertIf(function)) converted = true;
+
+    // The conditions read by the selects alone are left unread
+    if (converted) {
+        while (removeDeadTemps(function));
+    }
+
+    return converted;
+}
+
+bool ILOptimizer::convertIf(ILFunction &function) {
+    // An if the analysis chose, converted once the graph is no longer read
+    struct Conversion {
+        int block = -1;
+        const BasicBlock *elseArm = nullptr;
+        int merge = -1;
+        BinaryExprP comparison = nullptr;
+        std::map<std::string, Variable> assigned{};
+    };
+
+    ControlFlowGraph cfg(function.stmts);
+    std::vector<NaturalLoop> loops = cfg.findLoops();
+    std::vector<Conversion> conversions;
+
+    cfg.computeTempLiveness();
+
+    for (int id = 0; id + 2 < (int) cfg.blocks.size(); id++) {
+        const BasicBlock &block = cfg.blocks[id];
+        const NaturalLoop *loop = nullptr;
+
+        // A branch taken once costs little even when mispredicted, the innermost loop carries the selects
+        for (const NaturalLoop &candidate: loops) {
+            if (candidate.contains(id) && (!loop || candidate.blocks.size() < loop->blocks.size())) loop = &candidate;
+        }
+
+        if (!loop) continue;
+
+        const BasicBlock &thenArm = cfg.blocks[id + 1];
+        int target = cfg.blockByLabel(ILAnalysis::jumpTarget(block.lastStmt()));
+        const BasicBlock *elseArm = nullptr;
+        int merge = target;
+
+        if (target == -1 || thenArm.predecessors.size() != 1 || dynamic_cast<GotoStmtP>(block.lastStmt())) continue;
+
+        if (auto thenExit = dynamic_cast<GotoStmtP>(thenArm.lastStmt())) {
+            // The then arm jumps over the else arm, which only the condition jumps to
+            merge = cfg.blockByLabel(thenExit->labelName);
+            elseArm = &cfg.blocks[target];
+
+            if (target != id + 2 || merge != target + 1 || elseArm->predecessors.size() != 1 ||
+                ILAnalysis::isJump(elseArm->lastStmt())) {
+                continue;
+            }
+        } else if (target != id + 2 || ILAnalysis::isJump(thenArm.lastStmt())) {
+            continue;
+        }
+
+        const std::unordered_set<int> &mergeLiveIn = cfg.tempLiveIn[merge];
+        std::map<std::string, Variable> assigned;
+        int thenCost = 0, elseCost = 0;
+
+        if (!canSpeculateArm(thenArm, mergeLiveIn, thenCost, assigned) ||
+            (elseArm && !canSpeculateArm(*elseArm, mergeLiveIn, elseCost, assigned))) {
+            continue;
+        }
+
+        // The converted code runs both arms and the selects, the branch runs one arm, on average half of both,
+        // and may be mispredicted. A select whose variable the next iteration compares lengthens the loop's
+        // critical path, which a predicted branch leaves out
+        int convertedCost = thenCost + elseCost;
+
+        for (const auto &[name, var]: assigned) {
+            convertedCost += IF_CONVERSION_SELECT_COST;
+
+            if (selectFeedsLoop(cfg, *loop, block, name)) convertedCost += IF_CONVERSION_CHAIN_COST;
+        }
+
+        if (2 * convertedCost >= thenCost + elseCost + 2 * IF_CONVERSION_BRANCH_COST) continue;
+
+        BinaryExprP comparison = fallThroughComparison(block);
+
+        if (!comparison) continue;
+
+        conversions.push_back({id, elseArm, merge, comparison, std::move(assigned)});
+
+        // The ifs chosen don't overlap, the merge block may hold the next one's condition
+        id = merge - 1;
+    }
+
+    // Converting from the last if keeps the blocks of the earlier ones in place
+    for (auto conversion = conversions.rbegin(); conversion != conversions.rend(); ++conversion) {
+        const BasicBlock &block = cfg.blocks[conversion->block];
+        const BasicBlock &thenArm = cfg.blocks[conversion->block + 1];
+        const BasicBlock *elseArm = conversion->elseArm;
+        const std::map<std::string, Variable> &assigned = conversion->assigned;
+        BinaryExprP comparison = conversion->comparison;
+        std::list<ThreeAddressStmtP> converted;
+        std::map<std::string, UniExprP> thenValues, elseValues;
+
+        speculateArm(function, thenArm, assigned, converted, thenValues);
+
+        if (elseArm) speculateArm(function, *elseArm, assigned, converted, elseValues);
+
+        // The selects assign the variables one by one, a variable the comparison reads is assigned last, and
+        // when it reads two the comparison reads copies of them
+        std::vector<std::string> comparedVars;
+
+        for (UniExprP operand: {comparison->left, comparison->right}) {
+            auto var = dynamic_cast<VariableValP>(operand);
+
+            if (var && assigned.contains(var->var.name)) comparedVars.push_back(var->var.name);
+        }
+
+        if (comparedVars.size() == 2 && comparedVars[0] != comparedVars[1]) {
+            for (UniExpr **operand: {&comparison->left, &comparison->right}) {
+                int copy = function.newTemp();
+
+                converted.push_back(new TempAssignmentTAStmt(copy, *operand));
+                *operand = new UniTemp(copy);
+            }
+
+            comparedVars.clear();
+        }
+
+        std::vector<std::pair<std::string, Variable>> selectOrder;
+
+        for (const auto &[name, var]: assigned) {
+            bool compared = std::find(comparedVars.begin(), comparedVars.end(), name) != comparedVars.end();
+
+            if (compared) {
+                selectOrder.emplace_back(name, var);
+            } else {
+                selectOrder.emplace(selectOrder.begin(), name, var);
+            }
+        }
+
+        for (const auto &[name, var]: selectOrder) {
+            UniExprP trueValue = thenValues.contains(name) ? thenValues[name] : new VariableVal(var);
+            UniExprP falseValue = elseValues.contains(name) ? elseValues[name] : new VariableVal(var);
+            auto trueImInt = dynamic_cast<ImIntValP>(trueValue);
+            auto falseImInt = dynamic_cast<ImIntValP>(falseValue);
+            ThreeAddressExprP value;
+
+            // Assigning the truth of the comparison is a set instead of a move
+            if (trueImInt && falseImInt && trueImInt->value == "1" && falseImInt->value == "0") {
+                value = ILAnalysis::cloneExpr(comparison);
+            } else if (trueImInt && falseImInt && trueImInt->value == "0" && falseImInt->value == "1") {
+                auto inverted = dynamic_cast<BinaryExprP>(ILAnalysis::cloneExpr(comparison));
+
+                inverted->op = invertedComparisons.at(inverted->op);
+                value = inverted;
+            } else {
+                value = new SelectExpr(dynamic_cast<BinaryExprP>(ILAnalysis::cloneExpr(comparison)),
+                                       ILAnalysis::cloneUniExpr(trueValue), ILAnalysis::cloneUniExpr(falseValue));
+            }
+
+            delete trueValue;
+            delete falseValue;
+            converted.push_back(new VarAssignmentTAStmt(new VariableVal(var), value));
+        }
+
+        delete comparison;
+
+        // The jump and the arms are replaced, the label of the merge block stays
+        for (auto it = std::prev(block.end); it != cfg.blocks[conversion->merge].begin;) {
+            delete *it;
+            it = function.stmts.erase(it);
+        }
+
+        function.stmts.splice(cfg.blocks[conversion->merge].begin, converted);
+    }
+
+    return !conversions.empty();
+}
+
+bool ILOptimizer::selectFeedsLoop(const ControlFlowGraph &cfg, const NaturalLoop &loop, const BasicBlock &block,
+                                  const std::string &name) {
+    auto assigns = [&name](ThreeAddressStmtP stmt) {
+        VariableValP var = ILAnalysis::assignedVariable(stmt);
+
+        return var && var->var.name == name;
+    };
+
+    // The condition must read the variable before its block assigns it
+    bool read = false;
+
+    for (auto it = block.begin; it != block.end && !read; ++it) {
+        std::vector<VariableValP> scalarReads;
+        std::vector<SubscriptableVariableValP> elementReads;
+
+        ILAnalysis::collectStmtReads(*it, scalarReads, elementReads);
+        read = std::ranges::any_of(scalarReads, [&name](VariableValP var) { return var->var.name == name; });
+
+        if (!read && assigns(*it)) return false;
+    }
+
+    if (!read) return false;
+
+    // An assignment every iteration runs before the condition starts a new value
+    for (int other: loop.blocks) {
+        if (other == block.id || !cfg.dominates(other, block.id)) continue;
+
+        if (std::any_of(cfg.blocks[other].begin, cfg.blocks[other].end, assigns)) return false;
+    }
+
+    return true;
+}
+
+BinaryExpr *ILOptimizer::fallThroughComparison(const BasicBlock &block) {
+    ILStmtIterator jump = std::prev(block.end);
+    auto gotoIfZeroStmt = dynamic_cast<GotoIfZeroStmtP>(*jump);
+    auto gotoIfNotZeroStmt = dynamic_cast<GotoIfNotZeroStmtP>(*jump);
+
+    if (!gotoIfZeroStmt && !gotoIfNotZeroStmt) return nullptr;
+
+    UniExprP condition = gotoIfZeroStmt ? gotoIfZeroStmt->expr : gotoIfNotZeroStmt->expr;
+    auto conditionTemp = dynamic_cast<UniTempP>(condition);
+    // The selects move values and compare operands without a scratch register, so subscripts are left out
+    auto isOperand = [](UniExprP expr) {
+        return !dynamic_cast<SubscriptableVariableValP>(expr) &&
+               (dynamic_cast<ImIntValP>(expr) || dynamic_cast<UniTempP>(expr) || dynamic_cast<VariableValP>(expr));
+    };
+    BinaryExprP comparison = nullptr;
+
+    if (conditionTemp && jump != block.begin) {
+        auto tempAssignment = dynamic_cast<TempAssignmentTAStmtP>(*std::prev(jump));
+        auto binary = tempAssignment ? dynamic_cast<BinaryExprP>(tempAssignment->expr) : nullptr;
+
+        // The comparison must read the same values when the selects repeat it
+        if (binary && tempAssignment->id == conditionTemp->id && invertedComparisons.contains(binary->op) &&
+            isOperand(binary->left) && isOperand(binary->right) &&
+            std::ranges::none_of(ILAnalysis::usedTemps(tempAssignment), [&conditionTemp](UniTempP temp) {
+                return temp->id == conditionTemp->id;
+            })) {
+            comparison = dynamic_cast<BinaryExprP>(ILAnalysis::cloneExpr(binary));
+        }
+    }
+
+    if (!comparison) {
+        if (!isOperand(condition)) return nullptr;
+
+        comparison = new BinaryExpr(ILAnalysis::cloneUniExpr(condition), new ImIntVal("0"), ExprOperator::notEquals);
+    }
+
+    // Jumping when the condition is not zero falls through when it is
+    if (gotoIfNotZeroStmt) comparison->op = invertedComparisons.at(comparison->op);
+
+    return comparison;
+}
+
+bool ILOptimizer::canSpeculateArm(const BasicBlock &arm, const std::unordered_set<int> &mergeLiveIn, int &cost,
+                                  std::map<std::string, Variable> &assigned) {
+    std::unordered_set<std::string> armAssigned;
+    int depth = 0;
+
+    for (auto it = arm.begin; it != arm.end; ++it) {
+        ThreeAddressStmtP stmt = *it;
+
+        if ((dynamic_cast<LabelStmtP>(stmt) && it == arm.begin) ||
+            (dynamic_cast<GotoStmtP>(stmt) && std::next(it) == arm.end)) {
+            continue;
+        }
+
+        if (auto scopeEnter = dynamic_cast<ScopeEnterStmtP>(stmt)) {
+            // Variables of the arm's scope would need their own frame
+            if (!scopeEnter->vars.empty()) return false;
+
+            depth++;
+            continue;
+        } else if (dynamic_cast<ScopeExitStmtP>(stmt)) {
+            if (--depth < 0) return false;
+
+            continue;
+        }
+
+        auto tempAssignment = dynamic_cast<TempAssignmentTAStmtP>(stmt);
+        auto varAssignment = dynamic_cast<VarAssignmentTAStmtP>(stmt);
+        ThreeAddressExprP expr = tempAssignment ? tempAssignment->expr : varAssignment ? varAssignment->expr : nullptr;
+
+        if (!expr || ILAnalysis::getCall(stmt) || dynamic_cast<FunctionCallExprP>(expr) || mayTrap(expr) ||
+            (tempAssignment && mergeLiveIn.contains(tempAssignment->id)) ||
+            (varAssignment && dynamic_cast<SubscriptableVariableValP>(varAssignment->var))) {
+            return false;
+        }
+
+        // A variable read after the arm assigned it is read from the temporary holding its value, which isn't
+        // truncated to a narrower type
+        std::vector<VariableValP> scalarReads;
+        std::vector<SubscriptableVariableValP> elementReads;
+
+        ILAnalysis::collectStmtReads(stmt, scalarReads, elementReads);
+
+        for (auto read: scalarReads) {
+            if (armAssigned.contains(read->var.name) && !read->var.ptrType && typeSizes.at(read->var.type) < 8) {
+                return false;
+            }
+        }
+
+        if (varAssignment) {
+            armAssigned.insert(varAssignment->var->var.name);
+            assigned.emplace(varAssignment->var->var.name, varAssignment->var->var);
+        }
+
+        cost += IF_CONVERSION_STMT_COST + IF_CONVERSION_LOAD_COST * (int) (scalarReads.size() + elementReads.size());
+    }
+
+    return depth == 0;
+}
+
+void ILOptimizer::speculateArm(ILFunction &function, const BasicBlock &arm,
+                               const std::map<std::string, Variable> &assigned,
+                               std::list<ThreeAddressStmtP> &speculated, std::map<std::string, UniExprP> &values) {
+    std::unordered_map<int, int> temps;
+
+    for (auto it = arm.begin; it != arm.end; ++it) {
+        auto tempAssignment = dynamic_cast<TempAssignmentTAStmtP>(*it);
+        auto varAssignment = dynamic_cast<VarAssignmentTAStmtP>(*it);
+
+        if (!tempAssignment && !varAssignment) continue;
+
+        // The copy reads the arm's new temporaries and the values the arm gave its variables so far
+        ThreeAddressStmtP copy = ILAnalysis::cloneStmt(*it);
+
+        for (const auto &[oldId, newId]: temps) {
+            ILAnalysis::replaceTempReads(copy, oldId, [newId = newId]() { return new UniTemp(newId); });
+        }
+
+        for (const auto &[name, value]: values) {
+            ILAnalysis::replaceVariableReads(copy, name, [value = value]() {
+                return ILAnalysis::cloneUniExpr(value);
+            });
+        }
+
+        if (auto tempCopy = dynamic_cast<TempAssignmentTAStmtP>(copy)) {
+            tempCopy->id = temps[tempAssignment->id] = function.newTemp();
+            speculated.push_back(tempCopy);
+            continue;
+        }
+
+        auto varCopy = dynamic_cast<VarAssignmentTAStmtP>(copy);
+        const std::string &name = varAssignment->var->var.name;
+        UniExprP value;
+
+        auto varValue = dynamic_cast<VariableValP>(varCopy->expr);
+        bool unassignedVar = varValue && !dynamic_cast<SubscriptableVariableValP>(varValue) &&
+                             !assigned.contains(varValue->var.name);
+
+        // Constants, temporaries and variables no select assigns are selected as they are, other values are
+        // evaluated to a temporary first
+        if (dynamic_cast<ImIntValP>(varCopy->expr) || dynamic_cast<UniTempP>(varCopy->expr) || unassignedVar) {
+            value = ILAnalysis::cloneUniExpr(dynamic_cast<UniExprP>(varCopy->expr));
+        } else {
+            int valueTemp = function.newTemp();
+
+            speculated.push_back(new TempAssignmentTAStmt(valueTemp, varCopy->expr));
+            varCopy->expr = nullptr;
+            value = new UniTemp(valueTemp);
+        }
+
+        delete varCopy;
+
+        if (values.contains(name)) delete values[name];
+
+        values[name] = value;
+    }
+}
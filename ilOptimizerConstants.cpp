@@ -0,0 +1,150 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#include "ilOptimizer.h"
+
+bool ILOptimizer::foldConstants(ILFunction &function) {
+    ControlFlowGraph cfg(function.stmts);
+    bool folded = false;
+
+    for (const BasicBlock &block: cfg.blocks) {
+        // The temporaries known to hold a constant at the current statement of the block
+        std::unordered_map<int, long long> constants;
+
+        for (auto it = block.begin; it != block.end;) {
+            ThreeAddressStmtP stmt = *it;
+            std::unordered_set<int> knownReads;
+
+            for (auto temp: ILAnalysis::usedTemps(stmt)) {
+                if (constants.contains(temp->id)) knownReads.insert(temp->id);
+            }
+
+            for (int id: knownReads) {
+                long long value = constants[id];
+
+                ILAnalysis::replaceTempReads(stmt, id, [value]() { return new ImIntVal(std::to_string(value)); });
+                folded = true;
+            }
+
+            if (auto tempAssignment = dynamic_cast<TempAssignmentTAStmtP>(stmt)) {
+                folded |= foldExpr(tempAssignment->expr);
+            } else if (auto varAssignment = dynamic_cast<VarAssignmentTAStmtP>(stmt)) {
+                folded |= foldExpr(varAssignment->expr);
+
+                if (auto subVar = dynamic_cast<SubscriptableVariableValP>(varAssignment->var)) {
+                    folded |= foldUniExpr(subVar->index);
+                }
+            } else if (auto functionParamPush = dynamic_cast<FunctionParamPushStmtP>(stmt)) {
+                folded |= foldExpr(functionParamPush->expr);
+            } else if (auto setReturnValue = dynamic_cast<SetReturnValueStmtP>(stmt)) {
+                folded |= foldExpr(setReturnValue->expr);
+            } else if (auto gotoIfZeroStmt = dynamic_cast<GotoIfZeroStmtP>(stmt)) {
+                folded |= foldUniExpr(gotoIfZeroStmt->expr);
+            } else if (auto gotoIfNotZeroStmt = dynamic_cast<GotoIfNotZeroStmtP>(stmt)) {
+                folded |= foldUniExpr(gotoIfNotZeroStmt->expr);
+            }
+
+            int defined = ILAnalysis::definedTemp(stmt);
+
+            if (defined != -1) {
+                auto tempAssignment = dynamic_cast<TempAssignmentTAStmtP>(stmt);
+                auto imInt = tempAssignment ? dynamic_cast<ImIntValP>(tempAssignment->expr) : nullptr;
+
+                if (imInt) {
+                    constants[defined] = std::stoll(imInt->value);
+                } else {
+                    constants.erase(defined);
+                }
+            }
+
+            // A conditional jump on a constant is either always taken or never
+            auto ifZero = dynamic_cast<GotoIfZeroStmtP>(stmt);
+            auto ifNotZero = dynamic_cast<GotoIfNotZeroStmtP>(stmt);
+            auto condition = dynamic_cast<ImIntValP>(ifZero ? ifZero->expr : ifNotZero ? ifNotZero->expr : nullptr);
+
+            if (condition) {
+                bool taken = (std::stoll(condition->value) == 0) == (ifZero != nullptr);
+
+                if (taken) {
+                    *it = new GotoStmt(ILAnalysis::jumpTarget(stmt));
+                    ++it;
+                } else {
+                    it = function.stmts.erase(it);
+                }
+
+                delete stmt;
+                folded = true;
+                continue;
+            }
+
+            ++it;
+        }
+    }
+
+    return folded;
+}
+
+bool ILOptimizer::foldExpr(ThreeAddressExpr *&expr) {
+    if (auto binary = dynamic_cast<BinaryExprP>(expr)) {
+        bool folded = foldUniExpr(binary->left);
+        folded |= foldUniExpr(binary->right);
+
+        auto left = dynamic_cast<ImIntValP>(binary->left);
+        auto right = dynamic_cast<ImIntValP>(binary->right);
+        long long result;
+
+        if (left && right &&
+            ILAnalysis::evaluateOperator(binary->op, std::stoll(left->value), std::stoll(right->value), result)) {
+            delete expr;
+            expr = new ImIntVal(std::to_string(result));
+            return true;
+        }
+
+        return folded;
+    } else if (auto uni = dynamic_cast<UniExprP>(expr)) {
+        UniExpr *folded = uni;
+        bool changed = foldUniExpr(folded);
+
+        expr = folded;
+        return changed;
+    } else if (auto addrVar = dynamic_cast<AddrVarExprP>(expr)) {
+        if (auto subVar = dynamic_cast<SubscriptableVariableValP>(addrVar->addressable)) {
+            return foldUniExpr(subVar->index);
+        }
+    }
+
+    return false;
+}
+
+bool ILOptimizer::foldUniExpr(UniExpr *&expr) {
+    if (auto subVar = dynamic_cast<SubscriptableVariableValP>(expr)) {
+        return foldUniExpr(subVar->index);
+    } else if (auto logicalNot = dynamic_cast<LogicalNotExprP>(expr)) {
+        bool folded = foldUniExpr(logicalNot->expr);
+
+        if (auto imInt = dynamic_cast<ImIntValP>(logicalNot->expr)) {
+            long long value = std::stoll(imInt->value) == 0;
+
+            delete expr;
+            expr = new ImIntVal(std::to_string(value));
+            return true;
+        }
+
+        return folded;
+    } else if (auto numericNeg = dynamic_cast<NumericNegExprP>(expr)) {
+        bool folded = foldUniExpr(numericNeg->expr);
+
+        if (auto imInt = dynamic_cast<ImIntValP>(numericNeg->expr)) {
+            auto value = (long long) (0ULL - (unsigned long long) std::stoll(imInt->value));
+
+            delete expr;
+            expr = new ImIntVal(std::to_string(value));
+            return true;
+        }
+
+        return folded;
+    }
+
+    return false;
+}
@@ -0,0 +1,243 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#include "ilOptimizer.h"
+
+void ILOptimizer::evaluateConstantCalls(std::vector<ILFunction> &functions) {
+    std::unordered_map<std::string, ILFunction *> functionsByName;
+    std::unordered_map<std::string, std::unordered_map<std::string, ILStmtIterator>> labels;
+
+    for (auto &function: functions) {
+        functionsByName[function.declaration->name] = &function;
+
+        for (auto it = function.stmts.begin(); it != function.stmts.end(); ++it) {
+            if (auto labelStmt = dynamic_cast<LabelStmtP>(*it)) {
+                labels[function.declaration->name][labelStmt->labelName] = it;
+            }
+        }
+    }
+
+    for (auto &function: functions) {
+        bool evaluated = false;
+
+        for (auto it = function.stmts.begin(); it != function.stmts.end(); ++it) {
+            FunctionCallExprP call = ILAnalysis::getCall(*it);
+            auto tempAssignment = dynamic_cast<TempAssignmentTAStmtP>(*it);
+
+            if (!call || !tempAssignment || call->retPtr || callPurity(call) != FunctionPurity::pure) continue;
+
+            ILFunction *callee = functionsByName[call->functionName];
+            std::vector<ILStmtIterator> pushes;
+            std::vector<long long> args;
+
+            if (!collectCallArguments(function, it, (int) callee->declaration->params.size(), pushes)) continue;
+
+            for (auto push: pushes) {
+                auto imInt = dynamic_cast<ImIntValP>(dynamic_cast<FunctionParamPushStmtP>(*push)->expr);
+
+                if (!imInt) break;
+
+                args.push_back(std::stoll(imInt->value));
+            }
+
+            int steps = 0;
+            long long result;
+
+            if (args.size() != pushes.size() ||
+                !evaluateFunction(functionsByName, labels, *callee, args, 0, steps, result)) {
+                continue;
+            }
+
+            for (auto push: pushes) {
+                delete *push;
+                function.stmts.erase(push);
+            }
+
+            delete tempAssignment->expr;
+            tempAssignment->expr = new ImIntVal(std::to_string(truncateToType(result, call->retType)));
+            evaluated = true;
+        }
+
+        if (evaluated && foldConstants(function)) {
+            while (removeUnreachableCode(function));
+            while (removeDeadTemps(function));
+        }
+    }
+}
+
+bool ILOptimizer::evaluateFunction(
+        const std::unordered_map<std::string, ILFunction *> &functionsByName,
+        const std::unordered_map<std::string, std::unordered_map<std::string, ILStmtIterator>> &labels,
+        ILFunction &function, const std::vector<long long> &args, int depth, int &steps, long long &result) const {
+    if (depth > EVAL_DEPTH_LIMIT) return false;
+
+    const std::vector<Variable> &params = function.declaration->params;
+    std::unordered_map<int, long long> temps;
+    // The variables of the scopes entered, the parameters' scope first
+    std::vector<std::unordered_map<std::string, EvaluatedVariable>> scopes(1);
+    // The values pushed for the calls made by the function, the last parameter's first
+    std::vector<long long> pushed;
+    std::optional<long long> returnValue;
+
+    for (size_t i = 0; i < params.size(); ++i) {
+        if (params[i].ptrType) return false;
+
+        EvaluatedVariable param(params[i]);
+        param.values[0] = truncateToType(args[i], params[i].type);
+        scopes[0].emplace(params[i].name, param);
+    }
+
+    auto findVariable = [&scopes](const std::string &name) -> EvaluatedVariable * {
+        for (auto scope = scopes.rbegin(); scope != scopes.rend(); ++scope) {
+            auto var = scope->find(name);
+
+            if (var != scope->end()) return &var->second;
+        }
+
+        return nullptr;
+    };
+
+    std::function<bool(ThreeAddressExprP, long long &)> evaluate;
+
+    // Finds the element a variable or a subscript of a local array refers to
+    auto findElement = [&](VariableValP varVal, std::optional<long long> *&element) {
+        EvaluatedVariable *var = findVariable(varVal->var.name);
+
+        if (!var || var->var.ptrType) return false;
+
+        long long index = 0;
+
+        if (auto subVar = dynamic_cast<SubscriptableVariableValP>(varVal)) {
+            if (!evaluate(subVar->index, index)) return false;
+        } else if (var->var.arrSize > 0) {
+            return false;
+        }
+
+        if (index < 0 || index >= (long long) var->values.size()) return false;
+
+        element = &var->values[index];
+        return true;
+    };
+
+    evaluate = [&](ThreeAddressExprP expr, long long &value) {
+        if (auto imInt = dynamic_cast<ImIntValP>(expr)) {
+            value = std::stoll(imInt->value);
+            return true;
+        } else if (auto temp = dynamic_cast<UniTempP>(expr)) {
+            if (!temps.contains(temp->id)) return false;
+
+            value = temps[temp->id];
+            return true;
+        } else if (auto varVal = dynamic_cast<VariableValP>(expr)) {
+            std::optional<long long> *element;
+
+            if (!findElement(varVal, element) || !element->has_value()) return false;
+
+            value = element->value();
+            return true;
+        } else if (auto logicalNot = dynamic_cast<LogicalNotExprP>(expr)) {
+            if (!evaluate(logicalNot->expr, value)) return false;
+
+            value = value == 0;
+            return true;
+        } else if (auto numericNeg = dynamic_cast<NumericNegExprP>(expr)) {
+            if (!evaluate(numericNeg->expr, value)) return false;
+
+            value = (long long) (0ULL - (unsigned long long) value);
+            return true;
+        } else if (auto binary = dynamic_cast<BinaryExprP>(expr)) {
+            long long left, right;
+
+            return evaluate(binary->left, left) && evaluate(binary->right, right) &&
+                   ILAnalysis::evaluateOperator(binary->op, left, right, value);
+        }
+
+        // Addresses can't be known at compile time
+        return false;
+    };
+
+    const auto &functionLabels = labels.at(function.declaration->name);
+
+    for (auto it = std::next(function.stmts.begin()); it != function.stmts.end();) {
+        ThreeAddressStmtP stmt = *it++;
+
+        if (++steps > EVAL_STEP_LIMIT) return false;
+
+        if (auto scopeEnter = dynamic_cast<ScopeEnterStmtP>(stmt)) {
+            scopes.emplace_back();
+
+            for (const auto &var: scopeEnter->vars) {
+                scopes.back().emplace(var.name, EvaluatedVariable(var));
+            }
+        } else if (dynamic_cast<ScopeExitStmtP>(stmt)) {
+            if (scopes.size() > 1) scopes.pop_back();
+        } else if (auto functionParamPush = dynamic_cast<FunctionParamPushStmtP>(stmt)) {
+            long long value;
+
+            if (functionParamPush->isPtr || !evaluate(functionParamPush->expr, value)) return false;
+
+            pushed.push_back(truncateToType(value, functionParamPush->varType));
+        } else if (auto call = ILAnalysis::getCall(stmt)) {
+            if (callPurity(call) != FunctionPurity::pure || call->retPtr) return false;
+
+            ILFunction *callee = functionsByName.at(call->functionName);
+            size_t paramCount = callee->declaration->params.size();
+
+            if (pushed.size() < paramCount) return false;
+
+            // The pushes closest to the call are the first parameters
+            std::vector<long long> callArgs(pushed.rbegin(), pushed.rbegin() + (long) paramCount);
+            long long value;
+
+            pushed.resize(pushed.size() - paramCount);
+
+            if (!evaluateFunction(functionsByName, labels, *callee, callArgs, depth + 1, steps, value)) return false;
+
+            if (auto tempAssignment = dynamic_cast<TempAssignmentTAStmtP>(stmt)) {
+                temps[tempAssignment->id] = truncateToType(value, call->retType);
+            }
+        } else if (auto tempAssignment = dynamic_cast<TempAssignmentTAStmtP>(stmt)) {
+            if (!evaluate(tempAssignment->expr, temps[tempAssignment->id])) return false;
+        } else if (auto varAssignment = dynamic_cast<VarAssignmentTAStmtP>(stmt)) {
+            std::optional<long long> *element;
+            long long value;
+
+            if (!evaluate(varAssignment->expr, value) || !findElement(varAssignment->var, element)) return false;
+
+            *element = truncateToType(value, varAssignment->var->var.type);
+        } else if (auto setReturnValue = dynamic_cast<SetReturnValueStmtP>(stmt)) {
+            long long value;
+
+            if (!evaluate(setReturnValue->expr, value)) return false;
+
+            returnValue = value;
+        } else if (ILAnalysis::isJump(stmt)) {
+            bool taken = true;
+            auto gotoIfZeroStmt = dynamic_cast<GotoIfZeroStmtP>(stmt);
+            auto gotoIfNotZeroStmt = dynamic_cast<GotoIfNotZeroStmtP>(stmt);
+
+            if (gotoIfZeroStmt || gotoIfNotZeroStmt) {
+                long long condition;
+
+                if (!evaluate(gotoIfZeroStmt ? gotoIfZeroStmt->expr : gotoIfNotZeroStmt->expr, condition)) {
+                    return false;
+                }
+
+                taken = (condition == 0) == (gotoIfZeroStmt != nullptr);
+            }
+
+            if (taken) it = std::next(functionLabels.at(ILAnalysis::jumpTarget(stmt)));
+        } else if (dynamic_cast<FunctionExitStmtP>(stmt)) {
+            if (!returnValue) return false;
+
+            result = *returnValue;
+            return true;
+        } else if (!dynamic_cast<LabelStmtP>(stmt)) {
+            // Vector statements only appear after the functions are optimized
+            return false;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,383 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#include "ilOptimizer.h"
+
+bool ILOptimizer::recognizeIdioms(ILFunction &function) {
+    bool replacedAny = false;
+    // Headers of the loops already considered, by their label
+    std::unordered_set<std::string> visited;
+
+    for (bool changed = true; changed;) {
+        changed = false;
+
+        ControlFlowGraph cfg(function.stmts);
+        std::vector<NaturalLoop> loops = cfg.findLoops();
+
+        cfg.computeTempLiveness();
+
+        std::unordered_set<std::string> addressTaken = ILAnalysis::addressTakenVariables(function.stmts);
+
+        for (const auto &loop: loops) {
+            auto headerLabel = dynamic_cast<LabelStmtP>(*cfg.blocks[loop.header].begin);
+
+            if (!headerLabel || !visited.insert(headerLabel->labelName).second) continue;
+
+            CountedLoop counted;
+            UniExprP bound;
+
+            // The replacement tests the condition once, as a while loop does before its first iteration
+            if (!findUnitStrideLoop(cfg, loops, loop, addressTaken, counted, bound) || !counted.topTest) continue;
+
+            LoopEffects effects = collectLoopEffects(cfg, loop, addressTaken);
+            const std::string &inductionName = counted.inductionVar.name;
+
+            // The statements of one iteration without the step of the induction variable, empty scopes and
+            // the loop's own labels
+            std::unordered_set<ThreeAddressStmtP> skipped = {*counted.stepAssignment};
+            std::vector<ThreeAddressStmtP> iteration;
+            bool declares = false;
+
+            if (dynamic_cast<UniTempP>(dynamic_cast<VarAssignmentTAStmtP>(*counted.stepAssignment)->expr)) {
+                skipped.insert(*std::prev(counted.stepAssignment));
+            }
+
+            for (auto it = std::next(counted.begin); it != std::prev(counted.testJump); ++it) {
+                auto scopeEnter = dynamic_cast<ScopeEnterStmtP>(*it);
+                auto label = dynamic_cast<LabelStmtP>(*it);
+
+                if (scopeEnter && !scopeEnter->vars.empty()) declares = true;
+
+                if (!skipped.contains(*it) && !scopeEnter && !dynamic_cast<ScopeExitStmtP>(*it) &&
+                    !(label && label->labelName == counted.conditionLabel)) {
+                    iteration.push_back(*it);
+                }
+            }
+
+            if (declares) continue;
+
+            // An element indexed by the induction variable, of a variable that stays the same in the whole loop
+            auto consecutiveElement = [&](ThreeAddressExprP expr) -> SubscriptableVariableValP {
+                auto subVar = dynamic_cast<SubscriptableVariableValP>(expr);
+                auto indexVar = subVar ? dynamic_cast<VariableValP>(subVar->index) : nullptr;
+
+                if (!indexVar || dynamic_cast<SubscriptableVariableValP>(indexVar) ||
+                    indexVar->var.name != inductionName || subVar->var.name.starts_with(GENERATED_VAR_PREFIX) ||
+                    effects.assignedVars.contains(subVar->var.name) ||
+                    (subVar->var.ptrType && addressTaken.contains(subVar->var.name))) {
+                    return nullptr;
+                }
+
+                return subVar;
+            };
+
+            // A scalar variable only the matched statements read and write
+            auto scalarVariable = [&](ThreeAddressExprP expr) -> VariableValP {
+                auto var = dynamic_cast<VariableValP>(expr);
+
+                if (!var || dynamic_cast<SubscriptableVariableValP>(var) || var->var.ptrType ||
+                    var->var.arrSize > 0 || var->var.name == inductionName ||
+                    var->var.name.starts_with(GENERATED_VAR_PREFIX) || addressTaken.contains(var->var.name)) {
+                    return nullptr;
+                }
+
+                return var;
+            };
+
+            // Sums of a loop-invariant value, 'temp := s + k', 'temp := k + s' or 'temp := s - k' directly
+            // followed by 's = temp'
+            std::vector<std::tuple<VariableValP, ExprOperator, UniExprP>> accumulations;
+            std::vector<ThreeAddressStmtP> rest;
+
+            for (size_t i = 0; i < iteration.size(); ++i) {
+                auto tempAssignment = dynamic_cast<TempAssignmentTAStmtP>(iteration[i]);
+                auto binary = tempAssignment ? dynamic_cast<BinaryExprP>(tempAssignment->expr) : nullptr;
+                auto assignment = i + 1 < iteration.size() ? dynamic_cast<VarAssignmentTAStmtP>(iteration[i + 1])
+                                                           : nullptr;
+                auto assignedTemp = assignment ? dynamic_cast<UniTempP>(assignment->expr) : nullptr;
+                VariableValP accumulated = assignedTemp ? scalarVariable(assignment->var) : nullptr;
+
+                if (binary && accumulated && assignedTemp->id == tempAssignment->id &&
+                    (binary->op == ExprOperator::add || binary->op == ExprOperator::sub)) {
+                    auto left = dynamic_cast<VariableValP>(binary->left);
+                    auto right = dynamic_cast<VariableValP>(binary->right);
+                    bool onLeft = left && !dynamic_cast<SubscriptableVariableValP>(left) &&
+                                  left->var.name == accumulated->var.name;
+                    bool onRight = right && !dynamic_cast<SubscriptableVariableValP>(right) &&
+                                   right->var.name == accumulated->var.name && binary->op == ExprOperator::add;
+                    UniExprP added = onLeft ? binary->right : binary->left;
+
+                    if ((onLeft || onRight) && !dynamic_cast<SubscriptableVariableValP>(added) &&
+                        isLoopInvariant(added, effects, addressTaken)) {
+                        accumulations.emplace_back(accumulated, binary->op, added);
+                        ++i;
+                        continue;
+                    }
+                }
+
+                rest.push_back(iteration[i]);
+            }
+
+            // An accumulated variable is assigned once per iteration
+            std::unordered_set<std::string> accumulatedNames;
+            bool repeated = false;
+
+            for (const auto &accumulation: accumulations) {
+                repeated |= !accumulatedNames.insert(std::get<0>(accumulation)->var.name).second;
+            }
+
+            if (repeated) continue;
+
+            std::string firstLabel = dynamic_cast<LabelStmtP>(*counted.begin)->labelName;
+            std::string exitLabel = firstLabel + ".idiom";
+            std::list<ThreeAddressStmtP> replacement;
+            bool inclusive = counted.comparison->op == ExprOperator::lessThanEquals ||
+                             counted.comparison->op == ExprOperator::biggerThanEquals;
+            int count = -1;
+
+            // The number of iterations, the loop runs at least one
+            auto appendCount = [&]() {
+                count = function.newTemp();
+
+                replacement.push_back(new TempAssignmentTAStmt(count, new BinaryExpr(
+                        ILAnalysis::cloneUniExpr(bound), new VariableVal(counted.inductionVar), ExprOperator::sub)));
+
+                if (inclusive) {
+                    replacement.push_back(new TempAssignmentTAStmt(count, addConstant(new UniTemp(count), 1)));
+                }
+            };
+
+            // Pushes the parameters of a runtime routine, the last one first
+            auto callRoutine = [&](const std::string &name, VariableType retType,
+                                   const std::vector<FunctionParamPushStmtP> &params, int result) {
+                for (auto param = params.rbegin(); param != params.rend(); ++param) {
+                    replacement.push_back(*param);
+                }
+
+                auto call = new FunctionCallExpr(name, retType, false, (int) params.size());
+
+                if (result == -1) {
+                    replacement.push_back(call);
+                } else {
+                    replacement.push_back(new TempAssignmentTAStmt(result, call));
+                }
+
+                this->ilProgram->builtinFunctionsUsed.insert(name);
+            };
+
+            auto firstElement = [&](const Variable &var) {
+                return new AddrVarExpr(new SubscriptableVariableVal(var, new VariableVal(counted.inductionVar)));
+            };
+
+            // Fills, copies and searches pay for a call, a short loop is better off unrolled
+            long long start;
+            auto boundImInt = dynamic_cast<ImIntValP>(bound);
+            bool shortLoop = boundImInt && findEntryConstant(cfg, loop, inductionName, start) &&
+                             std::stoll(boundImInt->value) - start + inclusive < IDIOM_MIN_ITERATIONS;
+
+            SubscriptableVariableValP target = nullptr;
+            std::string noneLabel;
+
+            if (rest.empty() && accumulations.empty()) continue;
+
+            if (!rest.empty() && shortLoop) continue;
+
+            if (rest.size() == 1 || rest.size() == 2) {
+                // A fill 'a[i] = v' or a copy 'a[i] = b[i]', possibly loaded to a temporary first
+                auto assignment = dynamic_cast<VarAssignmentTAStmtP>(rest.back());
+                auto load = rest.size() == 2 ? dynamic_cast<TempAssignmentTAStmtP>(rest.front()) : nullptr;
+                auto loadedTemp = assignment ? dynamic_cast<UniTempP>(assignment->expr) : nullptr;
+                SubscriptableVariableValP source = load && loadedTemp && loadedTemp->id == load->id
+                                                   ? consecutiveElement(load->expr)
+                                                   : nullptr;
+
+                target = assignment ? consecutiveElement(assignment->var) : nullptr;
+
+                if (!source && rest.size() == 1 && assignment) source = consecutiveElement(assignment->expr);
+
+                auto value = assignment ? dynamic_cast<UniExprP>(assignment->expr) : nullptr;
+
+                if (target && source && source->var.type == target->var.type &&
+                    source->var.name != target->var.name) {
+                    int bytes = typeSizes.at(target->var.type);
+
+                    appendCount();
+
+                    int size = count;
+
+                    if (bytes > 1) {
+                        size = function.newTemp();
+                        replacement.push_back(new TempAssignmentTAStmt(size, new BinaryExpr(
+                                new UniTemp(count), new ImIntVal(std::to_string(bytes)), ExprOperator::mult)));
+                    }
+                    callRoutine("_copyBytes", VariableType::voidType,
+                                {new FunctionParamPushStmt(target->var.type, true, firstElement(target->var)),
+                                 new FunctionParamPushStmt(source->var.type, true, firstElement(source->var)),
+                                 new FunctionParamPushStmt(VariableType::longType, false, new UniTemp(size))}, -1);
+                } else if (target && rest.size() == 1 && value && !dynamic_cast<SubscriptableVariableValP>(value) &&
+                           isLoopInvariant(value, effects, addressTaken)) {
+                    std::string routine = target->var.type == VariableType::charType ? "_fillChar"
+                                        : target->var.type == VariableType::intType ? "_fillInt" : "_fillLong";
+
+                    appendCount();
+
+                    callRoutine(routine, VariableType::voidType,
+                                {new FunctionParamPushStmt(target->var.type, true, firstElement(target->var)),
+                                 new FunctionParamPushStmt(VariableType::longType, false, new UniTemp(count)),
+                                 new FunctionParamPushStmt(target->var.type, false,
+                                                           ILAnalysis::cloneUniExpr(value))}, -1);
+                } else {
+                    continue;
+                }
+            } else if (!rest.empty()) {
+                // A search for the first maximum or minimum and its index:
+                // 'temp := a[i]', 'temp2 := temp > m', 'GotoIfZero temp2 end', ['temp3 := a[i]'], 'm = temp3',
+                // 'idx = i' (in any order), 'end:'
+                size_t pos = 0;
+
+                while (pos < rest.size() && dynamic_cast<LabelStmtP>(rest[pos])) pos++;
+
+                auto load = pos + 2 < rest.size() ? dynamic_cast<TempAssignmentTAStmtP>(rest[pos]) : nullptr;
+                auto compare = load ? dynamic_cast<TempAssignmentTAStmtP>(rest[pos + 1]) : nullptr;
+                auto skipJump = compare ? dynamic_cast<GotoIfZeroStmtP>(rest[pos + 2]) : nullptr;
+                auto binary = compare ? dynamic_cast<BinaryExprP>(compare->expr) : nullptr;
+                auto testedTemp = skipJump ? dynamic_cast<UniTempP>(skipJump->expr) : nullptr;
+                SubscriptableVariableValP searched = load ? consecutiveElement(load->expr) : nullptr;
+
+                if (!searched || !binary || !testedTemp || testedTemp->id != compare->id ||
+                    (binary->op != ExprOperator::biggerThan && binary->op != ExprOperator::lessThan) ||
+                    !accumulations.empty()) {
+                    continue;
+                }
+
+                auto leftTemp = dynamic_cast<UniTempP>(binary->left);
+                auto rightTemp = dynamic_cast<UniTempP>(binary->right);
+                bool elementOnLeft = leftTemp && leftTemp->id == load->id;
+                VariableValP extreme = scalarVariable(elementOnLeft ? binary->right : binary->left);
+
+                if (!(elementOnLeft || (rightTemp && rightTemp->id == load->id)) || !extreme) continue;
+
+                // Temporaries holding the element, the loaded one is reused unless the comparison overwrote it
+                std::unordered_set<int> elementTemps;
+                VariableValP index = nullptr;
+                bool assigned = false, matched = true;
+
+                if (compare->id != load->id) elementTemps.insert(load->id);
+
+                for (pos += 3; pos < rest.size(); ++pos) {
+                    auto label = dynamic_cast<LabelStmtP>(rest[pos]);
+
+                    if (label && label->labelName == skipJump->labelName) break;
+
+                    auto innerTemp = dynamic_cast<TempAssignmentTAStmtP>(rest[pos]);
+                    auto innerAssignment = dynamic_cast<VarAssignmentTAStmtP>(rest[pos]);
+                    auto assignedVar = innerAssignment ? scalarVariable(innerAssignment->var) : nullptr;
+                    auto assignedTemp = innerAssignment ? dynamic_cast<UniTempP>(innerAssignment->expr) : nullptr;
+                    auto assignedValue = innerAssignment ? dynamic_cast<VariableValP>(innerAssignment->expr)
+                                                         : nullptr;
+
+                    if (innerTemp && consecutiveElement(innerTemp->expr) &&
+                        dynamic_cast<SubscriptableVariableValP>(innerTemp->expr)->var.name == searched->var.name) {
+                        elementTemps.insert(innerTemp->id);
+                    } else if (assignedVar && assignedTemp && !assigned &&
+                               assignedVar->var.name == extreme->var.name && elementTemps.contains(assignedTemp->id)) {
+                        assigned = true;
+                    } else if (assignedVar && assignedValue && !index && !dynamic_cast<SubscriptableVariableValP>(
+                            assignedValue) && assignedValue->var.name == inductionName &&
+                               assignedVar->var.name != extreme->var.name) {
+                        index = assignedVar;
+                    } else {
+                        matched = false;
+                        break;
+                    }
+                }
+
+                // The compared value is sign extended, so the variable must hold every value of the elements
+                if (!matched || pos + 1 != rest.size() || !assigned || !index ||
+                    typeSizes.at(extreme->var.type) < typeSizes.at(searched->var.type)) {
+                    continue;
+                }
+
+                bool maximum = (binary->op == ExprOperator::biggerThan) == elementOnLeft;
+                std::string routine = std::string(maximum ? "_maxIndex" : "_minIndex") +
+                                      (searched->var.type == VariableType::charType ? "Char"
+                                     : searched->var.type == VariableType::intType ? "Int" : "Long");
+                int found = function.newTemp();
+                int none = function.newTemp();
+                int foundIndex = function.newTemp();
+                int element = function.newTemp();
+
+                noneLabel = exitLabel + ".none";
+                target = searched;
+
+                appendCount();
+                callRoutine(routine, VariableType::longType,
+                            {new FunctionParamPushStmt(searched->var.type, true, firstElement(searched->var)),
+                             new FunctionParamPushStmt(VariableType::longType, false, new UniTemp(count)),
+                             new FunctionParamPushStmt(VariableType::longType, false,
+                                                       new VariableVal(extreme->var))}, found);
+
+                // The routine returns the offset of the new extreme, or -1 if no element beat the current one
+                replacement.push_back(new TempAssignmentTAStmt(none, new BinaryExpr(
+                        new UniTemp(found), new ImIntVal("0"), ExprOperator::lessThan)));
+                replacement.push_back(new GotoIfNotZeroStmt(noneLabel, new UniTemp(none)));
+                replacement.push_back(new TempAssignmentTAStmt(foundIndex, new BinaryExpr(
+                        new VariableVal(counted.inductionVar), new UniTemp(found), ExprOperator::add)));
+                replacement.push_back(new VarAssignmentTAStmt(new VariableVal(index->var), new UniTemp(foundIndex)));
+                replacement.push_back(new TempAssignmentTAStmt(element, new SubscriptableVariableVal(
+                        searched->var, new UniTemp(foundIndex))));
+                replacement.push_back(new VarAssignmentTAStmt(new VariableVal(extreme->var), new UniTemp(element)));
+                replacement.push_back(new LabelStmt(noneLabel));
+            }
+
+            // Closed forms of the sums, 's = s + k * count'
+            if (!accumulations.empty() && count == -1) appendCount();
+
+            for (const auto &[var, op, added]: accumulations) {
+                int product = function.newTemp();
+                int total = function.newTemp();
+
+                replacement.push_back(new TempAssignmentTAStmt(product, new BinaryExpr(
+                        ILAnalysis::cloneUniExpr(added), new UniTemp(count), ExprOperator::mult)));
+                replacement.push_back(new TempAssignmentTAStmt(total, new BinaryExpr(
+                        new VariableVal(var->var), new UniTemp(product), op)));
+                replacement.push_back(new VarAssignmentTAStmt(new VariableVal(var->var), new UniTemp(total)));
+            }
+
+            // The induction variable ends at the first value failing the test
+            if (isVariableLiveAfterLoop(cfg, loop, inductionName)) {
+                replacement.push_back(new VarAssignmentTAStmt(new VariableVal(counted.inductionVar), inclusive
+                        ? (ThreeAddressExprP) addConstant(ILAnalysis::cloneUniExpr(bound), 1)
+                        : (ThreeAddressExprP) ILAnalysis::cloneUniExpr(bound)));
+            }
+
+            // Nothing runs when the loop would not have run a single iteration
+            int test = function.newTemp();
+
+            replacement.push_front(new GotoIfZeroStmt(exitLabel, new UniTemp(test)));
+            replacement.push_front(new TempAssignmentTAStmt(test, ILAnalysis::cloneExpr(counted.comparison)));
+            replacement.push_back(new LabelStmt(exitLabel));
+
+            const BasicBlock &preheader = cfg.blocks[loop.preheader];
+
+            delete preheader.lastStmt();
+            function.stmts.erase(std::prev(preheader.end));
+
+            auto afterLoop = std::next(counted.testJump);
+
+            for (auto it = counted.begin; it != afterLoop;) {
+                delete *it;
+                it = function.stmts.erase(it);
+            }
+
+            function.stmts.splice(afterLoop, replacement);
+
+            replacedAny = true;
+            changed = true;
+            break;
+        }
+    }
+
+    return replacedAny;
+}
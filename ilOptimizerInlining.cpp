@@ -0,0 +1,318 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#include <iostream>
+#include "ilOptimizer.h"
+
+void ILOptimizer::inlineFunctions(std::vector<ILFunction> &functions) {
+    std::unordered_map<std::string, ILFunction *> functionsByName;
+    std::unordered_map<std::string, std::unordered_set<std::string>> callees = buildCallGraph(functions);
+    std::unordered_set<std::string> recursive = findRecursiveFunctions(callees);
+    std::unordered_map<std::string, int> callSites;
+
+    for (auto &function: functions) {
+        functionsByName[function.declaration->name] = &function;
+    }
+
+    for (auto &function: functions) {
+        for (auto stmt: function.stmts) {
+            FunctionCallExprP call = ILAnalysis::getCall(stmt);
+
+            if (call && functionsByName.contains(call->functionName)) callSites[call->functionName]++;
+        }
+    }
+
+    // Callees are handled before their callers, so a function is inlined together with the calls inlined into it
+    std::vector<ILFunction *> order;
+    std::unordered_set<std::string> visited;
+    std::function<void(ILFunction *)> visit = [&](ILFunction *function) {
+        if (!visited.insert(function->declaration->name).second) return;
+
+        for (const auto &callee: callees[function->declaration->name]) {
+            visit(functionsByName[callee]);
+        }
+
+        order.push_back(function);
+    };
+
+    for (auto &function: functions) {
+        visit(&function);
+    }
+
+    int inlineCount = 0;
+
+    for (ILFunction *caller: order) {
+        const std::string &callerName = caller->declaration->name;
+
+        ControlFlowGraph cfg(caller->stmts);
+        std::unordered_set<ThreeAddressStmtP> loopStmts;
+
+        for (const auto &loop: cfg.findLoops()) {
+            for (int block: loop.blocks) {
+                for (auto it = cfg.blocks[block].begin; it != cfg.blocks[block].end; ++it) {
+                    loopStmts.insert(*it);
+                }
+            }
+        }
+
+        std::vector<ILStmtIterator> calls;
+
+        for (auto it = caller->stmts.begin(); it != caller->stmts.end(); ++it) {
+            FunctionCallExprP call = ILAnalysis::getCall(*it);
+
+            if (call && functionsByName.contains(call->functionName)) calls.push_back(it);
+        }
+
+        // Inlined bodies never run at the same time, so they all number their temporaries after the caller's own
+        int tempBase = caller->declaration->maxTemp;
+        int growth = 0;
+
+        for (auto call: calls) {
+            ILFunction *callee = functionsByName[ILAnalysis::getCall(*call)->functionName];
+            const std::string &calleeName = callee->declaration->name;
+            auto paramCount = (int) callee->declaration->params.size();
+
+            int size = inlineSize(*callee);
+            int benefit = INLINE_CALL_COST + INLINE_PARAM_COST * paramCount;
+
+            if (loopStmts.contains(*call)) benefit *= INLINE_LOOP_WEIGHT;
+
+            // The body of a function called once is removed after it is inlined, so it does not grow the program
+            bool onlyCall = callSites[calleeName] == 1;
+            int callGrowth = onlyCall ? 0 : size;
+            std::vector<ILStmtIterator> pushes;
+            std::string reason;
+
+            if (recursive.contains(calleeName)) {
+                reason = "recursive";
+            } else if (size > INLINE_SIZE_LIMIT) {
+                reason = "size " + std::to_string(size) + " over the limit of " + std::to_string(INLINE_SIZE_LIMIT);
+            } else if (size > benefit && !onlyCall) {
+                reason = "size " + std::to_string(size) + " over the benefit of " + std::to_string(benefit);
+            } else if (growth + callGrowth > INLINE_GROWTH_BUDGET) {
+                reason = "growth budget of " + std::to_string(INLINE_GROWTH_BUDGET) + " used up";
+            } else if (!hasInlinableBody(*callee)) {
+                reason = "returns from inside a scope with variables";
+            } else if (!collectCallArguments(*caller, call, paramCount, pushes)) {
+                reason = "arguments interleaved with another call";
+            }
+
+            if (!reason.empty()) {
+                if (options.inlineReport) {
+                    std::cout << callerName << " -> " << calleeName << ": not inlined, " << reason << std::endl;
+                }
+
+                continue;
+            }
+
+            // The calls made by the callee are now made by the caller as well
+            for (auto stmt: callee->stmts) {
+                FunctionCallExprP innerCall = ILAnalysis::getCall(stmt);
+
+                if (innerCall && functionsByName.contains(innerCall->functionName)) {
+                    callSites[innerCall->functionName]++;
+                }
+            }
+
+            callSites[calleeName]--;
+            growth += callGrowth;
+
+            inlineCall(*caller, call, pushes, *callee, ".in" + std::to_string(++inlineCount), tempBase);
+
+            if (options.inlineReport) {
+                std::cout << callerName << " -> " << calleeName << ": inlined, size " << size << ", benefit "
+                          << benefit << std::endl;
+            }
+        }
+    }
+
+    // Only the functions still called from 'main' are kept
+    std::unordered_set<std::string> reachable = {"main"};
+    std::vector<std::string> pending = {"main"};
+
+    while (!pending.empty()) {
+        std::string current = pending.back();
+        pending.pop_back();
+
+        if (!functionsByName.contains(current)) continue;
+
+        for (auto stmt: functionsByName[current]->stmts) {
+            FunctionCallExprP call = ILAnalysis::getCall(stmt);
+
+            if (call && reachable.insert(call->functionName).second) pending.push_back(call->functionName);
+        }
+    }
+
+    std::erase_if(functions, [&](ILFunction &function) {
+        if (reachable.contains(function.declaration->name)) return false;
+
+        if (options.inlineReport) {
+            std::cout << function.declaration->name << ": removed, no calls left" << std::endl;
+        }
+
+        for (auto stmt: function.stmts) delete stmt;
+
+        return true;
+    });
+}
+
+int ILOptimizer::inlineSize(const ILFunction &function) {
+    int size = 0;
+
+    for (auto stmt: function.stmts) {
+        if (!dynamic_cast<LabelStmtP>(stmt) && !dynamic_cast<ScopeEnterStmtP>(stmt) &&
+            !dynamic_cast<ScopeExitStmtP>(stmt) && !dynamic_cast<FunctionDeclarationStmtP>(stmt) &&
+            !dynamic_cast<FunctionExitStmtP>(stmt)) {
+            size++;
+        }
+    }
+
+    return size;
+}
+
+LabelStmtP ILOptimizer::functionEndLabel(const ILFunction &function) {
+    const auto &stmts = function.stmts;
+
+    if (stmts.size() < 5 || !dynamic_cast<ScopeEnterStmtP>(*std::next(stmts.begin())) ||
+        !dynamic_cast<ScopeExitStmtP>(*std::prev(stmts.end(), 3))) {
+        return nullptr;
+    }
+
+    return dynamic_cast<LabelStmtP>(*std::prev(stmts.end(), 2));
+}
+
+bool ILOptimizer::hasInlinableBody(const ILFunction &function) {
+    const auto &stmts = function.stmts;
+    LabelStmtP endLabel = functionEndLabel(function);
+
+    if (!endLabel) return false;
+
+    // Jumping to the end skips the exits of the scopes in between, which only matters for scopes with variables
+    std::vector<bool> scopeHasVars;
+    int varScopes = 0;
+
+    for (auto it = std::next(stmts.begin(), 2); it != std::prev(stmts.end(), 3); ++it) {
+        if (auto scopeEnter = dynamic_cast<ScopeEnterStmtP>(*it)) {
+            scopeHasVars.push_back(!scopeEnter->vars.empty());
+            varScopes += scopeHasVars.back();
+        } else if (dynamic_cast<ScopeExitStmtP>(*it)) {
+            varScopes -= scopeHasVars.back();
+            scopeHasVars.pop_back();
+        } else if (varScopes > 0 && ILAnalysis::jumpTarget(*it) == endLabel->labelName) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ILOptimizer::collectCallArguments(ILFunction &caller, ILStmtIterator call, int paramCount,
+                                       std::vector<ILStmtIterator> &pushes) {
+    // The parameters are pushed in reverse, the push closest to the call is the first parameter. Another push
+    // before them belongs to an outer call whose arguments are still being pushed.
+    for (auto it = call; it != caller.stmts.begin();) {
+        --it;
+
+        if (ILAnalysis::getCall(*it) || ILAnalysis::isJump(*it) || dynamic_cast<LabelStmtP>(*it) ||
+            dynamic_cast<ScopeEnterStmtP>(*it) || dynamic_cast<ScopeExitStmtP>(*it) ||
+            dynamic_cast<FunctionDeclarationStmtP>(*it)) {
+            break;
+        }
+
+        if (dynamic_cast<FunctionParamPushStmtP>(*it)) pushes.push_back(it);
+    }
+
+    return (int) pushes.size() == paramCount;
+}
+
+void ILOptimizer::inlineCall(ILFunction &caller, ILStmtIterator call, const std::vector<ILStmtIterator> &pushes,
+                             const ILFunction &callee, const std::string &suffix, int tempBase) {
+    FunctionCallExprP callExpr = ILAnalysis::getCall(*call);
+    auto resultAssignment = dynamic_cast<TempAssignmentTAStmtP>(*call);
+    std::unordered_map<std::string, std::string> names;
+    std::vector<Variable> vars;
+
+    // The parameters and the return value become variables of a scope around the inlined body
+    for (const auto &param: callee.declaration->params) {
+        names[param.name] = param.name + suffix;
+        vars.emplace_back(param.name + suffix, param.type, param.ptrType);
+    }
+
+    Variable returnVar(GENERATED_VAR_PREFIX + "ret" + suffix, callExpr->retType, callExpr->retPtr);
+
+    if (resultAssignment) vars.push_back(returnVar);
+
+    for (auto stmt: callee.stmts) {
+        if (auto scopeEnter = dynamic_cast<ScopeEnterStmtP>(stmt)) {
+            for (const auto &var: scopeEnter->vars) names[var.name] = var.name + suffix;
+        }
+    }
+
+    // Each push is turned to an assignment of its parameter
+    for (size_t i = 0; i < pushes.size(); ++i) {
+        auto push = dynamic_cast<FunctionParamPushStmtP>(*pushes[i]);
+
+        *pushes[i] = new VarAssignmentTAStmt(new VariableVal(vars[i]), push->expr);
+        push->expr = nullptr;
+        delete push;
+    }
+
+    if (!vars.empty()) caller.stmts.insert(pushes.empty() ? call : pushes.back(), new ScopeEnterStmt(vars));
+
+    // Copy the body without the function's final scope exit and end label, returns jump to the copied end label
+    // placed before the scope exit instead
+    std::string endLabel = dynamic_cast<LabelStmtP>(*std::prev(callee.stmts.end(), 2))->labelName;
+    std::list<ThreeAddressStmtP> body;
+
+    for (auto it = std::next(callee.stmts.begin()); it != std::prev(callee.stmts.end(), 3); ++it) {
+        ThreeAddressStmtP stmt;
+
+        if (auto setReturnValue = dynamic_cast<SetReturnValueStmtP>(*it)) {
+            if (!resultAssignment) continue;
+
+            stmt = new VarAssignmentTAStmt(new VariableVal(returnVar), ILAnalysis::cloneExpr(setReturnValue->expr));
+        } else {
+            stmt = ILAnalysis::cloneStmt(*it);
+        }
+
+        ILAnalysis::renameVariables(stmt, names);
+
+        for (auto temp: ILAnalysis::usedTemps(stmt)) {
+            temp->id += tempBase;
+        }
+
+        if (auto tempAssignment = dynamic_cast<TempAssignmentTAStmtP>(stmt)) {
+            tempAssignment->id += tempBase;
+        } else if (auto labelStmt = dynamic_cast<LabelStmtP>(stmt)) {
+            labelStmt->labelName += suffix;
+        } else if (ILAnalysis::isJump(stmt)) {
+            ILAnalysis::setJumpTarget(stmt, ILAnalysis::jumpTarget(stmt) + suffix);
+        }
+
+        body.push_back(stmt);
+    }
+
+    // A return at the end of the body falls through to the end label
+    auto lastJump = dynamic_cast<GotoStmtP>(body.back());
+
+    if (lastJump && lastJump->labelName == endLabel + suffix) {
+        delete lastJump;
+        body.pop_back();
+    }
+
+    body.push_back(new LabelStmt(endLabel + suffix));
+    body.push_back(new ScopeExitStmt());
+
+    if (resultAssignment) {
+        body.push_back(new TempAssignmentTAStmt(resultAssignment->id, new VariableVal(returnVar)));
+    }
+
+    if (!vars.empty()) body.push_back(new ScopeExitStmt());
+
+    caller.stmts.splice(call, body);
+    delete *call;
+    caller.stmts.erase(call);
+
+    caller.declaration->maxTemp = std::max(caller.declaration->maxTemp, tempBase + callee.declaration->maxTemp);
+}
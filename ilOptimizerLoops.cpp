@@ -0,0 +1,786 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#include "ilOptimizer.h"
+
+LoopEffects ILOptimizer::collectLoopEffects(const ControlFlowGraph &cfg, const NaturalLoop &loop,
+                                            const std::unordered_set<std::string> &addressTaken,
+                                            const std::unordered_set<std::string> &nonWritingFunctions) {
+    LoopEffects effects;
+
+    for (int blockId: loop.blocks) {
+        const BasicBlock &block = cfg.blocks[blockId];
+
+        for (auto it = block.begin; it != block.end; ++it) {
+            if (auto assigned = ILAnalysis::assignedVariable(*it)) {
+                auto subVar = dynamic_cast<SubscriptableVariableValP>(assigned);
+
+                if (subVar && subVar->var.ptrType) {
+                    effects.pointerStore = true;
+                } else if (subVar) {
+                    effects.storedArrays.insert(subVar->var.name);
+                } else {
+                    effects.assignedVars.insert(assigned->var.name);
+                }
+
+                if (addressTaken.contains(assigned->var.name)) effects.aliasedWrite = true;
+            } else if (auto vectorStore = dynamic_cast<VectorStoreStmtP>(*it)) {
+                if (vectorStore->target->var.ptrType) {
+                    effects.pointerStore = true;
+                } else {
+                    effects.storedArrays.insert(vectorStore->target->var.name);
+                }
+
+                if (addressTaken.contains(vectorStore->target->var.name)) effects.aliasedWrite = true;
+            } else if (auto scopeEnter = dynamic_cast<ScopeEnterStmtP>(*it)) {
+                for (const auto &var: scopeEnter->vars) {
+                    effects.declaredVars.insert(var.name);
+                }
+            }
+
+            FunctionCallExprP call = ILAnalysis::getCall(*it);
+
+            if (call && !nonWritingFunctions.contains(call->functionName)) effects.hasCall = true;
+
+            int defined = ILAnalysis::definedTemp(*it);
+
+            if (defined != -1) effects.tempDefs[defined]++;
+        }
+    }
+
+    if (effects.pointerStore || effects.hasCall) effects.aliasedWrite = true;
+
+    return effects;
+}
+
+bool ILOptimizer::isLoopInvariant(ThreeAddressExprP expr, const LoopEffects &effects,
+                                  const std::unordered_set<std::string> &addressTaken) {
+    // A variable keeps its value if the loop neither assigns it, shadows it nor writes it through an alias
+    auto variableInvariant = [&effects, &addressTaken](const Variable &var) {
+        return !effects.assignedVars.contains(var.name) && !effects.declaredVars.contains(var.name) &&
+               !(addressTaken.contains(var.name) && (effects.pointerStore || effects.hasCall));
+    };
+
+    if (dynamic_cast<ImIntValP>(expr) || dynamic_cast<AddrStrExprP>(expr)) {
+        return true;
+    } else if (auto temp = dynamic_cast<UniTempP>(expr)) {
+        return !effects.tempDefs.contains(temp->id);
+    } else if (auto subVar = dynamic_cast<SubscriptableVariableValP>(expr)) {
+        if (!isLoopInvariant(subVar->index, effects, addressTaken)) return false;
+
+        if (subVar->var.ptrType) {
+            // The pointed memory may be any array or variable whose address was taken
+            return variableInvariant(subVar->var) && !effects.aliasedWrite;
+        }
+
+        return !effects.storedArrays.contains(subVar->var.name) && variableInvariant(subVar->var);
+    } else if (auto var = dynamic_cast<VariableValP>(expr)) {
+        return variableInvariant(var->var);
+    } else if (auto logicalNot = dynamic_cast<LogicalNotExprP>(expr)) {
+        return isLoopInvariant(logicalNot->expr, effects, addressTaken);
+    } else if (auto numericNeg = dynamic_cast<NumericNegExprP>(expr)) {
+        return isLoopInvariant(numericNeg->expr, effects, addressTaken);
+    } else if (auto addrVar = dynamic_cast<AddrVarExprP>(expr)) {
+        auto addrSubVar = dynamic_cast<SubscriptableVariableValP>(addrVar->addressable);
+
+        if (addrSubVar && !isLoopInvariant(addrSubVar->index, effects, addressTaken)) return false;
+
+        // Only the value of a pointer is read, the address of a local never changes
+        if (addrVar->addressable->var.ptrType) return variableInvariant(addrVar->addressable->var);
+
+        return !effects.declaredVars.contains(addrVar->addressable->var.name);
+    } else if (auto binary = dynamic_cast<BinaryExprP>(expr)) {
+        return isLoopInvariant(binary->left, effects, addressTaken) &&
+               isLoopInvariant(binary->right, effects, addressTaken);
+    }
+
+    // Function calls are never invariant
+    return false;
+}
+
+bool ILOptimizer::mayTrap(ThreeAddressExprP expr) {
+    if (auto subVar = dynamic_cast<SubscriptableVariableValP>(expr)) {
+        auto imIntIndex = dynamic_cast<ImIntValP>(subVar->index);
+
+        // Only a constant index inside a local array is known to be a valid address
+        if (subVar->var.ptrType || !imIntIndex || std::stoll(imIntIndex->value) >= subVar->var.arrSize) {
+            return true;
+        }
+
+        return false;
+    } else if (auto logicalNot = dynamic_cast<LogicalNotExprP>(expr)) {
+        return mayTrap(logicalNot->expr);
+    } else if (auto numericNeg = dynamic_cast<NumericNegExprP>(expr)) {
+        return mayTrap(numericNeg->expr);
+    } else if (auto addrVar = dynamic_cast<AddrVarExprP>(expr)) {
+        auto addrSubVar = dynamic_cast<SubscriptableVariableValP>(addrVar->addressable);
+
+        return addrSubVar && mayTrap(addrSubVar->index);
+    } else if (auto binary = dynamic_cast<BinaryExprP>(expr)) {
+        if (binary->op == ExprOperator::div || binary->op == ExprOperator::mod) {
+            auto imIntDivisor = dynamic_cast<ImIntValP>(binary->right);
+
+            if (!imIntDivisor || std::stoll(imIntDivisor->value) == 0) return true;
+        }
+
+        return mayTrap(binary->left) || mayTrap(binary->right);
+    }
+
+    return false;
+}
+
+ILStmtIterator ILOptimizer::preheaderInsertPoint(const BasicBlock &preheader) {
+    // Insert before the jump to the header, or at the end if the preheader falls through to it
+    if (ILAnalysis::isJump(preheader.lastStmt())) {
+        return std::prev(preheader.end);
+    }
+
+    return preheader.end;
+}
+
+bool ILOptimizer::findLoopRange(const ControlFlowGraph &cfg, const NaturalLoop &loop, ILStmtIterator &begin,
+                                ILStmtIterator &last) {
+    // Blocks are numbered in statement order, so the blocks of a contiguous loop have consecutive ids
+    int firstBlock = *loop.blocks.begin();
+    int lastBlock = *loop.blocks.rbegin();
+
+    if (lastBlock - firstBlock + 1 != (int) loop.blocks.size()) return false;
+
+    begin = cfg.blocks[firstBlock].begin;
+    last = std::prev(cfg.blocks[lastBlock].end);
+
+    int scopeDepth = 0;
+
+    for (auto it = begin;; ++it) {
+        if (dynamic_cast<ScopeEnterStmtP>(*it)) scopeDepth++;
+
+        if (dynamic_cast<ScopeExitStmtP>(*it) && --scopeDepth < 0) return false;
+
+        if (it == last) break;
+    }
+
+    return scopeDepth == 0;
+}
+
+bool ILOptimizer::hoistLoopInvariants(ILFunction &function) {
+    bool hoisted = false;
+
+    // Calls to functions that write no memory leave the loads of the loop unchanged
+    std::unordered_set<std::string> nonWritingFunctions;
+
+    for (const auto &[name, calleeEffects]: functionEffects) {
+        if (calleeEffects.purity != FunctionPurity::sideEffecting) nonWritingFunctions.insert(name);
+    }
+
+    // Moving statements keeps the graph's blocks, it is only rebuilt once a move empties a block. Hoisting a
+    // temporary's assignment renames it unless it has one, so the other temporaries only become live for less
+    // and their liveness stays a safe estimate.
+    ControlFlowGraph cfg(function.stmts);
+    std::vector<NaturalLoop> loops = cfg.findLoops();
+    bool rebuild = false;
+
+    cfg.computeTempLiveness();
+
+    std::unordered_set<std::string> addressTaken = ILAnalysis::addressTakenVariables(function.stmts);
+    // Temporaries assigned once in the whole function can move without being renamed
+    std::unordered_map<int, int> functionTempDefs;
+
+    for (auto stmt: function.stmts) {
+        int defined = ILAnalysis::definedTemp(stmt);
+
+        if (defined != -1) functionTempDefs[defined]++;
+    }
+
+    for (size_t loopIndex = 0; loopIndex < loops.size(); ++loopIndex) {
+        if (rebuild) {
+            cfg = ControlFlowGraph(function.stmts);
+            loops = cfg.findLoops();
+            rebuild = false;
+
+            cfg.computeTempLiveness();
+
+            if (loopIndex >= loops.size()) break;
+        }
+
+        const NaturalLoop &loop = loops[loopIndex];
+
+        if (loop.preheader == -1) continue;
+
+        LoopEffects effects = collectLoopEffects(cfg, loop, addressTaken, nonWritingFunctions);
+        ILStmtIterator insertPoint = preheaderInsertPoint(cfg.blocks[loop.preheader]);
+
+        for (int blockId: loop.blocks) {
+            const BasicBlock &block = cfg.blocks[blockId];
+
+            // A block that dominates every exit runs on each entry to the loop, so even
+            // statements that may trap can run in the preheader instead
+            bool alwaysExecuted = true;
+
+            for (int exiting: loop.exitingBlocks) {
+                if (!cfg.dominates(blockId, exiting)) alwaysExecuted = false;
+            }
+
+            for (auto it = block.begin; it != block.end;) {
+                auto current = it++;
+                auto tempAssignment = dynamic_cast<TempAssignmentTAStmtP>(*current);
+
+                if (!tempAssignment) continue;
+
+                ThreeAddressExprP expr = tempAssignment->expr;
+                std::vector<ILStmtIterator> pushes;
+
+                if (dynamic_cast<FunctionCallExprP>(expr)) {
+                    if (!isInvariantCall(function, current, effects, addressTaken, alwaysExecuted, pushes)) continue;
+                } else {
+                    // Moving a plain copy saves nothing
+                    if (dynamic_cast<ImIntValP>(expr) || dynamic_cast<UniTempP>(expr) ||
+                        (dynamic_cast<VariableValP>(expr) && !dynamic_cast<SubscriptableVariableValP>(expr))) {
+                        continue;
+                    }
+
+                    if (!isLoopInvariant(expr, effects, addressTaken) || (!alwaysExecuted && mayTrap(expr))) continue;
+                }
+
+                int oldTemp = tempAssignment->id;
+
+                if (functionTempDefs[oldTemp] != 1) {
+                    // The temporary is reused, so the uses reached by this assignment are renamed to a new one.
+                    // They are all in this block unless the temporary is still live at the block's end.
+                    std::vector<UniTempP> reachedUses;
+                    bool redefined = false;
+
+                    for (auto useIt = it; useIt != block.end && !redefined; ++useIt) {
+                        for (auto temp: ILAnalysis::usedTemps(*useIt)) {
+                            if (temp->id == oldTemp) reachedUses.push_back(temp);
+                        }
+
+                        redefined = ILAnalysis::definedTemp(*useIt) == oldTemp;
+                    }
+
+                    if (!redefined && cfg.tempLiveOut[blockId].contains(oldTemp)) continue;
+
+                    int newTemp = function.newTemp();
+
+                    for (auto temp: reachedUses) {
+                        temp->id = newTemp;
+                    }
+
+                    tempAssignment->id = newTemp;
+                    functionTempDefs[oldTemp]--;
+                    functionTempDefs[newTemp] = 1;
+                }
+
+                if (--effects.tempDefs[oldTemp] == 0) effects.tempDefs.erase(oldTemp);
+
+                for (auto push: pushes) {
+                    rebuild = !cfg.moveStmt(function.stmts, push, insertPoint) || rebuild;
+                }
+
+                rebuild = !cfg.moveStmt(function.stmts, current, insertPoint) || rebuild;
+                hoisted = true;
+            }
+        }
+    }
+
+    return hoisted;
+}
+
+bool ILOptimizer::matchVariablePlusConstant(ThreeAddressExprP expr, const std::string &name, long long &constant) {
+    auto binary = dynamic_cast<BinaryExprP>(expr);
+
+    if (!binary || (binary->op != ExprOperator::add && binary->op != ExprOperator::sub)) return false;
+
+    auto isVariable = [&name](UniExprP uni) {
+        auto var = dynamic_cast<VariableValP>(uni);
+
+        return var && !dynamic_cast<SubscriptableVariableValP>(var) && var->var.name == name;
+    };
+
+    auto leftImInt = dynamic_cast<ImIntValP>(binary->left);
+    auto rightImInt = dynamic_cast<ImIntValP>(binary->right);
+
+    if (isVariable(binary->left) && rightImInt) {
+        constant = std::stoll(rightImInt->value);
+
+        if (binary->op == ExprOperator::sub) constant = -constant;
+
+        return true;
+    }
+
+    if (binary->op == ExprOperator::add && leftImInt && isVariable(binary->right)) {
+        constant = std::stoll(leftImInt->value);
+
+        return true;
+    }
+
+    return false;
+}
+
+bool ILOptimizer::findInductionSteps(const ControlFlowGraph &cfg, const NaturalLoop &loop, const std::string &name,
+                                     std::vector<InductionStep> &steps) {
+    for (int blockId: loop.blocks) {
+        const BasicBlock &block = cfg.blocks[blockId];
+
+        for (auto it = block.begin; it != block.end; ++it) {
+            auto assigned = ILAnalysis::assignedVariable(*it);
+
+            if (!assigned || dynamic_cast<SubscriptableVariableValP>(assigned) || assigned->var.name != name) {
+                continue;
+            }
+
+            auto varAssignment = dynamic_cast<VarAssignmentTAStmtP>(*it);
+            long long step;
+
+            if (matchVariablePlusConstant(varAssignment->expr, name, step)) {
+                steps.emplace_back(it, step);
+                continue;
+            }
+
+            // The IL generator computes the new value to a temporary assigned right before
+            auto valueTemp = dynamic_cast<UniTempP>(varAssignment->expr);
+
+            if (!valueTemp || it == block.begin) return false;
+
+            auto stepAssignment = dynamic_cast<TempAssignmentTAStmtP>(*std::prev(it));
+
+            if (!stepAssignment || stepAssignment->id != valueTemp->id ||
+                !matchVariablePlusConstant(stepAssignment->expr, name, step)) {
+                return false;
+            }
+
+            steps.emplace_back(it, step);
+        }
+    }
+
+    return true;
+}
+
+std::set<int> ILOptimizer::forwardReachable(const ControlFlowGraph &cfg, const NaturalLoop &loop, int from) {
+    std::set<int> reached;
+    std::vector<int> worklist = {from};
+
+    while (!worklist.empty()) {
+        int blockId = worklist.back();
+        worklist.pop_back();
+
+        for (int successor: cfg.blocks[blockId].successors) {
+            if (loop.contains(successor) && successor != loop.header && reached.insert(successor).second) {
+                worklist.push_back(successor);
+            }
+        }
+    }
+
+    return reached;
+}
+
+bool ILOptimizer::matchIndexOffset(const ControlFlowGraph &cfg, const NaturalLoop &loop, int useBlock,
+                                   ILStmtIterator use, int temp, const std::string &name,
+                                   const std::vector<InductionStep> &steps, long long &offset) {
+    // Look for 'tempN := i + c' earlier in the block, with 'i' unchanged since
+    for (auto defIt = use; defIt != cfg.blocks[useBlock].begin;) {
+        --defIt;
+
+        if (ILAnalysis::definedTemp(*defIt) == temp) {
+            return matchVariablePlusConstant(dynamic_cast<TempAssignmentTAStmtP>(*defIt)->expr, name, offset);
+        }
+
+        auto assigned = ILAnalysis::assignedVariable(*defIt);
+
+        if (assigned && assigned->var.name == name) return false;
+    }
+
+    // Otherwise the temporary must have a single assignment in the loop, in a block dominating the use
+    int defBlock = -1;
+    ILStmtIterator def;
+
+    for (int blockId: loop.blocks) {
+        for (auto it = cfg.blocks[blockId].begin; it != cfg.blocks[blockId].end; ++it) {
+            if (ILAnalysis::definedTemp(*it) != temp) continue;
+
+            if (defBlock != -1) return false;
+
+            defBlock = blockId;
+            def = it;
+        }
+    }
+
+    if (defBlock == -1 || defBlock == useBlock || !cfg.dominates(defBlock, useBlock) ||
+        !matchVariablePlusConstant(dynamic_cast<TempAssignmentTAStmtP>(*def)->expr, name, offset)) {
+        return false;
+    }
+
+    // No step of 'i' may run between the assignment and the use
+    std::set<int> afterDef = forwardReachable(cfg, loop, defBlock);
+
+    for (const auto &step: steps) {
+        for (int blockId: loop.blocks) {
+            const BasicBlock &block = cfg.blocks[blockId];
+            bool inBlock = false;
+
+            for (auto it = block.begin; it != block.end && !inBlock; ++it) {
+                inBlock = it == step.assignment;
+            }
+
+            if (!inBlock) continue;
+
+            if (blockId == defBlock) {
+                // Only a step before the assignment is harmless
+                for (auto it = std::next(def); it != block.end; ++it) {
+                    if (it == step.assignment) return false;
+                }
+            } else if (afterDef.contains(blockId) && (blockId == useBlock ||
+                                                      forwardReachable(cfg, loop, blockId).contains(useBlock))) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool ILOptimizer::isVariableLiveAfterLoop(const ControlFlowGraph &cfg, const NaturalLoop &loop,
+                                          const std::string &name) {
+    std::vector<int> worklist;
+    std::unordered_set<int> visited;
+
+    for (int exiting: loop.exitingBlocks) {
+        for (int successor: cfg.blocks[exiting].successors) {
+            if (!loop.contains(successor)) worklist.push_back(successor);
+        }
+    }
+
+    while (!worklist.empty()) {
+        int blockId = worklist.back();
+        worklist.pop_back();
+
+        if (!visited.insert(blockId).second) continue;
+
+        const BasicBlock &block = cfg.blocks[blockId];
+        bool assigned = false;
+
+        for (auto it = block.begin; it != block.end && !assigned; ++it) {
+            if (ILAnalysis::readsVariable(*it, name)) return true;
+
+            auto assignedVar = ILAnalysis::assignedVariable(*it);
+
+            assigned = assignedVar && !dynamic_cast<SubscriptableVariableValP>(assignedVar) &&
+                       assignedVar->var.name == name;
+        }
+
+        if (!assigned) {
+            worklist.insert(worklist.end(), block.successors.begin(), block.successors.end());
+        }
+    }
+
+    return false;
+}
+
+bool ILOptimizer::reduceInductionVariables(ILFunction &function) {
+    bool reduced = false;
+    // Only a rewrite changes the statements, the graph is rebuilt after it
+    ControlFlowGraph cfg(function.stmts);
+    std::vector<NaturalLoop> loops = cfg.findLoops();
+
+    cfg.computeTempLiveness();
+
+    for (size_t loopIndex = 0; loopIndex < loops.size(); ++loopIndex) {
+        const NaturalLoop &loop = loops[loopIndex];
+
+        if (loop.preheader == -1) continue;
+
+        // A register variable only lives in the loop it was created for, so loops that don't use it can reuse it
+        std::unordered_set<std::string> usedRegisterVars;
+
+        for (int blockId: loop.blocks) {
+            for (auto it = cfg.blocks[blockId].begin; it != cfg.blocks[blockId].end; ++it) {
+                std::vector<VariableValP> scalarReads;
+                std::vector<SubscriptableVariableValP> elementReads;
+
+                ILAnalysis::collectStmtReads(*it, scalarReads, elementReads);
+
+                if (auto assigned = ILAnalysis::assignedVariable(*it)) scalarReads.push_back(assigned);
+
+                for (auto var: scalarReads) {
+                    usedRegisterVars.insert(var->var.name);
+                }
+            }
+        }
+
+        std::vector<std::string> freeRegisterVars;
+
+        for (const auto &registerVar: function.declaration->registerVars) {
+            if (!usedRegisterVars.contains(registerVar.name)) freeRegisterVars.push_back(registerVar.name);
+        }
+
+        int freeRegisters = (int) freeRegisterVars.size() + MAX_REGISTER_VARS -
+                            (int) function.declaration->registerVars.size();
+
+        if (freeRegisters == 0) continue;
+
+        std::unordered_set<std::string> addressTaken = ILAnalysis::addressTakenVariables(function.stmts);
+        LoopEffects effects = collectLoopEffects(cfg, loop, addressTaken);
+        ILStmtIterator insertPoint = preheaderInsertPoint(cfg.blocks[loop.preheader]);
+
+        // Find the induction variable candidates: plain integer variables of the function
+        std::vector<Variable> candidates;
+
+        for (int blockId: loop.blocks) {
+            for (auto it = cfg.blocks[blockId].begin; it != cfg.blocks[blockId].end; ++it) {
+                auto assigned = ILAnalysis::assignedVariable(*it);
+
+                if (!assigned || dynamic_cast<SubscriptableVariableValP>(assigned)) continue;
+
+                const Variable &var = assigned->var;
+
+                // A char wraps around too soon for its elements' addresses to follow it
+                if (var.ptrType || var.arrSize > 0 || var.type == VariableType::charType ||
+                    addressTaken.contains(var.name) || effects.declaredVars.contains(var.name) ||
+                    std::find(candidates.begin(), candidates.end(), var) != candidates.end()) {
+                    continue;
+                }
+
+                candidates.push_back(var);
+            }
+        }
+
+        bool rewritten = false;
+
+        for (const Variable &inductionVar: candidates) {
+            std::vector<InductionStep> steps;
+
+            if (!findInductionSteps(cfg, loop, inductionVar.name, steps)) continue;
+
+            // Collect the element accesses indexed by the variable, grouped by the subscripted variable
+            std::vector<std::string> bases;
+            std::unordered_map<std::string, std::vector<DerivedAccess>> accesses;
+
+            for (int blockId: loop.blocks) {
+                const BasicBlock &block = cfg.blocks[blockId];
+
+                for (auto it = block.begin; it != block.end; ++it) {
+                    std::vector<VariableValP> scalarReads;
+                    std::vector<SubscriptableVariableValP> subVars;
+
+                    ILAnalysis::collectStmtReads(*it, scalarReads, subVars);
+
+                    // Element stores and addresses of elements are indexed the same way as loads
+                    if (auto assigned = dynamic_cast<SubscriptableVariableValP>(ILAnalysis::assignedVariable(*it))) {
+                        subVars.push_back(assigned);
+                    } else if (auto vectorStore = dynamic_cast<VectorStoreStmtP>(*it)) {
+                        subVars.push_back(vectorStore->target);
+                    }
+
+                    std::vector<AddrVarExprP> addrVars;
+
+                    if (auto tempAssignment = dynamic_cast<TempAssignmentTAStmtP>(*it)) {
+                        if (auto addrVar = dynamic_cast<AddrVarExprP>(tempAssignment->expr)) addrVars.push_back(addrVar);
+                    } else if (auto varAssignment = dynamic_cast<VarAssignmentTAStmtP>(*it)) {
+                        if (auto addrVar = dynamic_cast<AddrVarExprP>(varAssignment->expr)) addrVars.push_back(addrVar);
+                    } else if (auto functionParamPush = dynamic_cast<FunctionParamPushStmtP>(*it)) {
+                        if (auto addrVar = dynamic_cast<AddrVarExprP>(functionParamPush->expr)) {
+                            addrVars.push_back(addrVar);
+                        }
+                    }
+
+                    for (auto addrVar: addrVars) {
+                        if (auto addrSubVar = dynamic_cast<SubscriptableVariableValP>(addrVar->addressable)) {
+                            subVars.push_back(addrSubVar);
+                        }
+                    }
+
+                    for (auto subVar: subVars) {
+                        long long offset = 0;
+                        auto indexVar = dynamic_cast<VariableValP>(subVar->index);
+                        auto indexTemp = dynamic_cast<UniTempP>(subVar->index);
+
+                        if (indexVar && !dynamic_cast<SubscriptableVariableValP>(indexVar) &&
+                            indexVar->var.name == inductionVar.name) {
+                            offset = 0;
+                        } else if (indexTemp) {
+                            if (!matchIndexOffset(cfg, loop, blockId, it, indexTemp->id, inductionVar.name, steps,
+                                                  offset)) {
+                                continue;
+                            }
+                        } else {
+                            continue;
+                        }
+
+                        // The subscripted variable itself must stay the same for the whole loop
+                        VariableVal baseVal(subVar->var);
+
+                        if (subVar->var.name.starts_with(GENERATED_VAR_PREFIX) ||
+                            (subVar->var.ptrType && !isLoopInvariant(&baseVal, effects, addressTaken)) ||
+                            effects.declaredVars.contains(subVar->var.name)) {
+                            continue;
+                        }
+
+                        if (!accesses.contains(subVar->var.name)) bases.push_back(subVar->var.name);
+
+                        accesses[subVar->var.name].emplace_back(subVar, offset);
+                    }
+                }
+            }
+
+            if (bases.empty()) continue;
+
+            // Give the registers to the most accessed variables
+            std::stable_sort(bases.begin(), bases.end(), [&accesses](const std::string &a, const std::string &b) {
+                return accesses[a].size() > accesses[b].size();
+            });
+
+            if ((int) bases.size() > freeRegisters) bases.resize(freeRegisters);
+
+            std::vector<Variable> baseVars;
+            std::vector<Variable> pointers;
+
+            for (const auto &base: bases) {
+                Variable baseVar = accesses[base].front().access->var;
+                baseVars.push_back(baseVar);
+                std::string pointerName;
+
+                if (!freeRegisterVars.empty()) {
+                    pointerName = freeRegisterVars.back();
+                    freeRegisterVars.pop_back();
+                } else {
+                    pointerName = GENERATED_VAR_PREFIX + "iv" +
+                                  std::to_string(function.declaration->registerVars.size() + 1);
+                    function.declaration->registerVars.emplace_back(pointerName, baseVar.type, true);
+                }
+
+                // Each use of a register variable carries the element type it points to in that loop
+                Variable pointer(pointerName, baseVar.type, true);
+
+                pointers.push_back(pointer);
+                freeRegisters--;
+
+                // The pointer starts at the element of the variable's value on entry
+                function.stmts.insert(insertPoint, new VarAssignmentTAStmt(
+                        new VariableVal(pointer),
+                        new AddrVarExpr(new SubscriptableVariableVal(baseVar, new VariableVal(inductionVar)))));
+
+                for (const auto &derived: accesses[base]) {
+                    derived.access->var = pointer;
+                    delete derived.access->index;
+                    derived.access->index = new ImIntVal(std::to_string(derived.offset));
+                }
+
+                // Step the pointer right after every step of the induction variable
+                int elementSize = typeSizes.at(baseVar.type);
+
+                for (const auto &step: steps) {
+                    function.stmts.insert(std::next(step.assignment), new VarAssignmentTAStmt(
+                            new VariableVal(pointer), addConstant(new VariableVal(pointer), step.step * elementSize)));
+                }
+            }
+
+            rewritten = true;
+
+            // Check whether the variable is now only read by its steps and by comparisons with invariant bounds
+            std::unordered_set<ThreeAddressStmtP> stepStmts;
+
+            for (const auto &step: steps) {
+                stepStmts.insert(*step.assignment);
+
+                if (dynamic_cast<UniTempP>(dynamic_cast<VarAssignmentTAStmtP>(*step.assignment)->expr)) {
+                    stepStmts.insert(*std::prev(step.assignment));
+                }
+            }
+
+            // Index computations of the rewritten accesses are left unread, they are removed later
+            auto unreadAssignment = [&cfg](const BasicBlock &block, ILStmtIterator it) {
+                int defined = ILAnalysis::definedTemp(*it);
+
+                if (defined == -1) return false;
+
+                for (++it; it != block.end; ++it) {
+                    for (auto temp: ILAnalysis::usedTemps(*it)) {
+                        if (temp->id == defined) return false;
+                    }
+
+                    if (ILAnalysis::definedTemp(*it) == defined) return true;
+                }
+
+                return !cfg.tempLiveOut[block.id].contains(defined);
+            };
+
+            std::vector<BinaryExprP> comparisons;
+            bool onlyCompared = true;
+
+            for (int blockId: loop.blocks) {
+                const BasicBlock &block = cfg.blocks[blockId];
+
+                for (auto it = block.begin; it != block.end && onlyCompared; ++it) {
+                    if (stepStmts.contains(*it) || !ILAnalysis::readsVariable(*it, inductionVar.name) ||
+                        unreadAssignment(block, it)) {
+                        continue;
+                    }
+
+                    auto tempAssignment = dynamic_cast<TempAssignmentTAStmtP>(*it);
+                    auto binary = tempAssignment ? dynamic_cast<BinaryExprP>(tempAssignment->expr) : nullptr;
+
+                    if (!binary || binary->op < ExprOperator::equals || binary->op > ExprOperator::lessThanEquals) {
+                        onlyCompared = false;
+                        break;
+                    }
+
+                    auto leftVar = dynamic_cast<VariableValP>(binary->left);
+                    auto rightVar = dynamic_cast<VariableValP>(binary->right);
+                    bool leftInduction = leftVar && leftVar->var.name == inductionVar.name &&
+                                         !dynamic_cast<SubscriptableVariableValP>(leftVar);
+                    bool rightInduction = rightVar && rightVar->var.name == inductionVar.name &&
+                                          !dynamic_cast<SubscriptableVariableValP>(rightVar);
+                    UniExprP bound = leftInduction ? binary->right : binary->left;
+
+                    if (leftInduction == rightInduction || dynamic_cast<SubscriptableVariableValP>(bound) ||
+                        !isLoopInvariant(bound, effects, addressTaken)) {
+                        onlyCompared = false;
+                        break;
+                    }
+
+                    comparisons.push_back(binary);
+                }
+            }
+
+            if (!onlyCompared || isVariableLiveAfterLoop(cfg, loop, inductionVar.name)) break;
+
+            // Compare the first pointer with the address of the bound's element instead: the element
+            // addresses are ordered like the indices
+            for (auto binary: comparisons) {
+                auto leftVar = dynamic_cast<VariableValP>(binary->left);
+                bool leftInduction = leftVar && leftVar->var.name == inductionVar.name;
+                UniExpr *&inductionSide = leftInduction ? binary->left : binary->right;
+                UniExpr *&boundSide = leftInduction ? binary->right : binary->left;
+                int boundTemp = function.newTemp();
+
+                function.stmts.insert(insertPoint, new TempAssignmentTAStmt(
+                        boundTemp, new AddrVarExpr(new SubscriptableVariableVal(baseVars.front(), boundSide))));
+
+                delete inductionSide;
+                inductionSide = new VariableVal(pointers.front());
+                boundSide = new UniTemp(boundTemp);
+            }
+
+            // The variable is not read anymore, so it doesn't have to be stepped
+            for (const auto &step: steps) {
+                delete *step.assignment;
+                function.stmts.erase(step.assignment);
+            }
+
+            break;
+        }
+
+        if (rewritten) {
+            reduced = true;
+            // Visit the loop again with an up to date graph, for its other induction variables
+            loopIndex--;
+
+            cfg = ControlFlowGraph(function.stmts);
+            loops = cfg.findLoops();
+
+            cfg.computeTempLiveness();
+        }
+    }
+
+    return reduced;
+}
@@ -0,0 +1,43 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#include <cmath>
+#include "ilOptimizer.h"
+
+void ILOptimizer::memoizeFunctions(std::vector<ILFunction> &functions) {
+    std::unordered_set<std::string> recursive = findRecursiveFunctions(buildCallGraph(functions));
+
+    for (auto &function: functions) {
+        FunctionDeclarationStmtP declaration = function.declaration;
+        const std::vector<Variable> &params = declaration->params;
+
+        // Only the return value of a pure function is determined by its arguments
+        if (!recursive.contains(declaration->name) ||
+            functionEffects[declaration->name].purity != FunctionPurity::pure ||
+            declaration->retType == VariableType::voidType || declaration->retPtr || params.empty() ||
+            (int) params.size() > MAX_MEMO_PARAMS) {
+            continue;
+        }
+
+        if (std::any_of(params.begin(), params.end(), [](const Variable &param) { return param.ptrType; })) continue;
+
+        // The largest range whose power by the number of parameters fits the table, pow may round the root either way
+        auto fits = [&params, this](long long range) {
+            long long size = 1;
+
+            for (size_t i = 0; i < params.size(); ++i) {
+                size *= range;
+            }
+
+            return size <= options.memoizeSize;
+        };
+        auto range = (long long) std::pow(options.memoizeSize, 1.0 / (double) params.size());
+
+        while (range > 1 && !fits(range)) range--;
+        while (fits(range + 1)) range++;
+
+        declaration->memoRange = (int) range;
+        declaration->memoTemp = function.newTemp();
+    }
+}
@@ -0,0 +1,373 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#include "ilOptimizer.h"
+
+std::unordered_map<std::string, std::unordered_set<std::string>>
+ILOptimizer::buildCallGraph(const std::vector<ILFunction> &functions) {
+    std::unordered_set<std::string> defined;
+    std::unordered_map<std::string, std::unordered_set<std::string>> callees;
+
+    for (const auto &function: functions) {
+        defined.insert(function.declaration->name);
+    }
+
+    for (const auto &function: functions) {
+        callees[function.declaration->name];
+
+        for (auto stmt: function.stmts) {
+            FunctionCallExprP call = ILAnalysis::getCall(stmt);
+
+            if (call && defined.contains(call->functionName)) {
+                callees[function.declaration->name].insert(call->functionName);
+            }
+        }
+    }
+
+    return callees;
+}
+
+std::unordered_set<std::string>
+ILOptimizer::findRecursiveFunctions(const std::unordered_map<std::string, std::unordered_set<std::string>> &callees) {
+    std::unordered_set<std::string> recursive;
+
+    for (const auto &[name, called]: callees) {
+        std::unordered_set<std::string> visited;
+        std::vector<std::string> pending(called.begin(), called.end());
+
+        while (!pending.empty()) {
+            std::string current = pending.back();
+            pending.pop_back();
+
+            if (current == name) {
+                recursive.insert(name);
+                break;
+            }
+
+            if (!visited.insert(current).second) continue;
+
+            const auto &next = callees.at(current);
+            pending.insert(pending.end(), next.begin(), next.end());
+        }
+    }
+
+    return recursive;
+}
+
+void ILOptimizer::analyzeFunctionEffects(std::vector<ILFunction> &functions) {
+    std::unordered_map<std::string, std::unordered_set<std::string>> callees = buildCallGraph(functions);
+    std::unordered_set<std::string> recursive = findRecursiveFunctions(callees);
+
+    functionEffects.clear();
+
+    // The effects of each function's own statements
+    for (auto &function: functions) {
+        const std::string &name = function.declaration->name;
+        FunctionEffects &effects = functionEffects[name];
+        ControlFlowGraph cfg(function.stmts);
+
+        effects.mayNotReturn = recursive.contains(name) || !cfg.findLoops().empty();
+
+        auto raise = [&effects](FunctionPurity purity) {
+            if (purity > effects.purity) effects.purity = purity;
+        };
+
+        for (auto stmt: function.stmts) {
+            FunctionCallExprP call = ILAnalysis::getCall(stmt);
+
+            // Builtin functions do input and output or exit
+            if (call && !callees.contains(call->functionName)) {
+                raise(FunctionPurity::sideEffecting);
+                effects.mayNotReturn = true;
+            }
+
+            // Memory behind a pointer may belong to the caller, the function's own variables and arrays do not
+            auto stored = dynamic_cast<SubscriptableVariableValP>(ILAnalysis::assignedVariable(stmt));
+            auto vectorStore = dynamic_cast<VectorStoreStmtP>(stmt);
+
+            if ((stored && stored->var.ptrType) || (vectorStore && vectorStore->target->var.ptrType)) {
+                raise(FunctionPurity::sideEffecting);
+            }
+
+            std::vector<VariableValP> scalarReads;
+            std::vector<SubscriptableVariableValP> elementReads;
+
+            ILAnalysis::collectStmtReads(stmt, scalarReads, elementReads);
+
+            for (auto subVar: elementReads) {
+                if (subVar->var.ptrType) raise(FunctionPurity::readOnly);
+            }
+
+            if (stmtMayTrap(stmt)) effects.mayNotReturn = true;
+        }
+    }
+
+    // A function also has the effects of the functions it calls, repeated until the recursive functions agree
+    for (bool changed = true; changed;) {
+        changed = false;
+
+        for (const auto &[name, called]: callees) {
+            FunctionEffects &effects = functionEffects[name];
+
+            for (const auto &callee: called) {
+                const FunctionEffects &calleeEffects = functionEffects[callee];
+
+                if (calleeEffects.purity > effects.purity) {
+                    effects.purity = calleeEffects.purity;
+                    changed = true;
+                }
+
+                if (calleeEffects.mayNotReturn && !effects.mayNotReturn) {
+                    effects.mayNotReturn = true;
+                    changed = true;
+                }
+            }
+        }
+    }
+}
+
+bool ILOptimizer::stmtMayTrap(ThreeAddressStmtP stmt) {
+    if (auto tempAssignment = dynamic_cast<TempAssignmentTAStmtP>(stmt)) {
+        return mayTrap(tempAssignment->expr);
+    } else if (auto varAssignment = dynamic_cast<VarAssignmentTAStmtP>(stmt)) {
+        return mayTrap(varAssignment->expr) || mayTrap(varAssignment->var);
+    } else if (auto functionParamPush = dynamic_cast<FunctionParamPushStmtP>(stmt)) {
+        return mayTrap(functionParamPush->expr);
+    } else if (auto gotoIfZeroStmt = dynamic_cast<GotoIfZeroStmtP>(stmt)) {
+        return mayTrap(gotoIfZeroStmt->expr);
+    } else if (auto gotoIfNotZeroStmt = dynamic_cast<GotoIfNotZeroStmtP>(stmt)) {
+        return mayTrap(gotoIfNotZeroStmt->expr);
+    } else if (auto setReturnValue = dynamic_cast<SetReturnValueStmtP>(stmt)) {
+        return mayTrap(setReturnValue->expr);
+    } else if (auto vectorLoad = dynamic_cast<VectorLoadStmtP>(stmt)) {
+        return mayTrap(vectorLoad->source);
+    } else if (auto vectorStore = dynamic_cast<VectorStoreStmtP>(stmt)) {
+        return mayTrap(vectorStore->target);
+    }
+
+    return false;
+}
+
+FunctionPurity ILOptimizer::callPurity(FunctionCallExprP call) const {
+    auto effects = functionEffects.find(call->functionName);
+
+    return effects != functionEffects.end() ? effects->second.purity : FunctionPurity::sideEffecting;
+}
+
+bool ILOptimizer::mergePureCalls(ILFunction &function) {
+    ControlFlowGraph cfg(function.stmts);
+    std::unordered_set<std::string> addressTaken = ILAnalysis::addressTakenVariables(function.stmts);
+    bool merged = false;
+    // Numbers the values that can't be described by an expression, and the versions of the variables
+    int valueCount = 0;
+
+    for (const BasicBlock &block: cfg.blocks) {
+        // The value held by each temporary, described by the expression computing it from the values at the
+        // start of the block
+        std::unordered_map<int, std::string> tempValues;
+        // The version of each variable assigned in the block, the others are at the scope's version
+        std::unordered_map<std::string, int> varVersions;
+        int scopeVersion = ++valueCount;
+        // Changes on every store to memory, loads and variables whose address is taken read a new value then
+        int memoryVersion = 0;
+        std::unordered_map<ThreeAddressStmtP, std::string> pushValues;
+        // The temporary holding the result of each call and its value, by the call's function and argument values
+        std::unordered_map<std::string, std::pair<int, std::string>> calls;
+
+        auto varValue = [&](const Variable &var) {
+            auto version = varVersions.find(var.name);
+            std::string value = var.name + "#" + std::to_string(version != varVersions.end() ? version->second
+                                                                                          : scopeVersion);
+
+            if (addressTaken.contains(var.name)) value += "@" + std::to_string(memoryVersion);
+
+            return value;
+        };
+
+        std::function<std::string(ThreeAddressExprP)> valueOf = [&](ThreeAddressExprP expr) -> std::string {
+            if (auto imInt = dynamic_cast<ImIntValP>(expr)) {
+                return imInt->value;
+            } else if (auto temp = dynamic_cast<UniTempP>(expr)) {
+                auto value = tempValues.find(temp->id);
+
+                return value != tempValues.end() ? value->second : "t" + std::to_string(temp->id);
+            } else if (auto subVar = dynamic_cast<SubscriptableVariableValP>(expr)) {
+                return varValue(subVar->var) + "[" + valueOf(subVar->index) + "]@" + std::to_string(memoryVersion);
+            } else if (auto var = dynamic_cast<VariableValP>(expr)) {
+                return varValue(var->var);
+            } else if (auto logicalNot = dynamic_cast<LogicalNotExprP>(expr)) {
+                return "!(" + valueOf(logicalNot->expr) + ")";
+            } else if (auto numericNeg = dynamic_cast<NumericNegExprP>(expr)) {
+                return "-(" + valueOf(numericNeg->expr) + ")";
+            } else if (auto addrVar = dynamic_cast<AddrVarExprP>(expr)) {
+                auto addrSubVar = dynamic_cast<SubscriptableVariableValP>(addrVar->addressable);
+                std::string index = addrSubVar ? "[" + valueOf(addrSubVar->index) + "]" : "";
+
+                // The address of a pointer's element depends on its value, the address of a local on its scope
+                if (addrVar->addressable->var.ptrType) return "&" + varValue(addrVar->addressable->var) + index;
+
+                return "&" + addrVar->addressable->var.name + "#" + std::to_string(scopeVersion) + index;
+            } else if (auto addrStr = dynamic_cast<AddrStrExprP>(expr)) {
+                return "\"" + addrStr->value + "\"";
+            } else if (auto binary = dynamic_cast<BinaryExprP>(expr)) {
+                return "(" + valueOf(binary->left) + " " + std::to_string((int) binary->op) + " " +
+                       valueOf(binary->right) + ")";
+            }
+
+            // Function calls return a value of their own
+            return "?" + std::to_string(++valueCount);
+        };
+
+        for (auto it = block.begin; it != block.end; ++it) {
+            ThreeAddressStmtP stmt = *it;
+            FunctionCallExprP call = ILAnalysis::getCall(stmt);
+            auto tempAssignment = dynamic_cast<TempAssignmentTAStmtP>(stmt);
+
+            if (auto functionParamPush = dynamic_cast<FunctionParamPushStmtP>(stmt)) {
+                pushValues[stmt] = valueOf(functionParamPush->expr);
+            } else if (call) {
+                FunctionPurity purity = callPurity(call);
+                std::vector<ILStmtIterator> pushes;
+
+                if (purity == FunctionPurity::sideEffecting) {
+                    memoryVersion++;
+                } else if (tempAssignment &&
+                           collectCallArguments(function, it,
+                                                (int) functionDeclarations[call->functionName]->params.size(),
+                                                pushes)) {
+                    std::string key = call->functionName + "(";
+
+                    for (auto push: pushes) {
+                        key += pushValues[*push] + ",";
+                    }
+
+                    key += ")";
+
+                    // A read-only function may read memory changed since the earlier call
+                    if (purity == FunctionPurity::readOnly) key += "@" + std::to_string(memoryVersion);
+
+                    auto earlier = calls.find(key);
+
+                    if (earlier != calls.end() && tempValues[earlier->second.first] == earlier->second.second) {
+                        for (auto push: pushes) {
+                            delete *push;
+                            function.stmts.erase(push);
+                        }
+
+                        delete tempAssignment->expr;
+                        tempAssignment->expr = new UniTemp(earlier->second.first);
+                        tempValues[tempAssignment->id] = earlier->second.second;
+                        merged = true;
+                        continue;
+                    }
+
+                    tempValues[tempAssignment->id] = "?" + std::to_string(++valueCount);
+                    calls[key] = {tempAssignment->id, tempValues[tempAssignment->id]};
+                    continue;
+                }
+            } else if (auto assigned = ILAnalysis::assignedVariable(stmt)) {
+                if (dynamic_cast<SubscriptableVariableValP>(assigned)) {
+                    memoryVersion++;
+                } else {
+                    varVersions[assigned->var.name] = ++valueCount;
+
+                    if (addressTaken.contains(assigned->var.name)) memoryVersion++;
+                }
+            } else if (dynamic_cast<VectorStoreStmtP>(stmt)) {
+                memoryVersion++;
+            } else if (dynamic_cast<ScopeEnterStmtP>(stmt) || dynamic_cast<ScopeExitStmtP>(stmt)) {
+                // Entering or leaving a scope may shadow a variable or reveal the one it shadowed
+                scopeVersion = ++valueCount;
+                varVersions.clear();
+            }
+
+            int defined = ILAnalysis::definedTemp(stmt);
+
+            if (defined != -1) {
+                tempValues[defined] = tempAssignment ? valueOf(tempAssignment->expr)
+                                                     : "?" + std::to_string(++valueCount);
+            }
+        }
+    }
+
+    return merged;
+}
+
+bool ILOptimizer::removeDeadCalls(ILFunction &function) {
+    ControlFlowGraph cfg(function.stmts);
+    std::vector<ILStmtIterator> deadCalls;
+
+    cfg.computeTempLiveness();
+
+    for (const BasicBlock &block: cfg.blocks) {
+        std::unordered_set<int> live = cfg.tempLiveOut[block.id];
+        std::vector<ILStmtIterator> blockStmts;
+
+        for (auto it = block.begin; it != block.end; ++it) {
+            blockStmts.push_back(it);
+        }
+
+        for (auto it = blockStmts.rbegin(); it != blockStmts.rend(); ++it) {
+            FunctionCallExprP call = ILAnalysis::getCall(**it);
+            int defined = ILAnalysis::definedTemp(**it);
+
+            if (call && callPurity(call) != FunctionPurity::sideEffecting &&
+                (defined == -1 || !live.contains(defined))) {
+                deadCalls.push_back(*it);
+            }
+
+            if (defined != -1) live.erase(defined);
+
+            for (auto temp: ILAnalysis::usedTemps(**it)) {
+                live.insert(temp->id);
+            }
+        }
+    }
+
+    bool removed = false;
+
+    for (auto call: deadCalls) {
+        const std::string &name = ILAnalysis::getCall(*call)->functionName;
+        std::vector<ILStmtIterator> pushes;
+
+        if (!collectCallArguments(function, call, (int) functionDeclarations[name]->params.size(), pushes)) {
+            continue;
+        }
+
+        for (auto push: pushes) {
+            delete *push;
+            function.stmts.erase(push);
+        }
+
+        delete *call;
+        function.stmts.erase(call);
+        removed = true;
+    }
+
+    return removed;
+}
+
+bool ILOptimizer::isInvariantCall(ILFunction &function, ILStmtIterator call, const LoopEffects &effects,
+                                  const std::unordered_set<std::string> &addressTaken, bool alwaysExecuted,
+                                  std::vector<ILStmtIterator> &pushes) const {
+    FunctionCallExprP functionCall = ILAnalysis::getCall(*call);
+    FunctionPurity purity = callPurity(functionCall);
+
+    if (purity == FunctionPurity::sideEffecting) return false;
+
+    // A read-only function may read any array or any variable whose address was taken
+    if (purity == FunctionPurity::readOnly && (effects.aliasedWrite || !effects.storedArrays.empty())) return false;
+
+    if (!alwaysExecuted && functionEffects.at(functionCall->functionName).mayNotReturn) return false;
+
+    auto paramCount = (int) functionDeclarations.at(functionCall->functionName)->params.size();
+
+    if (!collectCallArguments(function, call, paramCount, pushes)) return false;
+
+    return std::all_of(pushes.begin(), pushes.end(), [&](ILStmtIterator push) {
+        ThreeAddressExprP expr = dynamic_cast<FunctionParamPushStmtP>(*push)->expr;
+
+        return isLoopInvariant(expr, effects, addressTaken) && (alwaysExecuted || !mayTrap(expr));
+    });
+}
@@ -0,0 +1,626 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#include "ilOptimizer.h"
+
+namespace {
+    // The bounds a widened range grows to, so loop variables still fit their types
+    const std::vector<long long> WIDENING_BOUNDS = {LLONG_MIN, INT_MIN, SCHAR_MIN, -1, 0, SCHAR_MAX, INT_MAX,
+                                                   LLONG_MAX};
+
+    const ValueRange INT_RANGE(INT_MIN, INT_MAX);
+
+    // Joins the ranges of two paths meeting, a value without a range on either path has none after
+    RangeState joinStates(const RangeState &a, const RangeState &b) {
+        if (!a.reached) return b;
+        if (!b.reached) return a;
+
+        RangeState joined;
+        joined.reached = true;
+
+        for (const auto &[id, range]: a.temps) {
+            auto other = b.temps.find(id);
+
+            if (other != b.temps.end()) joined.temps[id] = range.join(other->second);
+        }
+
+        for (const auto &[name, range]: a.vars) {
+            auto other = b.vars.find(name);
+
+            if (other != b.vars.end()) joined.vars[name] = range.join(other->second);
+        }
+
+        if (a.returned && b.returned) joined.returned = a.returned->join(*b.returned);
+
+        return joined;
+    }
+
+    // Grows the ranges that grew since the previous pass to the next widening bound
+    template<typename Key>
+    void widenRanges(const std::unordered_map<Key, ValueRange> &previous, std::unordered_map<Key, ValueRange> &next) {
+        for (auto it = next.begin(); it != next.end();) {
+            auto old = previous.find(it->first);
+
+            if (old == previous.end()) {
+                it = next.erase(it);
+                continue;
+            }
+
+            ValueRange &range = it->second;
+
+            if (range.min < old->second.min) {
+                range.min = *std::prev(std::upper_bound(WIDENING_BOUNDS.begin(), WIDENING_BOUNDS.end(), range.min));
+            }
+
+            if (range.max > old->second.max) {
+                range.max = *std::lower_bound(WIDENING_BOUNDS.begin(), WIDENING_BOUNDS.end(), range.max);
+            }
+
+            ++it;
+        }
+    }
+}
+
+bool ILOptimizer::analyzeValueRanges(ILFunction &function) {
+    ControlFlowGraph cfg(function.stmts);
+    std::unordered_set<std::string> addressTaken = ILAnalysis::addressTakenVariables(function.stmts);
+    std::unordered_map<std::string, int> declarations;
+    std::unordered_set<std::string> tracked;
+
+    // Only scalars declared once are tracked, a shadowing declaration would hide the outer variable's range
+    std::vector<Variable> declared = function.declaration->params;
+
+    for (auto stmt: function.stmts) {
+        if (auto scopeEnter = dynamic_cast<ScopeEnterStmtP>(stmt)) {
+            declared.insert(declared.end(), scopeEnter->vars.begin(), scopeEnter->vars.end());
+        }
+    }
+
+    for (const auto &var: declared) {
+        declarations[var.name]++;
+    }
+
+    for (const auto &var: declared) {
+        if (declarations[var.name] == 1 && !var.ptrType && var.arrSize == 0 && !addressTaken.contains(var.name)) {
+            tracked.insert(var.name);
+        }
+    }
+
+    size_t blockCount = cfg.blocks.size();
+    std::vector<RangeState> in(blockCount), out(blockCount);
+    std::vector<int> changes(blockCount, 0);
+
+    // The ranges entering a block, from the ranges leaving its predecessors narrowed by the conditions of the edges
+    auto entryState = [&](const BasicBlock &block) {
+        RangeState state;
+
+        if (block.id == 0) state.reached = true;
+
+        for (int predecessor: block.predecessors) {
+            const BasicBlock &from = cfg.blocks[predecessor];
+            RangeState edge = out[predecessor];
+            ThreeAddressStmtP last = from.lastStmt();
+
+            if (edge.reached && from.successors.size() == 2 &&
+                (dynamic_cast<GotoIfZeroStmtP>(last) || dynamic_cast<GotoIfNotZeroStmtP>(last))) {
+                refineByCondition(from, from.successors[0] == block.id, edge, tracked);
+            }
+
+            state = joinStates(state, edge);
+        }
+
+        return state;
+    };
+
+    auto transferBlock = [&](const BasicBlock &block) {
+        RangeState state = in[block.id];
+
+        if (state.reached) {
+            for (auto it = block.begin; it != block.end; ++it) {
+                transferRanges(*it, it != block.begin ? *std::prev(it) : nullptr, state, tracked);
+            }
+        }
+
+        out[block.id] = std::move(state);
+    };
+
+    // Grow the ranges until they stop changing, widening the ones that keep growing around loops
+    bool changed = true;
+    int passes = 0;
+
+    while (changed) {
+        if (++passes > RANGE_PASS_LIMIT) return false;
+
+        changed = false;
+
+        for (const BasicBlock &block: cfg.blocks) {
+            RangeState state = entryState(block);
+
+            if (changes[block.id] > RANGE_WIDEN_PASSES && in[block.id].reached) {
+                widenRanges(in[block.id].temps, state.temps);
+                widenRanges(in[block.id].vars, state.vars);
+
+                if (state.returned && (!in[block.id].returned || !state.returned->within(*in[block.id].returned))) {
+                    state.returned.reset();
+                }
+            }
+
+            if (state == in[block.id]) continue;
+
+            changes[block.id]++;
+            in[block.id] = std::move(state);
+            transferBlock(block);
+            changed = true;
+        }
+    }
+
+    // Recompute the ranges without widening, which takes back what the widening went past the loops' bounds
+    for (int pass = 0; pass < RANGE_NARROW_PASSES; ++pass) {
+        for (const BasicBlock &block: cfg.blocks) {
+            in[block.id] = entryState(block);
+            transferBlock(block);
+        }
+    }
+
+    bool folded = false;
+    std::optional<ValueRange> returnRange;
+
+    for (const BasicBlock &block: cfg.blocks) {
+        RangeState state = in[block.id];
+
+        if (!state.reached) continue;
+
+        for (auto it = block.begin; it != block.end; ++it) {
+            ThreeAddressStmtP stmt = *it;
+            auto tempAssignment = dynamic_cast<TempAssignmentTAStmtP>(stmt);
+            auto binary = tempAssignment ? dynamic_cast<BinaryExprP>(tempAssignment->expr) : nullptr;
+            auto call = tempAssignment ? dynamic_cast<FunctionCallExprP>(tempAssignment->expr) : nullptr;
+            auto logicalNot = tempAssignment ? dynamic_cast<LogicalNotExprP>(tempAssignment->expr) : nullptr;
+
+            if (binary && (binary->op == ExprOperator::div || binary->op == ExprOperator::mod)) {
+                ValueRange left = exprRange(binary->left, state, tracked);
+                ValueRange right = exprRange(binary->right, state, tracked);
+                ValueRange result = binaryRange(binary->op, left, right);
+
+                binary->nonNegative = left.min >= 0 && right.min >= 0;
+                binary->narrow = left.within(INT_RANGE) && right.within(INT_RANGE) && result.within(INT_RANGE);
+            } else if (binary && (binary->op == ExprOperator::add || binary->op == ExprOperator::sub ||
+                                  binary->op == ExprOperator::mult)) {
+                ValueRange result = exprRange(binary, state, tracked);
+
+                binary->narrowResult = result.within(ValueRange(0, INT_MAX));
+            } else if ((binary && binary->op != ExprOperator::add && binary->op != ExprOperator::sub &&
+                        binary->op != ExprOperator::mult) || logicalNot) {
+                // A comparison or a logical operator whose result is known
+                ValueRange result = exprRange(tempAssignment->expr, state, tracked);
+
+                if (result.min == result.max) {
+                    delete tempAssignment->expr;
+                    tempAssignment->expr = new ImIntVal(std::to_string(result.min));
+                    folded = true;
+                }
+            } else if (call && !call->retPtr && returnRanges.contains(call->functionName)) {
+                call->retExtended = returnRanges[call->functionName].within(typeRange(call->retType, false));
+            } else if (dynamic_cast<FunctionExitStmtP>(stmt)) {
+                returnRange = state.returned ? *state.returned : ValueRange();
+            }
+
+            // The reads of variables known to be non-negative may zero extend them
+            std::vector<VariableValP> scalarReads;
+            std::vector<SubscriptableVariableValP> elementReads;
+
+            ILAnalysis::collectStmtReads(stmt, scalarReads, elementReads);
+
+            for (auto read: scalarReads) {
+                if (!dynamic_cast<SubscriptableVariableValP>(read) && tracked.contains(read->var.name)) {
+                    read->nonNegative = exprRange(read, state, tracked).min >= 0;
+                }
+            }
+
+            auto gotoIfZeroStmt = dynamic_cast<GotoIfZeroStmtP>(stmt);
+            auto gotoIfNotZeroStmt = dynamic_cast<GotoIfNotZeroStmtP>(stmt);
+
+            if (gotoIfZeroStmt || gotoIfNotZeroStmt) {
+                UniExpr *&condition = gotoIfZeroStmt ? gotoIfZeroStmt->expr : gotoIfNotZeroStmt->expr;
+                ValueRange range = exprRange(condition, state, tracked);
+                bool known = range.min == range.max || range.min > 0 || range.max < 0;
+
+                if (known && !dynamic_cast<ImIntValP>(condition)) {
+                    delete condition;
+                    condition = new ImIntVal(range.min == 0 && range.max == 0 ? "0" : "1");
+                    folded = true;
+                }
+            }
+
+            transferRanges(stmt, it != block.begin ? *std::prev(it) : nullptr, state, tracked);
+        }
+    }
+
+    if (returnRange && function.declaration->retType != VariableType::voidType) {
+        returnRanges[function.declaration->name] = *returnRange;
+    }
+
+    if (folded && foldConstants(function)) {
+        while (removeUnreachableCode(function));
+        while (removeDeadTemps(function));
+    }
+
+    return folded;
+}
+
+ValueRange ILOptimizer::exprRange(ThreeAddressExprP expr, const RangeState &state,
+                                  const std::unordered_set<std::string> &tracked) const {
+    if (auto imInt = dynamic_cast<ImIntValP>(expr)) {
+        long long value = std::stoll(imInt->value);
+
+        return {value, value};
+    } else if (auto temp = dynamic_cast<UniTempP>(expr)) {
+        auto range = state.temps.find(temp->id);
+
+        return range != state.temps.end() ? range->second : ValueRange();
+    } else if (auto subVar = dynamic_cast<SubscriptableVariableValP>(expr)) {
+        return typeRange(subVar->var.type, false);
+    } else if (auto var = dynamic_cast<VariableValP>(expr)) {
+        auto range = state.vars.find(var->var.name);
+
+        if (tracked.contains(var->var.name) && range != state.vars.end()) return range->second;
+
+        return typeRange(var->var.type, var->var.ptrType);
+    } else if (auto logicalNot = dynamic_cast<LogicalNotExprP>(expr)) {
+        ValueRange operand = exprRange(logicalNot->expr, state, tracked);
+
+        if (operand.min == 0 && operand.max == 0) return {1, 1};
+        if (operand.min > 0 || operand.max < 0) return {0, 0};
+
+        return {0, 1};
+    } else if (auto numericNeg = dynamic_cast<NumericNegExprP>(expr)) {
+        ValueRange operand = exprRange(numericNeg->expr, state, tracked);
+
+        if (operand.min == LLONG_MIN) return {};
+
+        return {-operand.max, -operand.min};
+    } else if (auto binary = dynamic_cast<BinaryExprP>(expr)) {
+        return binaryRange(binary->op, exprRange(binary->left, state, tracked),
+                           exprRange(binary->right, state, tracked));
+    } else if (auto call = dynamic_cast<FunctionCallExprP>(expr)) {
+        // The Generator extends the value from the return type unless the callee's values already fit it
+        ValueRange type = typeRange(call->retType, call->retPtr);
+        auto returned = returnRanges.find(call->functionName);
+
+        if (!call->retPtr && returned != returnRanges.end() && returned->second.within(type)) return returned->second;
+
+        return type;
+    }
+
+    // Addresses
+    return {};
+}
+
+ValueRange ILOptimizer::binaryRange(ExprOperator op, const ValueRange &left, const ValueRange &right) {
+    long long a, b, c, d;
+
+    switch (op) {
+        case ExprOperator::add:
+            if (__builtin_add_overflow(left.min, right.min, &a) || __builtin_add_overflow(left.max, right.max, &b)) {
+                return {};
+            }
+
+            return {a, b};
+        case ExprOperator::sub:
+            if (__builtin_sub_overflow(left.min, right.max, &a) || __builtin_sub_overflow(left.max, right.min, &b)) {
+                return {};
+            }
+
+            return {a, b};
+        case ExprOperator::mult:
+            if (__builtin_mul_overflow(left.min, right.min, &a) || __builtin_mul_overflow(left.min, right.max, &b) ||
+                __builtin_mul_overflow(left.max, right.min, &c) || __builtin_mul_overflow(left.max, right.max, &d)) {
+                return {};
+            }
+
+            return {std::min({a, b, c, d}), std::max({a, b, c, d})};
+        case ExprOperator::div: {
+            // Dividing by zero traps, so only the non-zero divisors count, the quotient is at its extremes at the
+            // extremes of each side of zero
+            std::optional<ValueRange> result;
+
+            for (ValueRange divisor: {ValueRange(right.min, std::min(right.max, -1LL)),
+                                      ValueRange(std::max(right.min, 1LL), right.max)}) {
+                if (divisor.min > divisor.max) continue;
+
+                if (left.min == LLONG_MIN && divisor.min <= -1 && divisor.max >= -1) return {};
+
+                long long quotients[] = {left.min / divisor.min, left.min / divisor.max,
+                                         left.max / divisor.min, left.max / divisor.max};
+                ValueRange range(*std::min_element(std::begin(quotients), std::end(quotients)),
+                                 *std::max_element(std::begin(quotients), std::end(quotients)));
+
+                result = result ? result->join(range) : range;
+            }
+
+            return result ? *result : ValueRange(0, 0);
+        }
+        case ExprOperator::mod: {
+            // The remainder is smaller than the divisor and takes the dividend's sign
+            if (right.min == LLONG_MIN) return {};
+
+            long long bound = std::max(std::abs(right.min), std::abs(right.max));
+
+            if (bound == 0) return {0, 0};
+
+            return {left.min >= 0 ? 0 : std::max(left.min, 1 - bound),
+                    left.max <= 0 ? 0 : std::min(left.max, bound - 1)};
+        }
+        case ExprOperator::logicalOr:
+        case ExprOperator::logicalAnd:
+            return {0, 1};
+        default:
+            break;
+    }
+
+    // Comparisons
+    bool alwaysTrue, alwaysFalse;
+
+    switch (op) {
+        case ExprOperator::equals:
+            alwaysTrue = left.min == left.max && right.min == right.max && left.min == right.min;
+            alwaysFalse = left.max < right.min || left.min > right.max;
+            break;
+        case ExprOperator::notEquals:
+            alwaysTrue = left.max < right.min || left.min > right.max;
+            alwaysFalse = left.min == left.max && right.min == right.max && left.min == right.min;
+            break;
+        case ExprOperator::biggerThan:
+            alwaysTrue = left.min > right.max;
+            alwaysFalse = left.max <= right.min;
+            break;
+        case ExprOperator::biggerThanEquals:
+            alwaysTrue = left.min >= right.max;
+            alwaysFalse = left.max < right.min;
+            break;
+        case ExprOperator::lessThan:
+            alwaysTrue = left.max < right.min;
+            alwaysFalse = left.min >= right.max;
+            break;
+        default:
+            alwaysTrue = left.max <= right.min;
+            alwaysFalse = left.min > right.max;
+            break;
+    }
+
+    if (alwaysTrue) return {1, 1};
+    if (alwaysFalse) return {0, 0};
+
+    return {0, 1};
+}
+
+void ILOptimizer::transferRanges(ThreeAddressStmtP stmt, ThreeAddressStmtP previous, RangeState &state,
+                                 const std::unordered_set<std::string> &tracked) const {
+    if (auto tempAssignment = dynamic_cast<TempAssignmentTAStmtP>(stmt)) {
+        ValueRange range = exprRange(tempAssignment->expr, state, tracked);
+
+        if (range == ValueRange()) {
+            state.temps.erase(tempAssignment->id);
+        } else {
+            state.temps[tempAssignment->id] = range;
+        }
+    } else if (auto varAssignment = dynamic_cast<VarAssignmentTAStmtP>(stmt)) {
+        const Variable &var = varAssignment->var->var;
+
+        if (dynamic_cast<SubscriptableVariableValP>(varAssignment->var) || !tracked.contains(var.name)) return;
+
+        // A value that doesn't fit the variable's type wraps around when stored
+        ValueRange range = exprRange(varAssignment->expr, state, tracked);
+
+        if (range.within(typeRange(var.type, false))) {
+            state.vars[var.name] = range;
+        } else {
+            state.vars.erase(var.name);
+        }
+    } else if (auto setReturnValue = dynamic_cast<SetReturnValueStmtP>(stmt)) {
+        auto returned = dynamic_cast<UniTempP>(setReturnValue->expr);
+        auto result = dynamic_cast<TempAssignmentTAStmtP>(previous);
+        auto call = result ? dynamic_cast<FunctionCallExprP>(result->expr) : nullptr;
+
+        state.returned = exprRange(setReturnValue->expr, state, tracked);
+
+        // A call whose value is returned right away may become a tail call, which leaves the callee's value as is
+        if (returned && call && result->id == returned->id) {
+            auto callee = returnRanges.find(call->functionName);
+
+            state.returned = !call->retPtr && callee != returnRanges.end() ? callee->second : ValueRange();
+        }
+    } else if (auto scopeEnter = dynamic_cast<ScopeEnterStmtP>(stmt)) {
+        for (const auto &var: scopeEnter->vars) {
+            state.vars.erase(var.name);
+        }
+    } else {
+        int defined = ILAnalysis::definedTemp(stmt);
+
+        if (defined != -1) state.temps.erase(defined);
+    }
+}
+
+void ILOptimizer::refineByCondition(const BasicBlock &block, bool taken, RangeState &state,
+                                    const std::unordered_set<std::string> &tracked) const {
+    ThreeAddressStmtP last = block.lastStmt();
+    auto gotoIfZeroStmt = dynamic_cast<GotoIfZeroStmtP>(last);
+    UniExprP condition = gotoIfZeroStmt ? gotoIfZeroStmt->expr : dynamic_cast<GotoIfNotZeroStmtP>(last)->expr;
+    // Whether the condition holds a non-zero value on this edge
+    bool nonZero = taken != (gotoIfZeroStmt != nullptr);
+
+    // Narrows the range of a temporary or a tracked variable, an empty range means the edge is never taken
+    auto narrowRange = [&](UniExprP expr, ValueRange range) {
+        ValueRange current = exprRange(expr, state, tracked);
+        ValueRange narrowed(std::max(current.min, range.min), std::min(current.max, range.max));
+
+        if (narrowed.min > narrowed.max) {
+            state.reached = false;
+            return;
+        }
+
+        if (auto temp = dynamic_cast<UniTempP>(expr)) {
+            state.temps[temp->id] = narrowed;
+        } else if (auto var = dynamic_cast<VariableValP>(expr)) {
+            if (!dynamic_cast<SubscriptableVariableValP>(var) && tracked.contains(var->var.name)) {
+                state.vars[var->var.name] = narrowed;
+            }
+        }
+    };
+
+    // Only a value at the edge of a range can be taken out of it
+    auto excludeValue = [&](UniExprP expr, const ValueRange &range, long long value) {
+        if (range.min == value && range.max == value) {
+            state.reached = false;
+        } else if (range.min == value) {
+            narrowRange(expr, {value + 1, LLONG_MAX});
+        } else if (range.max == value) {
+            narrowRange(expr, {LLONG_MIN, value - 1});
+        }
+    };
+
+    auto narrowZero = [&](UniExprP expr, bool isZero) {
+        if (isZero) {
+            narrowRange(expr, {0, 0});
+        } else {
+            excludeValue(expr, exprRange(expr, state, tracked), 0);
+        }
+    };
+
+    narrowZero(condition, !nonZero);
+
+    auto conditionTemp = dynamic_cast<UniTempP>(condition);
+
+    if (!state.reached || !conditionTemp) return;
+
+    // Find the comparison computing the condition in the block, its operands must keep their values up to the jump
+    auto it = std::prev(block.end);
+    TempAssignmentTAStmtP definition = nullptr;
+    std::unordered_set<int> laterTemps;
+    std::unordered_set<std::string> laterVars;
+
+    while (it != block.begin) {
+        --it;
+
+        auto tempAssignment = dynamic_cast<TempAssignmentTAStmtP>(*it);
+
+        if (tempAssignment && tempAssignment->id == conditionTemp->id) {
+            definition = tempAssignment;
+            break;
+        }
+
+        int defined = ILAnalysis::definedTemp(*it);
+        VariableValP assigned = ILAnalysis::assignedVariable(*it);
+
+        if (defined != -1) laterTemps.insert(defined);
+        if (assigned) laterVars.insert(assigned->var.name);
+        if (defined == conditionTemp->id || dynamic_cast<ScopeEnterStmtP>(*it)) return;
+    }
+
+    auto keepsValue = [&](UniExprP expr) {
+        if (auto temp = dynamic_cast<UniTempP>(expr)) return temp->id != conditionTemp->id &&
+                                                              !laterTemps.contains(temp->id);
+        if (auto var = dynamic_cast<VariableValP>(expr)) return !dynamic_cast<SubscriptableVariableValP>(var) &&
+                                                                !laterVars.contains(var->var.name);
+
+        return dynamic_cast<ImIntValP>(expr) != nullptr;
+    };
+
+    if (!definition) return;
+
+    if (auto logicalNot = dynamic_cast<LogicalNotExprP>(definition->expr)) {
+        if (keepsValue(logicalNot->expr)) narrowZero(logicalNot->expr, nonZero);
+        return;
+    }
+
+    auto binary = dynamic_cast<BinaryExprP>(definition->expr);
+
+    if (!binary || !keepsValue(binary->left) || !keepsValue(binary->right)) return;
+
+    if (binary->op == ExprOperator::logicalAnd && nonZero) {
+        narrowZero(binary->left, false);
+        narrowZero(binary->right, false);
+        return;
+    }
+
+    if (binary->op == ExprOperator::logicalOr && !nonZero) {
+        narrowZero(binary->left, true);
+        narrowZero(binary->right, true);
+        return;
+    }
+
+    // The comparison holding on this edge, as 'left op right'
+    ExprOperator op = binary->op;
+
+    if (!nonZero) {
+        static const std::unordered_map<ExprOperator, ExprOperator> negations = {
+                {ExprOperator::equals,           ExprOperator::notEquals},
+                {ExprOperator::notEquals,        ExprOperator::equals},
+                {ExprOperator::biggerThan,       ExprOperator::lessThanEquals},
+                {ExprOperator::biggerThanEquals, ExprOperator::lessThan},
+                {ExprOperator::lessThan,         ExprOperator::biggerThanEquals},
+                {ExprOperator::lessThanEquals,   ExprOperator::biggerThan},
+        };
+
+        if (!negations.contains(op)) return;
+
+        op = negations.at(op);
+    }
+
+    ValueRange left = exprRange(binary->left, state, tracked);
+    ValueRange right = exprRange(binary->right, state, tracked);
+
+    switch (op) {
+        case ExprOperator::equals:
+            narrowRange(binary->left, right);
+            narrowRange(binary->right, left);
+            break;
+        case ExprOperator::notEquals:
+            // Only a constant on the other side removes a value
+            if (right.min == right.max) excludeValue(binary->left, left, right.min);
+            if (left.min == left.max && state.reached) excludeValue(binary->right, right, left.min);
+            break;
+        case ExprOperator::lessThan:
+            if (right.max == LLONG_MIN || left.min == LLONG_MAX) {
+                state.reached = false;
+                break;
+            }
+
+            narrowRange(binary->left, {LLONG_MIN, right.max - 1});
+            narrowRange(binary->right, {left.min + 1, LLONG_MAX});
+            break;
+        case ExprOperator::lessThanEquals:
+            narrowRange(binary->left, {LLONG_MIN, right.max});
+            narrowRange(binary->right, {left.min, LLONG_MAX});
+            break;
+        case ExprOperator::biggerThan:
+            if (left.max == LLONG_MIN || right.min == LLONG_MAX) {
+                state.reached = false;
+                break;
+            }
+
+            narrowRange(binary->left, {right.min + 1, LLONG_MAX});
+            narrowRange(binary->right, {LLONG_MIN, left.max - 1});
+            break;
+        case ExprOperator::biggerThanEquals:
+            narrowRange(binary->left, {right.min, LLONG_MAX});
+            narrowRange(binary->right, {LLONG_MIN, left.max});
+            break;
+        default:
+            break;
+    }
+}
+
+ValueRange ILOptimizer::typeRange(VariableType type, bool isPtr) {
+    if (isPtr || !typeSizes.contains(type)) return {};
+
+    switch (typeSizes.at(type)) {
+        case 1:
+            return {SCHAR_MIN, SCHAR_MAX};
+        case 4:
+            return INT_RANGE;
+        default:
+            return {};
+    }
+}
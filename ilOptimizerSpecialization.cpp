@@ -0,0 +1,207 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#include "ilOptimizer.h"
+
+void ILOptimizer::specializeFunctions(std::vector<ILFunction> &functions) {
+    std::unordered_map<std::string, ILFunction *> functionsByName;
+
+    for (auto &function: functions) {
+        functionsByName[function.declaration->name] = &function;
+    }
+
+    // A call passing constants for some of the parameters the callee reads, by parameter index
+    struct ConstantCall {
+        ILFunction *caller = nullptr;
+        ILStmtIterator call;
+        std::vector<ILStmtIterator> pushes{};
+        std::map<int, long long> constants{};
+    };
+
+    std::map<std::string, std::vector<ConstantCall>> constantCalls;
+    // Number of calls of each function and the weight of each set of constants, calls in loops weigh more
+    std::unordered_map<std::string, int> callCounts;
+    std::unordered_map<std::string, std::map<std::map<int, long long>, int>> weights;
+
+    for (auto &caller: functions) {
+        ControlFlowGraph cfg(caller.stmts);
+        std::unordered_set<ThreeAddressStmtP> loopStmts;
+
+        for (const auto &loop: cfg.findLoops()) {
+            for (int block: loop.blocks) {
+                for (auto it = cfg.blocks[block].begin; it != cfg.blocks[block].end; ++it) {
+                    loopStmts.insert(*it);
+                }
+            }
+        }
+
+        for (auto it = caller.stmts.begin(); it != caller.stmts.end(); ++it) {
+            FunctionCallExprP call = ILAnalysis::getCall(*it);
+
+            if (!call || !functionsByName.contains(call->functionName)) continue;
+
+            ILFunction *callee = functionsByName[call->functionName];
+            const std::vector<Variable> &params = callee->declaration->params;
+            ConstantCall constantCall{&caller, it};
+
+            callCounts[call->functionName]++;
+
+            if (!collectCallArguments(caller, it, (int) params.size(), constantCall.pushes)) continue;
+
+            for (size_t i = 0; i < params.size(); ++i) {
+                auto push = dynamic_cast<FunctionParamPushStmtP>(*constantCall.pushes[i]);
+                auto imInt = dynamic_cast<ImIntValP>(push->expr);
+
+                if (!imInt || params[i].ptrType) continue;
+
+                bool read = std::any_of(callee->stmts.begin(), callee->stmts.end(), [&](ThreeAddressStmtP stmt) {
+                    return ILAnalysis::readsVariable(stmt, params[i].name);
+                });
+
+                if (read) constantCall.constants[(int) i] = truncateToType(std::stoll(imInt->value), params[i].type);
+            }
+
+            if (constantCall.constants.empty()) continue;
+
+            weights[call->functionName][constantCall.constants] += loopStmts.contains(*it) ? SPECIALIZE_LOOP_WEIGHT : 1;
+            constantCalls[call->functionName].push_back(std::move(constantCall));
+        }
+    }
+
+    std::vector<ILFunction> clones;
+    int specializationCount = 0;
+
+    for (auto &[calleeName, calls]: constantCalls) {
+        ILFunction *callee = functionsByName[calleeName];
+
+        if (calleeName == "main" || !functionEndLabel(*callee) || inlineSize(*callee) > SPECIALIZE_SIZE_LIMIT) {
+            continue;
+        }
+
+        // The hottest sets of constants get a clone, a set passed by every call is cloned as the original is
+        // then removed
+        std::vector<std::pair<std::map<int, long long>, int>> ranked(weights[calleeName].begin(),
+                                                                     weights[calleeName].end());
+
+        std::stable_sort(ranked.begin(), ranked.end(), [](const auto &a, const auto &b) {
+            return a.second > b.second;
+        });
+
+        std::map<std::map<int, long long>, std::string> cloneNames;
+
+        for (const auto &[constants, weight]: ranked) {
+            if ((int) cloneNames.size() == MAX_SPECIALIZATIONS) break;
+
+            bool everyCall = ranked.size() == 1 && (int) calls.size() == callCounts[calleeName];
+
+            if (weight < SPECIALIZE_MIN_WEIGHT && !everyCall) continue;
+
+            std::string suffix = ".sp" + std::to_string(++specializationCount);
+
+            clones.push_back(specializeFunction(*callee, constants, suffix));
+            cloneNames[constants] = calleeName + suffix;
+        }
+
+        // Redirect the calls to the clones, the pushes of the constants are no longer needed
+        for (auto &constantCall: calls) {
+            if (!cloneNames.contains(constantCall.constants)) continue;
+
+            for (const auto &[index, value]: constantCall.constants) {
+                delete *constantCall.pushes[index];
+                constantCall.caller->stmts.erase(constantCall.pushes[index]);
+            }
+
+            FunctionCallExprP call = ILAnalysis::getCall(*constantCall.call);
+
+            call->functionName = cloneNames[constantCall.constants];
+            call->paramCount -= (int) constantCall.constants.size();
+        }
+    }
+
+    for (auto &clone: clones) {
+        functions.push_back(std::move(clone));
+    }
+}
+
+ILFunction ILOptimizer::specializeFunction(const ILFunction &function, const std::map<int, long long> &constants,
+                                           const std::string &suffix) {
+    auto declaration = dynamic_cast<FunctionDeclarationStmtP>(ILAnalysis::cloneStmt(function.declaration));
+    std::vector<Variable> constantParams;
+
+    declaration->name += suffix;
+    declaration->params.clear();
+
+    for (size_t i = 0; i < function.declaration->params.size(); ++i) {
+        const Variable &param = function.declaration->params[i];
+
+        if (constants.contains((int) i)) {
+            constantParams.push_back(param);
+        } else {
+            declaration->params.push_back(param);
+        }
+    }
+
+    ILFunction clone(declaration);
+
+    clone.stmts.push_back(declaration);
+
+    // Copy the body with the labels renamed, the calls to the function itself still call the original
+    for (auto it = std::next(function.stmts.begin()); it != function.stmts.end(); ++it) {
+        ThreeAddressStmtP stmt = ILAnalysis::cloneStmt(*it);
+
+        if (auto labelStmt = dynamic_cast<LabelStmtP>(stmt)) {
+            labelStmt->labelName += suffix;
+        } else if (ILAnalysis::isJump(stmt)) {
+            ILAnalysis::setJumpTarget(stmt, ILAnalysis::jumpTarget(stmt) + suffix);
+        }
+
+        clone.stmts.push_back(stmt);
+    }
+
+    std::unordered_set<std::string> addressTaken = ILAnalysis::addressTakenVariables(clone.stmts);
+    auto functionScope = dynamic_cast<ScopeEnterStmtP>(*std::next(clone.stmts.begin()));
+    auto bodyStart = std::next(clone.stmts.begin(), 2);
+    size_t constantIndex = 0;
+
+    for (const auto &[index, value]: constants) {
+        const Variable &param = constantParams[constantIndex++];
+        bool assigned = addressTaken.contains(param.name) ||
+                        std::any_of(clone.stmts.begin(), clone.stmts.end(), [&](ThreeAddressStmtP stmt) {
+                            VariableValP var = ILAnalysis::assignedVariable(stmt);
+
+                            return var && var->var.name == param.name;
+                        });
+
+        if (assigned) {
+            // A parameter the function changes becomes a variable of the function's scope starting at the constant
+            functionScope->vars.push_back(param);
+            clone.stmts.insert(bodyStart, new VarAssignmentTAStmt(new VariableVal(param),
+                                                                  new ImIntVal(std::to_string(value))));
+        } else {
+            for (auto stmt: clone.stmts) {
+                ILAnalysis::replaceVariableReads(stmt, param.name, [value = value]() {
+                    return new ImIntVal(std::to_string(value));
+                });
+            }
+        }
+    }
+
+    if (foldConstants(clone)) {
+        while (removeUnreachableCode(clone));
+        while (removeDeadTemps(clone));
+    }
+
+    return clone;
+}
+
+long long ILOptimizer::truncateToType(long long value, VariableType type) {
+    switch (typeSizes.at(type)) {
+        case 1:
+            return (signed char) value;
+        case 4:
+            return (int) value;
+        default:
+            return value;
+    }
+}
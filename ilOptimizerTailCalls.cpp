@@ -0,0 +1,189 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#include "ilOptimizer.h"
+
+bool ILOptimizer::eliminateTailRecursion(ILFunction &function) {
+    auto &stmts = function.stmts;
+    LabelStmtP endLabel = functionEndLabel(function);
+
+    if (!endLabel || hasFrameAddresses(function)) return false;
+
+    const std::vector<Variable> &params = function.declaration->params;
+    std::string loopLabel = function.declaration->name + "TailCall";
+    std::vector<int> argTemps;
+    bool eliminated = false;
+
+    // The loop starts inside the function's scope, a call jumping back to it can't be inside a scope with variables
+    std::vector<bool> scopeHasVars;
+    int varScopes = 0;
+
+    for (auto it = std::next(stmts.begin(), 2); it != std::prev(stmts.end(), 3);) {
+        if (auto scopeEnter = dynamic_cast<ScopeEnterStmtP>(*it)) {
+            scopeHasVars.push_back(!scopeEnter->vars.empty());
+            varScopes += scopeHasVars.back();
+        } else if (dynamic_cast<ScopeExitStmtP>(*it)) {
+            varScopes -= scopeHasVars.back();
+            scopeHasVars.pop_back();
+        }
+
+        FunctionCallExprP call = ILAnalysis::getCall(*it);
+        ILStmtIterator setReturn, exitJump;
+        std::vector<ILStmtIterator> pushes;
+
+        if (!call || call->functionName != function.declaration->name || varScopes > 0 ||
+            !findTailCall(function, it, endLabel->labelName, setReturn, exitJump) ||
+            !collectCallArguments(function, it, (int) params.size(), pushes)) {
+            ++it;
+            continue;
+        }
+
+        if (argTemps.size() != params.size()) {
+            for (size_t i = 0; i < params.size(); ++i) {
+                argTemps.push_back(function.newTemp());
+            }
+        }
+
+        // The arguments may read the parameters they replace, so all of them are computed before the assignments
+        for (size_t i = 0; i < pushes.size(); ++i) {
+            auto push = dynamic_cast<FunctionParamPushStmtP>(*pushes[i]);
+
+            *pushes[i] = new TempAssignmentTAStmt(argTemps[i], push->expr);
+            push->expr = nullptr;
+            delete push;
+        }
+
+        for (size_t i = 0; i < params.size(); ++i) {
+            stmts.insert(it, new VarAssignmentTAStmt(new VariableVal(params[i]), new UniTemp(argTemps[i])));
+        }
+
+        stmts.insert(it, new GotoStmt(loopLabel));
+
+        // Remove the call and the return of its value
+        auto after = std::next(exitJump != stmts.end() ? exitJump : setReturn != stmts.end() ? setReturn : it);
+
+        while (it != after) {
+            delete *it;
+            it = stmts.erase(it);
+        }
+
+        eliminated = true;
+    }
+
+    if (eliminated) stmts.insert(std::next(stmts.begin(), 2), new LabelStmt(loopLabel));
+
+    return eliminated;
+}
+
+bool ILOptimizer::markTailCalls(ILFunction &function) {
+    auto &stmts = function.stmts;
+    LabelStmtP endLabel = functionEndLabel(function);
+
+    // A memoized function stores its result at its exit
+    if (!endLabel || hasFrameAddresses(function) || function.declaration->memoRange > 0) return false;
+
+    // The upper halves of the ymm registers are only cleared at the function exit
+    for (auto stmt: stmts) {
+        auto vectorStmt = dynamic_cast<VectorStmtP>(stmt);
+
+        if (vectorStmt && vectorStmt->width == AVX_VECTOR_WIDTH) return false;
+    }
+
+    int paramsSize = FrameLayout::paramsSize(function.declaration);
+    int returnSize = returnValueSize(function.declaration);
+    bool marked = false;
+
+    for (auto it = std::next(stmts.begin()); it != std::prev(stmts.end(), 3); ++it) {
+        FunctionCallExprP call = ILAnalysis::getCall(*it);
+
+        if (!call || !functionDeclarations.contains(call->functionName)) continue;
+
+        // The called function pops the parameters for the caller, so they must take the same space, and it
+        // must leave a return value at least as wide as the one the caller extends
+        FunctionDeclarationStmtP callee = functionDeclarations[call->functionName];
+        auto result = dynamic_cast<TempAssignmentTAStmtP>(*it);
+        ILStmtIterator setReturn, exitJump;
+        std::vector<ILStmtIterator> pushes;
+
+        if (FrameLayout::paramsSize(callee) != paramsSize || (result && returnValueSize(callee) < returnSize) ||
+            !findTailCall(function, it, endLabel->labelName, setReturn, exitJump) ||
+            !collectCallArguments(function, it, (int) callee->params.size(), pushes)) {
+            continue;
+        }
+
+        if (result) {
+            result->expr = nullptr;
+            delete result;
+            *it = call;
+        }
+
+        if (setReturn != stmts.end()) {
+            delete *setReturn;
+            stmts.erase(setReturn);
+        }
+
+        call->tailCall = true;
+        marked = true;
+    }
+
+    return marked;
+}
+
+bool ILOptimizer::findTailCall(ILFunction &function, ILStmtIterator call, const std::string &endLabel,
+                               ILStmtIterator &setReturn, ILStmtIterator &exitJump) {
+    auto next = std::next(call);
+    auto result = dynamic_cast<TempAssignmentTAStmtP>(*call);
+
+    setReturn = function.stmts.end();
+    exitJump = function.stmts.end();
+
+    if (result) {
+        auto setReturnValue = dynamic_cast<SetReturnValueStmtP>(*next);
+        auto returned = setReturnValue ? dynamic_cast<UniTempP>(setReturnValue->expr) : nullptr;
+
+        if (!returned || returned->id != result->id) return false;
+
+        setReturn = next++;
+    }
+
+    // Labels and the exits of the scopes around the call do nothing once the call returns to the function's end
+    auto functionScopeExit = std::prev(function.stmts.end(), 3);
+    bool adjacent = true;
+
+    while (next != functionScopeExit && (dynamic_cast<LabelStmtP>(*next) || dynamic_cast<ScopeExitStmtP>(*next))) {
+        ++next;
+        adjacent = false;
+    }
+
+    if (next == functionScopeExit) return true;
+
+    auto gotoStmt = dynamic_cast<GotoStmtP>(*next);
+
+    if (!gotoStmt || gotoStmt->labelName != endLabel) return false;
+
+    // A jump after a label may be reached from other paths, only the jump right after the call belongs to it
+    if (adjacent) exitJump = next;
+
+    return true;
+}
+
+bool ILOptimizer::hasFrameAddresses(const ILFunction &function) {
+    if (!ILAnalysis::addressTakenVariables(function.stmts).empty()) return true;
+
+    for (auto stmt: function.stmts) {
+        if (auto scopeEnter = dynamic_cast<ScopeEnterStmtP>(stmt)) {
+            for (const auto &var: scopeEnter->vars) {
+                if (var.arrSize > 0) return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+int ILOptimizer::returnValueSize(FunctionDeclarationStmtP declaration) {
+    if (declaration->retPtr) return typeSizes.at(VariableType::longType);
+
+    return declaration->retType == VariableType::voidType ? 0 : typeSizes.at(declaration->retType);
+}
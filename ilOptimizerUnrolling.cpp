@@ -0,0 +1,458 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#include "ilOptimizer.h"
+
+bool ILOptimizer::findCountedLoop(const ControlFlowGraph &cfg, const NaturalLoop &loop,
+                                  const std::unordered_set<std::string> &addressTaken, CountedLoop &counted) {
+    // A single back edge and a single way out of the loop, through the test at the bottom
+    if (loop.preheader == -1 || loop.latches.size() != 1 || loop.exitingBlocks.size() != 1) return false;
+
+    const BasicBlock &latch = cfg.blocks[loop.latches.front()];
+    const BasicBlock &test = cfg.blocks[loop.exitingBlocks.front()];
+    auto testJump = dynamic_cast<GotoIfNotZeroStmtP>(test.lastStmt());
+    auto conditionLabel = dynamic_cast<LabelStmtP>(*test.begin);
+
+    // The test block only compares, so its copies in an unrolled loop have no effect
+    if (!testJump || !conditionLabel || std::distance(test.begin, test.end) != 3) return false;
+
+    int firstBlock = cfg.blockByLabel(testJump->labelName);
+
+    // A do-while loop is entered at its first block and jumps back from the test, a while loop
+    // is entered at the test and jumps back to it from the end of the body
+    if (firstBlock == -1 || (!(loop.header == firstBlock && latch.id == test.id) &&
+                             !(loop.header == test.id && firstBlock != test.id))) {
+        return false;
+    }
+
+    counted.begin = cfg.blocks[firstBlock].begin;
+    counted.testJump = std::prev(test.end);
+    counted.conditionLabel = conditionLabel->labelName;
+    counted.topTest = loop.header == test.id;
+
+    // The bottom test must test a comparison of a plain variable with a loop-invariant bound
+    auto comparisonAssignment = dynamic_cast<TempAssignmentTAStmtP>(*std::prev(counted.testJump));
+    auto testedTemp = dynamic_cast<UniTempP>(testJump->expr);
+
+    if (!comparisonAssignment || !testedTemp || comparisonAssignment->id != testedTemp->id) return false;
+
+    auto comparison = dynamic_cast<BinaryExprP>(comparisonAssignment->expr);
+
+    if (!comparison || comparison->op < ExprOperator::equals || comparison->op > ExprOperator::lessThanEquals) {
+        return false;
+    }
+
+    auto isPlainVariable = [](UniExprP expr) {
+        auto var = dynamic_cast<VariableValP>(expr);
+
+        return var && !dynamic_cast<SubscriptableVariableValP>(var) && !var->var.ptrType && var->var.arrSize == 0;
+    };
+
+    LoopEffects effects = collectLoopEffects(cfg, loop, addressTaken);
+
+    // With a variable on both sides, the induction variable is the one the loop assigns
+    counted.comparison = comparison;
+    counted.inductionOnLeft = isPlainVariable(comparison->left) &&
+                              !(isPlainVariable(comparison->right) &&
+                                !effects.assignedVars.contains(dynamic_cast<VariableValP>(comparison->left)->var.name));
+
+    if (!counted.inductionOnLeft && !isPlainVariable(comparison->right)) return false;
+
+    UniExprP inductionSide = counted.inductionOnLeft ? comparison->left : comparison->right;
+    UniExprP bound = counted.inductionOnLeft ? comparison->right : comparison->left;
+
+    counted.inductionVar = dynamic_cast<VariableValP>(inductionSide)->var;
+
+    const std::string &name = counted.inductionVar.name;
+
+    // A char wraps around too soon to reason about its values
+    if (counted.inductionVar.type == VariableType::charType || addressTaken.contains(name) ||
+        effects.declaredVars.contains(name) || dynamic_cast<SubscriptableVariableValP>(bound) ||
+        !isLoopInvariant(bound, effects, addressTaken)) {
+        return false;
+    }
+
+    // The variable must be stepped exactly once on every iteration
+    std::vector<InductionStep> steps;
+
+    if (!findInductionSteps(cfg, loop, name, steps) || steps.size() != 1 || steps.front().step == 0) return false;
+
+    counted.step = steps.front().step;
+    counted.stepAssignment = steps.front().assignment;
+
+    for (int blockId: loop.blocks) {
+        const BasicBlock &block = cfg.blocks[blockId];
+
+        for (auto it = block.begin; it != block.end; ++it) {
+            if (it == steps.front().assignment && !cfg.dominates(blockId, latch.id)) return false;
+        }
+    }
+
+    // The loop's statements must be a contiguous run from the first block to the test
+    ILStmtIterator rangeBegin, rangeLast;
+
+    if (!findLoopRange(cfg, loop, rangeBegin, rangeLast) || rangeBegin != counted.begin ||
+        rangeLast != counted.testJump) {
+        return false;
+    }
+
+    std::unordered_set<int> loopTempDefs;
+
+    for (auto it = counted.begin; it != counted.testJump; ++it) {
+        if (!dynamic_cast<LabelStmtP>(*it)) counted.iterationSize++;
+
+        if (ILAnalysis::definedTemp(*it) != -1) loopTempDefs.insert(ILAnalysis::definedTemp(*it));
+    }
+
+    // Temporaries computed by one iteration must not be read by the next one
+    for (int temp: cfg.tempLiveIn[loop.header]) {
+        if (loopTempDefs.contains(temp)) return false;
+    }
+
+    for (int temp: cfg.tempLiveIn[firstBlock]) {
+        if (loopTempDefs.contains(temp)) return false;
+    }
+
+    return true;
+}
+
+bool ILOptimizer::findEntryConstant(const ControlFlowGraph &cfg, const NaturalLoop &loop, const std::string &name,
+                                    long long &value) {
+    std::unordered_set<int> visited;
+
+    for (int blockId = loop.preheader; visited.insert(blockId).second;) {
+        const BasicBlock &block = cfg.blocks[blockId];
+
+        for (auto it = block.end; it != block.begin;) {
+            --it;
+
+            // A declaration starts a new variable with an unknown value
+            if (auto scopeEnter = dynamic_cast<ScopeEnterStmtP>(*it)) {
+                for (const auto &var: scopeEnter->vars) {
+                    if (var.name == name) return false;
+                }
+            }
+
+            auto assigned = ILAnalysis::assignedVariable(*it);
+
+            if (assigned && !dynamic_cast<SubscriptableVariableValP>(assigned) && assigned->var.name == name) {
+                auto imInt = dynamic_cast<ImIntValP>(dynamic_cast<VarAssignmentTAStmtP>(*it)->expr);
+
+                if (!imInt) return false;
+
+                value = std::stoll(imInt->value);
+
+                return true;
+            }
+        }
+
+        if (block.predecessors.size() != 1) return false;
+
+        blockId = block.predecessors.front();
+    }
+
+    return false;
+}
+
+bool ILOptimizer::evaluateCountedCondition(const CountedLoop &counted, long long value, long long bound) {
+    long long left = counted.inductionOnLeft ? value : bound;
+    long long right = counted.inductionOnLeft ? bound : value;
+
+    switch (counted.comparison->op) {
+        case ExprOperator::equals:
+            return left == right;
+        case ExprOperator::notEquals:
+            return left != right;
+        case ExprOperator::biggerThan:
+            return left > right;
+        case ExprOperator::biggerThanEquals:
+            return left >= right;
+        case ExprOperator::lessThan:
+            return left < right;
+        case ExprOperator::lessThanEquals:
+            return left <= right;
+        default:
+            return false;
+    }
+}
+
+std::list<ThreeAddressStmtP> ILOptimizer::copyIteration(const CountedLoop &counted, const std::string &suffix,
+                                                        const std::function<UniExpr *(bool)> &inductionValue) {
+    std::unordered_set<std::string> jumpTargets;
+
+    for (auto it = counted.begin; it != counted.testJump; ++it) {
+        if (ILAnalysis::isJump(*it)) jumpTargets.insert(ILAnalysis::jumpTarget(*it));
+    }
+
+    std::list<ThreeAddressStmtP> copy;
+    bool afterStep = false;
+
+    for (auto it = counted.begin; it != counted.testJump; ++it) {
+        if (it == counted.stepAssignment) {
+            afterStep = true;
+            continue;
+        }
+
+        auto labelStmt = dynamic_cast<LabelStmtP>(*it);
+
+        // Only labels jumped to from inside the iteration are kept, so the copies form as few blocks as possible
+        if (labelStmt && !jumpTargets.contains(labelStmt->labelName)) continue;
+
+        ThreeAddressStmtP stmt = ILAnalysis::cloneStmt(*it);
+
+        if (labelStmt) {
+            dynamic_cast<LabelStmtP>(stmt)->labelName += suffix;
+        } else if (jumpTargets.contains(ILAnalysis::jumpTarget(stmt))) {
+            ILAnalysis::setJumpTarget(stmt, ILAnalysis::jumpTarget(stmt) + suffix);
+        }
+
+        ILAnalysis::replaceVariableReads(stmt, counted.inductionVar.name,
+                                         [&inductionValue, afterStep]() { return inductionValue(afterStep); });
+        copy.push_back(stmt);
+    }
+
+    return copy;
+}
+
+bool ILOptimizer::findUnitStrideLoop(const ControlFlowGraph &cfg, const std::vector<NaturalLoop> &loops,
+                                     const NaturalLoop &loop, const std::unordered_set<std::string> &addressTaken,
+                                     CountedLoop &counted, UniExprP &bound) {
+    for (const auto &other: loops) {
+        if (other.header != loop.header && loop.contains(other.header)) return false;
+    }
+
+    if (!findCountedLoop(cfg, loop, addressTaken, counted) || counted.step != 1) return false;
+
+    // The preheader must lead straight to the loop's first statement, jumping over it to the
+    // bottom test in a while loop
+    const BasicBlock &preheader = cfg.blocks[loop.preheader];
+    auto preheaderJump = dynamic_cast<GotoStmtP>(preheader.lastStmt());
+
+    if (preheader.end != counted.begin ||
+        (counted.topTest != (preheaderJump && preheaderJump->labelName == counted.conditionLabel)) ||
+        (!counted.topTest && ILAnalysis::isJump(preheader.lastStmt()))) {
+        return false;
+    }
+
+    // The test must fail once the variable passes the bound upwards
+    ExprOperator op = counted.comparison->op;
+    bool upwards = counted.inductionOnLeft ? (op == ExprOperator::lessThan || op == ExprOperator::lessThanEquals)
+                                           : (op == ExprOperator::biggerThan || op == ExprOperator::biggerThanEquals);
+
+    bound = counted.inductionOnLeft ? counted.comparison->right : counted.comparison->left;
+
+    // A bound wider than the variable could let it wrap around before reaching the bound
+    auto boundVar = dynamic_cast<VariableValP>(bound);
+    auto boundImInt = dynamic_cast<ImIntValP>(bound);
+    int inductionSize = typeSizes.at(counted.inductionVar.type);
+    long long maxInduction = inductionSize == 8 ? INT64_MAX : inductionSize == 4 ? INT32_MAX : INT8_MAX;
+    bool narrowBound = inductionSize == 8 ||
+                       (boundVar && !boundVar->var.ptrType && typeSizes.at(boundVar->var.type) <= inductionSize) ||
+                       (boundImInt && std::stoll(boundImInt->value) <= maxInduction);
+
+    if (!upwards || !narrowBound) return false;
+
+    // Temporaries of the loop must not be read after it, a replaced loop doesn't compute them
+    std::unordered_set<int> loopTempDefs;
+
+    for (int blockId: loop.blocks) {
+        for (auto it = cfg.blocks[blockId].begin; it != cfg.blocks[blockId].end; ++it) {
+            if (ILAnalysis::definedTemp(*it) != -1) loopTempDefs.insert(ILAnalysis::definedTemp(*it));
+        }
+    }
+
+    for (int exiting: loop.exitingBlocks) {
+        for (int successor: cfg.blocks[exiting].successors) {
+            if (loop.contains(successor)) continue;
+
+            for (int temp: cfg.tempLiveIn[successor]) {
+                if (loopTempDefs.contains(temp)) return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool ILOptimizer::unrollLoops(ILFunction &function) {
+    bool unrolled = false;
+    // Headers of the loops already considered, by their label
+    std::unordered_set<std::string> visited;
+
+    for (bool changed = true; changed;) {
+        changed = false;
+
+        ControlFlowGraph cfg(function.stmts);
+        std::vector<NaturalLoop> loops = cfg.findLoops();
+
+        cfg.computeTempLiveness();
+
+        std::unordered_set<std::string> addressTaken = ILAnalysis::addressTakenVariables(function.stmts);
+
+        for (const auto &loop: loops) {
+            auto headerLabel = dynamic_cast<LabelStmtP>(*cfg.blocks[loop.header].begin);
+
+            if (!headerLabel || !visited.insert(headerLabel->labelName).second) continue;
+
+            // Only innermost loops are unrolled
+            bool innermost = true;
+
+            for (const auto &other: loops) {
+                if (other.header != loop.header && loop.contains(other.header)) innermost = false;
+            }
+
+            CountedLoop counted;
+
+            if (!innermost || !findCountedLoop(cfg, loop, addressTaken, counted)) continue;
+
+            // The preheader must lead straight to the loop's first statement, jumping over it to the
+            // bottom test in a while loop
+            const BasicBlock &preheader = cfg.blocks[loop.preheader];
+            auto preheaderJump = dynamic_cast<GotoStmtP>(preheader.lastStmt());
+
+            if (preheader.end != counted.begin ||
+                (counted.topTest != (preheaderJump && preheaderJump->labelName == counted.conditionLabel)) ||
+                (!counted.topTest && ILAnalysis::isJump(preheader.lastStmt()))) {
+                continue;
+            }
+
+            UniExprP bound = counted.inductionOnLeft ? counted.comparison->right : counted.comparison->left;
+            auto imIntBound = dynamic_cast<ImIntValP>(bound);
+            std::string firstLabel = dynamic_cast<LabelStmtP>(*counted.begin)->labelName;
+            std::list<ThreeAddressStmtP> replacement;
+            long long value;
+            bool fullyUnrolled = false;
+
+            // Count the iterations of a loop with a constant start and bound
+            if (imIntBound && findEntryConstant(cfg, loop, counted.inductionVar.name, value)) {
+                long long boundValue = std::stoll(imIntBound->value);
+                long long maxIterations = FULL_UNROLL_BUDGET / std::max(counted.iterationSize, 1);
+                long long iterations = 0;
+                bool known = value >= INT32_MIN && value <= INT32_MAX;
+
+                for (bool first = true; known && ((first && !counted.topTest) ||
+                                                   evaluateCountedCondition(counted, value, boundValue));) {
+                    first = false;
+                    value += counted.step;
+                    // An int would wrap around and a long may overflow
+                    known = ++iterations <= maxIterations && value >= INT32_MIN && value <= INT32_MAX;
+                }
+
+                if (known) {
+                    long long start = value - iterations * counted.step;
+
+                    // The variable has a known value in each copy
+                    for (long long i = 0; i < iterations; ++i) {
+                        replacement.splice(replacement.end(), copyIteration(
+                                counted, ".u" + std::to_string(i + 1), [&counted, start, i](bool afterStep) {
+                                    return new ImIntVal(std::to_string(start + (i + afterStep) * counted.step));
+                                }));
+                    }
+
+                    // The variable keeps its final value after the loop
+                    replacement.push_back(new VarAssignmentTAStmt(new VariableVal(counted.inductionVar),
+                                                                  new ImIntVal(std::to_string(value))));
+                    fullyUnrolled = true;
+                }
+            }
+
+            if (!fullyUnrolled) {
+                // The unrolled iterations all run if the last of them passes the test, which needs
+                // a test that fails once the variable passes the bound in the step's direction
+                ExprOperator op = counted.comparison->op;
+                bool upwards = counted.inductionOnLeft ? (op == ExprOperator::lessThan ||
+                                                          op == ExprOperator::lessThanEquals)
+                                                       : (op == ExprOperator::biggerThan ||
+                                                          op == ExprOperator::biggerThanEquals);
+                bool downwards = counted.inductionOnLeft ? (op == ExprOperator::biggerThan ||
+                                                            op == ExprOperator::biggerThanEquals)
+                                                         : (op == ExprOperator::lessThan ||
+                                                            op == ExprOperator::lessThanEquals);
+                int factor = std::min(this->options.unrollFactor,
+                                      PARTIAL_UNROLL_BUDGET / std::max(counted.iterationSize, 1));
+
+                if (factor < 2 || !((upwards && counted.step > 0) || (downwards && counted.step < 0))) continue;
+
+                int lastStepTemp = function.newTemp();
+                int guardTemp = function.newTemp();
+                std::string unrolledLabel = firstLabel + ".unrolled";
+
+                auto appendGuard = [&]() {
+                    replacement.push_back(new TempAssignmentTAStmt(
+                            lastStepTemp,
+                            addConstant(new VariableVal(counted.inductionVar), (factor - 1) * counted.step)));
+
+                    UniExpr *lastStep = new UniTemp(lastStepTemp);
+                    UniExpr *boundCopy = ILAnalysis::cloneUniExpr(bound);
+
+                    replacement.push_back(new TempAssignmentTAStmt(
+                            guardTemp, counted.inductionOnLeft ? new BinaryExpr(lastStep, boundCopy, op)
+                                                               : new BinaryExpr(boundCopy, lastStep, op)));
+                };
+
+                // Enter the original loop the usual way if not even one round of iterations fits
+                appendGuard();
+                replacement.push_back(new GotoIfZeroStmt(counted.topTest ? counted.conditionLabel : firstLabel,
+                                                         new UniTemp(guardTemp)));
+                // An empty block to serve as the unrolled loop's preheader
+                replacement.push_back(new LabelStmt(firstLabel + ".unroll"));
+                replacement.push_back(new LabelStmt(unrolledLabel));
+
+                // The copies read the variable plus the steps taken so far, and it is stepped once at the end
+                std::vector<int> stepTemps(factor + 1);
+
+                for (int i = 1; i <= factor; ++i) {
+                    stepTemps[i] = function.newTemp();
+                    replacement.push_back(new TempAssignmentTAStmt(
+                            stepTemps[i], addConstant(new VariableVal(counted.inductionVar), i * counted.step)));
+                }
+
+                for (int i = 0; i < factor; ++i) {
+                    replacement.splice(replacement.end(), copyIteration(
+                            counted, ".u" + std::to_string(i + 1), [&counted, &stepTemps, i](bool afterStep) {
+                                int taken = i + afterStep;
+
+                                return taken == 0 ? (UniExpr *) new VariableVal(counted.inductionVar)
+                                                  : (UniExpr *) new UniTemp(stepTemps[taken]);
+                            }));
+                }
+
+                replacement.push_back(new VarAssignmentTAStmt(
+                        new VariableVal(counted.inductionVar),
+                        addConstant(new VariableVal(counted.inductionVar), factor * counted.step)));
+
+                appendGuard();
+                replacement.push_back(new GotoIfNotZeroStmt(unrolledLabel, new UniTemp(guardTemp)));
+                // The remaining iterations run in the original loop, entered at its test
+                replacement.push_back(new GotoStmt(counted.conditionLabel));
+
+                visited.insert(unrolledLabel);
+            }
+
+            // Fall from the preheader into the new statements
+            if (counted.topTest) {
+                delete preheader.lastStmt();
+                function.stmts.erase(std::prev(preheader.end));
+            }
+
+            if (fullyUnrolled) {
+                auto loopEnd = std::next(counted.testJump);
+
+                for (auto it = counted.begin; it != loopEnd;) {
+                    delete *it;
+                    it = function.stmts.erase(it);
+                }
+
+                function.stmts.splice(loopEnd, replacement);
+            } else {
+                function.stmts.splice(counted.begin, replacement);
+            }
+
+            unrolled = changed = true;
+            break;
+        }
+    }
+
+    return unrolled;
+}
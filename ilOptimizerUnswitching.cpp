@@ -0,0 +1,150 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#include "ilOptimizer.h"
+
+bool ILOptimizer::unswitchLoops(ILFunction &function) {
+    bool unswitched = false;
+    int growth = 0;
+    int unswitchCount = 0;
+
+    for (bool changed = true; changed;) {
+        changed = false;
+
+        ControlFlowGraph cfg(function.stmts);
+        std::vector<NaturalLoop> loops = cfg.findLoops();
+        std::unordered_set<std::string> addressTaken = ILAnalysis::addressTakenVariables(function.stmts);
+
+        for (const auto &loop: loops) {
+            ILStmtIterator begin, last;
+
+            if (loop.preheader == -1 || !findLoopRange(cfg, loop, begin, last)) continue;
+
+            auto firstLabel = dynamic_cast<LabelStmtP>(*begin);
+            auto headerLabel = dynamic_cast<LabelStmtP>(*cfg.blocks[loop.header].begin);
+
+            if (!firstLabel || !headerLabel) continue;
+
+            // The preheader must lead straight to the loop, jumping over its start to the header in a while loop
+            const BasicBlock &preheader = cfg.blocks[loop.preheader];
+            auto preheaderJump = dynamic_cast<GotoStmtP>(preheader.lastStmt());
+            bool enteredAtStart = cfg.blocks[loop.header].begin == begin;
+
+            if (preheader.end != begin ||
+                (enteredAtStart ? ILAnalysis::isJump(preheader.lastStmt())
+                                : !preheaderJump || preheaderJump->labelName != headerLabel->labelName)) {
+                continue;
+            }
+
+            int loopSize = 0;
+
+            for (auto it = begin;; ++it) {
+                if (!dynamic_cast<LabelStmtP>(*it)) loopSize++;
+
+                if (it == last) break;
+            }
+
+            if (loopSize > UNSWITCH_LOOP_LIMIT || growth + loopSize > UNSWITCH_GROWTH_BUDGET) continue;
+
+            // Find a conditional jump on a value the loop does not change, that is safe to test before the loop
+            LoopEffects effects = collectLoopEffects(cfg, loop, addressTaken);
+            ILStmtIterator branch = function.stmts.end();
+            UniExprP condition = nullptr;
+
+            for (auto it = begin;; ++it) {
+                auto ifZero = dynamic_cast<GotoIfZeroStmtP>(*it);
+                auto ifNotZero = dynamic_cast<GotoIfNotZeroStmtP>(*it);
+                UniExprP expr = ifZero ? ifZero->expr : ifNotZero ? ifNotZero->expr : nullptr;
+
+                if (expr && isLoopInvariant(expr, effects, addressTaken) && !mayTrap(expr)) {
+                    branch = it;
+                    condition = expr;
+                    break;
+                }
+
+                if (it == last) break;
+            }
+
+            if (!condition) continue;
+
+            std::string suffix = ".us" + std::to_string(++unswitchCount);
+            std::string trueLabel = firstLabel->labelName + suffix + ".true";
+            std::string exitLabel = firstLabel->labelName + suffix + ".exit";
+            auto afterLast = std::next(last);
+
+            // The copy runs when the condition is not zero, its labels and the jumps to them get a suffix
+            std::unordered_set<std::string> loopLabels;
+
+            for (auto it = begin; it != afterLast; ++it) {
+                if (auto labelStmt = dynamic_cast<LabelStmtP>(*it)) loopLabels.insert(labelStmt->labelName);
+            }
+
+            std::list<ThreeAddressStmtP> copy;
+
+            copy.push_back(new GotoStmt(exitLabel));
+            copy.push_back(new LabelStmt(trueLabel));
+
+            if (!enteredAtStart) copy.push_back(new GotoStmt(headerLabel->labelName + suffix));
+
+            for (auto it = begin; it != afterLast; ++it) {
+                ThreeAddressStmtP stmt;
+
+                if (it == branch) {
+                    // Always taken when jumping on a non zero value, never taken otherwise
+                    if (!dynamic_cast<GotoIfNotZeroStmtP>(*it)) continue;
+
+                    stmt = new GotoStmt(ILAnalysis::jumpTarget(*it));
+                } else {
+                    stmt = ILAnalysis::cloneStmt(*it);
+                }
+
+                if (auto labelStmt = dynamic_cast<LabelStmtP>(stmt)) {
+                    labelStmt->labelName += suffix;
+                } else if (loopLabels.contains(ILAnalysis::jumpTarget(stmt))) {
+                    ILAnalysis::setJumpTarget(stmt, ILAnalysis::jumpTarget(stmt) + suffix);
+                }
+
+                copy.push_back(stmt);
+            }
+
+            copy.push_back(new LabelStmt(exitLabel));
+
+            // Test the condition once before the loop, the original loop runs when it is zero
+            std::list<ThreeAddressStmtP> entry;
+
+            entry.push_back(new GotoIfNotZeroStmt(trueLabel, ILAnalysis::cloneUniExpr(condition)));
+            // An empty block to serve as the original loop's preheader
+            entry.push_back(new LabelStmt(firstLabel->labelName + suffix + ".false"));
+
+            if (!enteredAtStart) {
+                entry.push_back(new GotoStmt(headerLabel->labelName));
+
+                delete preheader.lastStmt();
+                function.stmts.erase(std::prev(preheader.end));
+            }
+
+            if (dynamic_cast<GotoIfZeroStmtP>(*branch)) {
+                auto always = new GotoStmt(ILAnalysis::jumpTarget(*branch));
+
+                delete *branch;
+                *branch = always;
+            } else {
+                delete *branch;
+                function.stmts.erase(branch);
+            }
+
+            function.stmts.splice(begin, entry);
+            function.stmts.splice(afterLast, copy);
+            // Each version keeps the code of the outcome it never takes, which splits the loop's statements
+            removeUnreachableCode(function);
+
+            growth += loopSize;
+            unswitched = true;
+            changed = true;
+            break;
+        }
+    }
+
+    return unswitched;
+}
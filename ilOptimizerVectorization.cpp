@@ -0,0 +1,473 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#include "ilOptimizer.h"
+
+bool ILOptimizer::vectorizeBody(const ControlFlowGraph &cfg, const NaturalLoop &loop, const CountedLoop &counted,
+                                const std::unordered_set<std::string> &addressTaken, VectorizedLoop &vectorized) {
+    LoopEffects effects = collectLoopEffects(cfg, loop, addressTaken);
+    const std::string &inductionName = counted.inductionVar.name;
+    bool typeKnown = false;
+
+    // The step of the induction variable and the bottom test are not part of the vector body
+    std::unordered_set<ThreeAddressStmtP> skipped = {*counted.stepAssignment};
+
+    if (dynamic_cast<UniTempP>(dynamic_cast<VarAssignmentTAStmtP>(*counted.stepAssignment)->expr)) {
+        skipped.insert(*std::prev(counted.stepAssignment));
+    }
+
+    // The vector register holding the lanes of each temporary, and of each variable loaded since the last store
+    std::unordered_map<int, int> tempRegs;
+    std::unordered_map<std::string, int> loadedRegs;
+
+    auto newReg = [&vectorized]() {
+        return vectorized.regCount < MAX_VECTOR_REGS ? vectorized.regCount++ : -1;
+    };
+
+    // An element indexed by the induction variable, of a variable that stays the same in the whole loop
+    auto consecutiveElement = [&](SubscriptableVariableValP subVar) {
+        auto indexVar = dynamic_cast<VariableValP>(subVar->index);
+
+        if (!indexVar || dynamic_cast<SubscriptableVariableValP>(indexVar) || indexVar->var.name != inductionName ||
+            subVar->var.name.starts_with(GENERATED_VAR_PREFIX) || effects.declaredVars.contains(subVar->var.name) ||
+            effects.assignedVars.contains(subVar->var.name) ||
+            (subVar->var.ptrType && addressTaken.contains(subVar->var.name))) {
+            return false;
+        }
+
+        if (!typeKnown) {
+            vectorized.elementType = subVar->var.type;
+            vectorized.lanes = vectorized.width / typeSizes.at(subVar->var.type);
+            typeKnown = true;
+        }
+
+        return subVar->var.type == vectorized.elementType;
+    };
+
+    // The register of a temporary with vector lanes, or a new register with an invariant value in every lane
+    auto vectorOperand = [&](UniExprP expr, int &reg) {
+        auto temp = dynamic_cast<UniTempP>(expr);
+
+        if (temp && tempRegs.contains(temp->id)) {
+            reg = tempRegs[temp->id];
+            return true;
+        }
+
+        if (!typeKnown || dynamic_cast<SubscriptableVariableValP>(expr) ||
+            !isLoopInvariant(expr, effects, addressTaken) || (reg = newReg()) == -1) {
+            return false;
+        }
+
+        vectorized.setup.push_back(new VectorBroadcastStmt(vectorized.elementType, vectorized.width, reg,
+                                                           ILAnalysis::cloneUniExpr(expr)));
+
+        return true;
+    };
+
+    auto loadElement = [&](SubscriptableVariableValP subVar, int &reg) {
+        if (!consecutiveElement(subVar)) return false;
+
+        if (loadedRegs.contains(subVar->var.name)) {
+            reg = loadedRegs[subVar->var.name];
+            return true;
+        }
+
+        if ((reg = newReg()) == -1) return false;
+
+        vectorized.body.push_back(new VectorLoadStmt(
+                vectorized.elementType, vectorized.width, reg,
+                dynamic_cast<SubscriptableVariableValP>(ILAnalysis::cloneExpr(subVar))));
+        loadedRegs[subVar->var.name] = reg;
+
+        if (std::find(vectorized.loadBases.begin(), vectorized.loadBases.end(), subVar->var) ==
+            vectorized.loadBases.end()) {
+            vectorized.loadBases.push_back(subVar->var);
+        }
+
+        return true;
+    };
+
+    // A variable the loop only accumulates to, its value is not read anywhere else in the loop
+    auto reductionVariable = [&](UniExprP expr) -> VariableValP {
+        auto var = dynamic_cast<VariableValP>(expr);
+
+        if (!var || dynamic_cast<SubscriptableVariableValP>(var) || var->var.ptrType || var->var.arrSize > 0 ||
+            var->var.name == inductionName || var->var.name.starts_with(GENERATED_VAR_PREFIX) ||
+            addressTaken.contains(var->var.name) || effects.declaredVars.contains(var->var.name)) {
+            return nullptr;
+        }
+
+        return var;
+    };
+
+    // Accumulates a vector register to the reduction of a variable, each variable is reduced in a single way
+    auto accumulate = [&](const Variable &var, VectorOperator op, int reg) {
+        VectorOperator kind = op == VectorOperator::sub ? VectorOperator::add : op;
+        VectorReduction *reduction = nullptr;
+
+        for (auto &existing: vectorized.reductions) {
+            if (existing.var.name == var.name) reduction = &existing;
+        }
+
+        if (!reduction) {
+            int accumulator = newReg();
+
+            if (accumulator == -1) return false;
+
+            // A sum starts at zero and is added to the variable after the loop, a minimum or
+            // a maximum starts with the variable's value in every lane
+            vectorized.setup.push_back(new VectorBroadcastStmt(
+                    vectorized.elementType, vectorized.width, accumulator,
+                    kind == VectorOperator::add ? (UniExpr *) new ImIntVal("0") : (UniExpr *) new VariableVal(var)));
+            vectorized.reductions.emplace_back(var, kind, accumulator);
+            reduction = &vectorized.reductions.back();
+        }
+
+        if (reduction->op != kind) return false;
+
+        vectorized.body.push_back(new VectorBinaryStmt(vectorized.elementType, vectorized.width, reduction->reg,
+                                                       reduction->reg, reg, op));
+
+        return true;
+    };
+
+    auto nextStmt = [&counted](ILStmtIterator it) {
+        // Scopes without declarations have no effect on the values
+        for (++it; it != counted.testJump; ++it) {
+            auto scopeEnter = dynamic_cast<ScopeEnterStmtP>(*it);
+
+            if (!(scopeEnter && scopeEnter->vars.empty()) && !dynamic_cast<ScopeExitStmtP>(*it)) break;
+        }
+
+        return it;
+    };
+
+    ILStmtIterator comparison = std::prev(counted.testJump);
+
+    for (auto it = counted.begin; it != comparison; ++it) {
+        ThreeAddressStmtP stmt = *it;
+
+        if (skipped.contains(stmt) || dynamic_cast<LabelStmtP>(stmt) || dynamic_cast<ScopeExitStmtP>(stmt)) continue;
+
+        if (auto scopeEnter = dynamic_cast<ScopeEnterStmtP>(stmt)) {
+            if (!scopeEnter->vars.empty()) return false;
+
+            continue;
+        }
+
+        if (auto varAssignment = dynamic_cast<VarAssignmentTAStmtP>(stmt)) {
+            auto target = dynamic_cast<SubscriptableVariableValP>(varAssignment->var);
+            auto value = dynamic_cast<UniExprP>(varAssignment->expr);
+            int reg;
+
+            if (!target || !value || !consecutiveElement(target) || !vectorOperand(value, reg)) return false;
+
+            vectorized.body.push_back(new VectorStoreStmt(
+                    vectorized.elementType, vectorized.width,
+                    dynamic_cast<SubscriptableVariableValP>(ILAnalysis::cloneExpr(target)), reg));
+
+            if (std::find(vectorized.storeBases.begin(), vectorized.storeBases.end(), target->var) ==
+                vectorized.storeBases.end()) {
+                vectorized.storeBases.push_back(target->var);
+            }
+
+            // A store may change the elements loaded through any pointer
+            loadedRegs.clear();
+            continue;
+        }
+
+        auto tempAssignment = dynamic_cast<TempAssignmentTAStmtP>(stmt);
+
+        if (!tempAssignment) return false;
+
+        int id = tempAssignment->id;
+        int reg;
+
+        if (auto subVar = dynamic_cast<SubscriptableVariableValP>(tempAssignment->expr)) {
+            if (!loadElement(subVar, reg)) return false;
+
+            tempRegs[id] = reg;
+            continue;
+        }
+
+        if (auto temp = dynamic_cast<UniTempP>(tempAssignment->expr); temp && tempRegs.contains(temp->id)) {
+            tempRegs[id] = tempRegs[temp->id];
+            continue;
+        }
+
+        auto binary = dynamic_cast<BinaryExprP>(tempAssignment->expr);
+
+        if (!binary) return false;
+
+        auto leftTemp = dynamic_cast<UniTempP>(binary->left);
+        auto rightTemp = dynamic_cast<UniTempP>(binary->right);
+        bool leftVector = leftTemp && tempRegs.contains(leftTemp->id);
+        bool rightVector = rightTemp && tempRegs.contains(rightTemp->id);
+
+        if (binary->op == ExprOperator::add || binary->op == ExprOperator::sub) {
+            VectorOperator op = binary->op == ExprOperator::add ? VectorOperator::add : VectorOperator::sub;
+
+            // A sum 'temp := s + v', 'temp := v + s' or 'temp := s - v' directly followed by 's = temp'
+            VariableValP accumulated = rightVector ? reductionVariable(binary->left) : nullptr;
+            int vectorReg = rightVector ? tempRegs[rightTemp->id] : -1;
+
+            if (!accumulated && leftVector && op == VectorOperator::add) {
+                accumulated = reductionVariable(binary->right);
+                vectorReg = tempRegs[leftTemp->id];
+            }
+
+            if (accumulated) {
+                auto next = nextStmt(it);
+                auto assignment = next != counted.testJump ? dynamic_cast<VarAssignmentTAStmtP>(*next) : nullptr;
+                auto assignedTemp = assignment ? dynamic_cast<UniTempP>(assignment->expr) : nullptr;
+
+                if (!assignedTemp || assignedTemp->id != id || dynamic_cast<SubscriptableVariableValP>(assignment->var) ||
+                    assignment->var->var.name != accumulated->var.name ||
+                    !accumulate(accumulated->var, op, vectorReg)) {
+                    return false;
+                }
+
+                tempRegs.erase(id);
+                it = next;
+                continue;
+            }
+
+            // An element-wise operation, at least one of the operands changes between the lanes
+            int left, right;
+
+            if ((!leftVector && !rightVector) || !vectorOperand(binary->left, left) ||
+                !vectorOperand(binary->right, right) || (reg = newReg()) == -1) {
+                return false;
+            }
+
+            vectorized.body.push_back(new VectorBinaryStmt(vectorized.elementType, vectorized.width, reg, left,
+                                                           right, op));
+            tempRegs[id] = reg;
+            continue;
+        }
+
+        // A minimum or a maximum: 'temp := v > m', 'GotoIfZero temp end', 'm = v', 'end:'
+        if (binary->op < ExprOperator::biggerThan || binary->op > ExprOperator::lessThanEquals ||
+            leftVector == rightVector) {
+            return false;
+        }
+
+        VariableValP extreme = reductionVariable(leftVector ? binary->right : binary->left);
+        int vectorReg = tempRegs[leftVector ? leftTemp->id : rightTemp->id];
+        bool greater = binary->op == ExprOperator::biggerThan || binary->op == ExprOperator::biggerThanEquals;
+        VectorOperator op = greater == leftVector ? VectorOperator::max : VectorOperator::min;
+        auto next = nextStmt(it);
+        auto skipJump = next != counted.testJump ? dynamic_cast<GotoIfZeroStmtP>(*next) : nullptr;
+        auto testedTemp = skipJump ? dynamic_cast<UniTempP>(skipJump->expr) : nullptr;
+
+        if (!extreme || !testedTemp || testedTemp->id != id) return false;
+
+        tempRegs.erase(id);
+
+        bool assigned = false;
+
+        for (it = nextStmt(next); it != counted.testJump; it = nextStmt(it)) {
+            auto label = dynamic_cast<LabelStmtP>(*it);
+
+            if (label && label->labelName == skipJump->labelName) break;
+
+            // The new extreme is the compared element, possibly loaded again
+            auto innerTemp = dynamic_cast<TempAssignmentTAStmtP>(*it);
+            auto innerLoad = innerTemp ? dynamic_cast<SubscriptableVariableValP>(innerTemp->expr) : nullptr;
+            auto innerAssignment = dynamic_cast<VarAssignmentTAStmtP>(*it);
+            auto innerValue = innerAssignment ? dynamic_cast<UniTempP>(innerAssignment->expr) : nullptr;
+
+            if (innerLoad && !assigned && loadElement(innerLoad, reg) && reg == vectorReg) {
+                tempRegs[innerTemp->id] = reg;
+            } else if (innerValue && !assigned && !dynamic_cast<SubscriptableVariableValP>(innerAssignment->var) &&
+                       innerAssignment->var->var.name == extreme->var.name && tempRegs.contains(innerValue->id) &&
+                       tempRegs[innerValue->id] == vectorReg) {
+                assigned = true;
+            } else {
+                return false;
+            }
+        }
+
+        if (it == counted.testJump || !assigned || !accumulate(extreme->var, op, vectorReg)) return false;
+    }
+
+    if (!typeKnown) return false;
+
+    for (const auto &reduction: vectorized.reductions) {
+        // Lanes are as wide as the elements, so the variable must be as wide as well. SSE2 can't compare
+        // 64 bit lanes.
+        if (reduction.var.type != vectorized.elementType ||
+            (reduction.op != VectorOperator::add && vectorized.elementType == VariableType::longType &&
+             vectorized.width == SSE_VECTOR_WIDTH)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ILOptimizer::vectorizeLoops(ILFunction &function) {
+    bool vectorizedAny = false;
+    int vectorCount = 0;
+    // Headers of the loops already considered, by their label
+    std::unordered_set<std::string> visited;
+
+    for (bool changed = true; changed;) {
+        changed = false;
+
+        ControlFlowGraph cfg(function.stmts);
+        std::vector<NaturalLoop> loops = cfg.findLoops();
+
+        cfg.computeTempLiveness();
+
+        std::unordered_set<std::string> addressTaken = ILAnalysis::addressTakenVariables(function.stmts);
+
+        for (const auto &loop: loops) {
+            auto headerLabel = dynamic_cast<LabelStmtP>(*cfg.blocks[loop.header].begin);
+
+            if (!headerLabel || !visited.insert(headerLabel->labelName).second) continue;
+
+            CountedLoop counted;
+            UniExprP bound;
+
+            if (!findUnitStrideLoop(cfg, loops, loop, addressTaken, counted, bound)) continue;
+
+            VectorizedLoop vectorized;
+            vectorized.width = this->options.avx2 ? AVX_VECTOR_WIDTH : SSE_VECTOR_WIDTH;
+
+            if (!vectorizeBody(cfg, loop, counted, addressTaken, vectorized)) continue;
+
+            // Pairs of accessed variables that may overlap, at least one of them stored to
+            std::vector<std::pair<Variable, Variable>> aliasChecks;
+            std::vector<Variable> accessed = vectorized.storeBases;
+
+            for (const auto &var: vectorized.loadBases) {
+                if (std::find(accessed.begin(), accessed.end(), var) == accessed.end()) accessed.push_back(var);
+            }
+
+            for (size_t i = 0; i < vectorized.storeBases.size(); ++i) {
+                for (size_t j = 0; j < accessed.size(); ++j) {
+                    const Variable &stored = vectorized.storeBases[i];
+                    const Variable &other = accessed[j];
+
+                    // Stores are checked against the stores before them and against every load
+                    if (j <= i || stored.name == other.name) continue;
+
+                    // A pointer may point into an array only if the array's address is taken
+                    bool mayAlias = stored.ptrType ? (other.ptrType || addressTaken.contains(other.name))
+                                                   : (other.ptrType && addressTaken.contains(stored.name));
+
+                    if (mayAlias) aliasChecks.emplace_back(stored, other);
+                }
+            }
+
+            if (aliasChecks.size() > MAX_ALIAS_CHECKS) continue;
+
+            std::string firstLabel = dynamic_cast<LabelStmtP>(*counted.begin)->labelName;
+            std::string suffix = ".vec" + std::to_string(++vectorCount);
+            std::string scalarEntry = counted.topTest ? counted.conditionLabel : firstLabel;
+            std::list<ThreeAddressStmtP> replacement;
+
+            // Two variables accessed at the same index are safe to access a register at a time if they are the
+            // same, or if they are at least a register's width apart
+            for (size_t i = 0; i < aliasChecks.size(); ++i) {
+                std::string checked = firstLabel + suffix + ".alias" + std::to_string(i + 1);
+                int first = function.newTemp();
+                int second = function.newTemp();
+                int distance = function.newTemp();
+                int test = function.newTemp();
+
+                replacement.push_back(new TempAssignmentTAStmt(first, new AddrVarExpr(
+                        new SubscriptableVariableVal(aliasChecks[i].first, new ImIntVal("0")))));
+                replacement.push_back(new TempAssignmentTAStmt(second, new AddrVarExpr(
+                        new SubscriptableVariableVal(aliasChecks[i].second, new ImIntVal("0")))));
+                replacement.push_back(new TempAssignmentTAStmt(distance, new BinaryExpr(
+                        new UniTemp(first), new UniTemp(second), ExprOperator::sub)));
+                replacement.push_back(new TempAssignmentTAStmt(test, new BinaryExpr(
+                        new UniTemp(distance), new ImIntVal(std::to_string(vectorized.width)),
+                        ExprOperator::lessThan)));
+                replacement.push_back(new GotoIfZeroStmt(checked, new UniTemp(test)));
+                replacement.push_back(new TempAssignmentTAStmt(test, new BinaryExpr(
+                        new UniTemp(distance), new ImIntVal(std::to_string(-vectorized.width)),
+                        ExprOperator::biggerThan)));
+                replacement.push_back(new GotoIfZeroStmt(checked, new UniTemp(test)));
+                replacement.push_back(new GotoIfNotZeroStmt(scalarEntry, new UniTemp(distance)));
+                replacement.push_back(new LabelStmt(checked));
+            }
+
+            // The vector loop compares with the bound moved back by the lanes after the first
+            int vectorBound = function.newTemp();
+            int guard = function.newTemp();
+            int loopTest = function.newTemp();
+            std::string vectorLabel = firstLabel + suffix;
+            std::string vectorConditionLabel = vectorLabel + "Condition";
+
+            ExprOperator op = counted.comparison->op;
+
+            auto makeTest = [&](int temp) {
+                UniExpr *inductionValue = new VariableVal(counted.inductionVar);
+                UniExpr *boundValue = new UniTemp(vectorBound);
+
+                return new TempAssignmentTAStmt(temp, counted.inductionOnLeft
+                                                      ? new BinaryExpr(inductionValue, boundValue, op)
+                                                      : new BinaryExpr(boundValue, inductionValue, op));
+            };
+
+            replacement.push_back(new TempAssignmentTAStmt(vectorBound, addConstant(
+                    ILAnalysis::cloneUniExpr(bound), -(vectorized.lanes - 1))));
+            replacement.push_back(makeTest(guard));
+            replacement.push_back(new GotoIfZeroStmt(scalarEntry, new UniTemp(guard)));
+            // The vector loop's preheader
+            replacement.push_back(new LabelStmt(vectorLabel + "Setup"));
+            replacement.splice(replacement.end(), vectorized.setup);
+            replacement.push_back(new LabelStmt(vectorLabel));
+            replacement.splice(replacement.end(), vectorized.body);
+            replacement.push_back(new VarAssignmentTAStmt(
+                    new VariableVal(counted.inductionVar),
+                    addConstant(new VariableVal(counted.inductionVar), vectorized.lanes)));
+            replacement.push_back(new LabelStmt(vectorConditionLabel));
+            replacement.push_back(makeTest(loopTest));
+            replacement.push_back(new GotoIfNotZeroStmt(vectorLabel, new UniTemp(loopTest)));
+
+            // Combine the lanes of each reduction
+            for (const auto &reduction: vectorized.reductions) {
+                int combined = function.newTemp();
+
+                replacement.push_back(new VectorReduceStmt(vectorized.elementType, vectorized.width, combined,
+                                                           reduction.reg, reduction.op));
+
+                if (reduction.op == VectorOperator::add) {
+                    int total = function.newTemp();
+
+                    replacement.push_back(new TempAssignmentTAStmt(total, new BinaryExpr(
+                            new VariableVal(reduction.var), new UniTemp(combined), ExprOperator::add)));
+                    replacement.push_back(new VarAssignmentTAStmt(new VariableVal(reduction.var),
+                                                                  new UniTemp(total)));
+                } else {
+                    replacement.push_back(new VarAssignmentTAStmt(new VariableVal(reduction.var),
+                                                                  new UniTemp(combined)));
+                }
+            }
+
+            // The remaining iterations run in the original loop, entered at its test
+            replacement.push_back(new GotoStmt(counted.conditionLabel));
+
+            if (counted.topTest) {
+                const BasicBlock &preheader = cfg.blocks[loop.preheader];
+
+                delete preheader.lastStmt();
+                function.stmts.erase(std::prev(preheader.end));
+            }
+
+            function.stmts.splice(counted.begin, replacement);
+
+            visited.insert(vectorLabel);
+            vectorizedAny = true;
+            changed = true;
+            break;
+        }
+    }
+
+    return vectorizedAny;
+}
@@ -0,0 +1,230 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#include "instructionScheduler.h"
+
+#include <algorithm>
+#include <climits>
+#include <unordered_set>
+
+void InstructionScheduler::scheduleFunction(MachineFunction &function) const {
+    std::vector<InstrEffects> effects;
+    size_t begin = 0;
+
+    for (size_t pos = 0; pos <= function.instrs.size(); ++pos) {
+        InstrEffects instrEffects;
+
+        if (pos < function.instrs.size() && analyzeInstr(function.instrs[pos], instrEffects)) {
+            effects.push_back(instrEffects);
+            continue;
+        }
+
+        // The region ends right before the instruction that can't be scheduled
+        if (effects.size() > 1) scheduleRegion(function.instrs, begin, effects);
+
+        effects.clear();
+        begin = pos + 1;
+    }
+}
+
+bool InstructionScheduler::analyzeInstr(const MachineInstr &instr, InstrEffects &effects) const {
+    // Instructions that only read their first operand, and ones that write it without reading it
+    static const std::unordered_set<std::string> comparisons = {"cmp", "test"};
+    static const std::unordered_set<std::string> moves = {"mov", "movsx", "movsxd", "movzx", "lea"};
+    // Instructions that read and write their first operand, setting the flags
+    static const std::unordered_set<std::string> arithmetic = {
+            "add", "sub", "and", "or", "xor", "shl", "shr", "sar", "imul", "neg", "inc", "dec"
+    };
+    const std::string &opcode = instr.opcode;
+    bool conditional = opcode.starts_with("set") || opcode.starts_with("cmov");
+    bool firstRead = true;
+    bool firstWritten = false;
+
+    if (instr.isLabel()) return false;
+
+    if (opcode == "cqo" || opcode == "cdq") {
+        effects.uses = {"rax"};
+        effects.defs = {"rdx"};
+        return true;
+    } else if (opcode == "idiv" || opcode == "div" || (opcode == "imul" && instr.operands.size() == 1)) {
+        // The dividend and the product are in 'rdx:rax'
+        effects.uses = {"rax", "rdx"};
+        effects.defs = {"rax", "rdx"};
+        effects.writesFlags = true;
+        effects.latency = opcode == "imul" ? latencies.multiply : latencies.divide;
+    } else if (moves.contains(opcode) || (opcode == "imul" && instr.operands.size() == 3)) {
+        firstRead = false;
+        firstWritten = true;
+        effects.writesFlags = opcode == "imul";
+        effects.latency = opcode == "imul" ? latencies.multiply : latencies.alu;
+    } else if (arithmetic.contains(opcode) || conditional) {
+        firstWritten = true;
+        // 'inc' and 'dec' keep the carry flag and a shift by zero keeps all of them, so they may pass a flag on
+        effects.readsFlags = conditional || opcode == "inc" || opcode == "dec" || opcode.starts_with("sh") ||
+                             opcode == "sar";
+        effects.writesFlags = !conditional;
+        effects.latency = opcode == "imul" ? latencies.multiply : latencies.alu;
+    } else if (comparisons.contains(opcode)) {
+        effects.writesFlags = true;
+    } else {
+        return false;
+    }
+
+    for (size_t i = 0; i < instr.operands.size(); ++i) {
+        const MachineOperand &operand = instr.operands[i];
+        bool read = i > 0 || firstRead;
+        bool written = i == 0 && firstWritten;
+
+        if (operand.isReg()) {
+            // Writing less than 32 bits of a register keeps the rest of it
+            if (read || operand.size < 4) effects.uses.push_back(operand.fullReg());
+            if (written) effects.defs.push_back(operand.fullReg());
+        } else if (operand.isMem()) {
+            std::vector<std::string> addressRegs = operand.addressRegs();
+
+            effects.uses.insert(effects.uses.end(), addressRegs.begin(), addressRegs.end());
+
+            if (opcode == "lea") continue;
+
+            effects.memory = &operand;
+            effects.readsMemory |= read;
+            effects.writesMemory |= written;
+        }
+    }
+
+    // The instruction waits for the loaded value, a store has no result to wait for
+    if (effects.readsMemory) effects.latency += latencies.load;
+
+    // Moving the stack pointer may release memory accessed through 'rbp' and changes the meaning of the addresses
+    // from 'rsp', nothing moves across it
+    if (std::find(effects.defs.begin(), effects.defs.end(), "rsp") != effects.defs.end()) {
+        effects.readsMemory = true;
+        effects.writesMemory = true;
+        effects.memory = nullptr;
+    }
+
+    return true;
+}
+
+void InstructionScheduler::scheduleRegion(std::vector<MachineInstr> &instrs, size_t begin,
+                                          const std::vector<InstrEffects> &effects) const {
+    size_t count = effects.size();
+    // The instructions depending on each instruction and the cycles they wait for it
+    std::vector<std::vector<std::pair<size_t, int>>> successors(count);
+    std::vector<int> predecessorsLeft(count, 0);
+
+    auto shares = [](const std::vector<std::string> &first, const std::vector<std::string> &second) {
+        return std::any_of(first.begin(), first.end(), [&second](const std::string &reg) {
+            return std::find(second.begin(), second.end(), reg) != second.end();
+        });
+    };
+
+    for (size_t later = 0; later < count; ++later) {
+        for (size_t earlier = 0; earlier < later; ++earlier) {
+            const InstrEffects &first = effects[earlier];
+            const InstrEffects &second = effects[later];
+            // Whether both access the same memory and at least one of them writes it
+            bool memoryConflict = (first.readsMemory || first.writesMemory) &&
+                                  (second.readsMemory || second.writesMemory) &&
+                                  (first.writesMemory || second.writesMemory) && mayAlias(first, second);
+            int wait = -1;
+
+            // A value read waits for its producer
+            if (shares(first.defs, second.uses) || (first.writesFlags && second.readsFlags)) {
+                wait = first.latency;
+            } else if (first.writesMemory && second.readsMemory && memoryConflict) {
+                wait = 1;
+            }
+
+            // An overwritten value is written after the instructions reading or writing it before
+            if (wait < 0 && (shares(first.uses, second.defs) || shares(first.defs, second.defs) ||
+                             (first.readsFlags && second.writesFlags) || (first.writesFlags && second.writesFlags) ||
+                             memoryConflict)) {
+                wait = 0;
+            }
+
+            if (wait >= 0) {
+                successors[earlier].emplace_back(later, wait);
+                predecessorsLeft[later]++;
+            }
+        }
+    }
+
+    // The length of the longest dependency chain from each instruction to the region's end
+    std::vector<int> height(count, 0);
+
+    for (size_t i = count; i-- > 0;) {
+        height[i] = effects[i].latency;
+
+        for (const auto &[successor, wait]: successors[i]) {
+            height[i] = std::max(height[i], wait + height[successor]);
+        }
+    }
+
+    std::vector<int> earliest(count, 0);
+    std::vector<bool> scheduled(count, false);
+    std::vector<MachineInstr> order;
+    int cycle = 0;
+    int issued = 0;
+
+    while (order.size() < count) {
+        size_t best = count;
+        int nextCycle = INT32_MAX;
+
+        // Issue the ready instruction with the longest chain after it, the first one of them on a tie
+        for (size_t i = 0; i < count; ++i) {
+            if (scheduled[i] || predecessorsLeft[i] > 0) continue;
+
+            if (earliest[i] > cycle) {
+                nextCycle = std::min(nextCycle, earliest[i]);
+            } else if (best == count || height[i] > height[best]) {
+                best = i;
+            }
+        }
+
+        if (best == count) {
+            cycle = nextCycle;
+            issued = 0;
+            continue;
+        }
+
+        scheduled[best] = true;
+        order.push_back(instrs[begin + best]);
+
+        for (const auto &[successor, wait]: successors[best]) {
+            earliest[successor] = std::max(earliest[successor], cycle + wait);
+            predecessorsLeft[successor]--;
+        }
+
+        if (++issued == latencies.issueWidth) {
+            cycle++;
+            issued = 0;
+        }
+    }
+
+    std::move(order.begin(), order.end(), instrs.begin() + (long) begin);
+}
+
+bool InstructionScheduler::mayAlias(const InstrEffects &first, const InstrEffects &second) {
+    std::string firstBase, secondBase;
+    long long firstOffset, secondOffset;
+
+    if (!first.memory || !second.memory || !frameOffset(*first.memory, firstBase, firstOffset) ||
+        !frameOffset(*second.memory, secondBase, secondOffset) || firstBase != secondBase ||
+        first.memory->size == 0 || second.memory->size == 0) {
+        return true;
+    }
+
+    return firstOffset < secondOffset + second.memory->size && secondOffset < firstOffset + first.memory->size;
+}
+
+bool InstructionScheduler::frameOffset(const MachineOperand &operand, std::string &base, long long &offset) {
+    if (!operand.name.empty() || !operand.index.empty() || (operand.base != "rbp" && operand.base != "rsp")) {
+        return false;
+    }
+
+    base = operand.base;
+    offset = operand.value;
+    return true;
+}
@@ -0,0 +1,118 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#ifndef COMPILER_INSTRUCTIONSCHEDULER_H
+#define COMPILER_INSTRUCTIONSCHEDULER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "machineInstructions.h"
+
+/**
+ * @brief The latencies (in cycles) of the instruction classes on a core, and how many instructions it issues
+ * each cycle.
+ */
+struct TuneLatencies {
+    int load;
+    int alu;
+    int multiply;
+    int divide;
+    int issueWidth;
+};
+
+/**
+ * @brief What an instruction reads and writes, the dependencies the scheduler must keep.
+ */
+class InstrEffects {
+public:
+    // The 64 bit registers read and written
+    std::vector<std::string> uses;
+    std::vector<std::string> defs;
+    bool readsFlags = false;
+    bool writesFlags = false;
+    bool readsMemory = false;
+    bool writesMemory = false;
+    // The memory operand accessed, null for an access to unknown memory
+    const MachineOperand *memory = nullptr;
+    // Cycles until the instruction's results can be used
+    int latency = 1;
+};
+
+/**
+ * @brief Reorders the independent instructions of each basic block of a function, so long latency
+ * instructions (loads, multiplications and divisions) start as early as their operands allow.
+ *
+ * Blocks are split to regions at labels, jumps, calls and instructions the scheduler doesn't model (like the
+ * vector instructions), nothing moves across them. Within a region the order of the instructions writing each
+ * register, the flags and possibly overlapping memory is kept, so every reader sees the same value.
+ */
+class InstructionScheduler {
+public:
+    // Map from the names given to '-mtune=' to the latencies of the core
+    inline static const std::unordered_map<std::string, TuneLatencies> tunes = {
+            {"generic", {5, 1, 3, 40, 4}},
+            {"skylake", {5, 1, 3, 42, 4}},
+            {"icelake", {5, 1, 3, 15, 5}},
+            {"znver3",  {4, 1, 3, 17, 6}}
+    };
+
+    /**
+     * @brief Constructor for the InstructionScheduler class.
+     *
+     * @param tune The name of the core to schedule for, a key of 'tunes'.
+     */
+    explicit InstructionScheduler(const std::string &tune) : latencies(tunes.at(tune)) {
+
+    }
+
+    /**
+     * @brief Schedules the instructions of a function in place.
+     *
+     * @param function The function to schedule.
+     */
+    void scheduleFunction(MachineFunction &function) const;
+
+private:
+    const TuneLatencies &latencies;
+
+    /**
+     * @brief Finds the effects of an instruction.
+     *
+     * @param instr The instruction.
+     * @param effects Filled with the instruction's effects.
+     * @return Whether the instruction can be scheduled, false for the instructions ending a region.
+     */
+    bool analyzeInstr(const MachineInstr &instr, InstrEffects &effects) const;
+
+    /**
+     * @brief Reorders a region of instructions, a cycle by cycle list scheduling by the length of the longest
+     * dependency chain from each instruction to the region's end.
+     *
+     * @param instrs The instructions of the function.
+     * @param begin The position of the region's first instruction.
+     * @param effects The effects of the region's instructions.
+     */
+    void scheduleRegion(std::vector<MachineInstr> &instrs, size_t begin,
+                        const std::vector<InstrEffects> &effects) const;
+
+    /**
+     * @brief Checks whether the memory accessed by two instructions may overlap. Accesses at constant offsets
+     * from the same frame register ('rbp', or 'rsp' between its adjustments) overlap only if their bytes do, any
+     * other access may overlap anything.
+     */
+    static bool mayAlias(const InstrEffects &first, const InstrEffects &second);
+
+    /**
+     * @brief Gets the offset of a memory operand addressed by a frame register ('rbp' or 'rsp') and a constant.
+     *
+     * @param operand The memory operand.
+     * @param base Set to the frame register.
+     * @param offset Set to the offset.
+     * @return Whether the operand is addressed by a frame register and a constant only.
+     */
+    static bool frameOffset(const MachineOperand &operand, std::string &base, long long &offset);
+};
+
+#endif //COMPILER_INSTRUCTIONSCHEDULER_H
@@ -0,0 +1,149 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#ifndef COMPILER_INSTRUCTIONSELECTION_H
+#define COMPILER_INSTRUCTIONSELECTION_H
+
+#include <array>
+#include <string_view>
+
+#include "threeAddressExpressionsAndStatements.h"
+
+/**
+ * @brief The kinds of operands an instruction selection pattern can require.
+ */
+enum class OperandKind {
+    // Any operand, the left one is loaded to 'rax'. The right one is used directly when it is an immediate,
+    // a register variable or a 64 bit stack slot (a temporary or an 8 byte variable), otherwise it is loaded to 'rbx'
+    any,
+    // A constant that fits in a sign extended 32 bit immediate
+    immediate,
+    // A positive constant power of two
+    powerOfTwo,
+    // A variable kept in a register, used without being copied to 'rax'
+    reg,
+};
+
+/**
+ * @brief The operands of the instructions of an instruction selection pattern, filled in from the expression.
+ */
+enum class PatternOperand {
+    none,
+    // The result register and its parts
+    rax,
+    eax,
+    al,
+    // The left operand, 'rax' unless it is a register variable
+    left,
+    // The right operand: an immediate, a register or a stack slot
+    right,
+    // The base 2 logarithm of a power of two right operand
+    shift,
+    // The address of the left operand plus the right one, computed by 'lea'
+    leftPlusRight,
+    // The address of the left operand plus itself scaled by the pattern's constant minus one ('value' 3 is
+    // '[l + l * 2]'), computed by 'lea'
+    leftTimesValue,
+};
+
+/**
+ * @brief An instruction of an instruction selection pattern.
+ */
+struct PatternInstr {
+    std::string_view opcode;
+    std::array<PatternOperand, 3> operands;
+};
+
+/**
+ * @brief A pattern of a binary expression and the instructions computing it to 'rax'.
+ */
+struct SelectionPattern {
+    ExprOperator op;
+    OperandKind left;
+    OperandKind right;
+    // The only constant the right operand may be, if set
+    bool exactValue;
+    long long value;
+    // The instructions, up to the first one without an opcode
+    std::array<PatternInstr, 3> instrs;
+};
+
+/**
+ * @brief The instruction selection patterns, the first one matching an expression is used.
+ */
+inline constexpr std::array selectionPatterns = {
+        // A register variable plus an immediate or another register is computed by the address unit
+        SelectionPattern{ExprOperator::add, OperandKind::reg, OperandKind::immediate, false, 0,
+                         {{{"lea", {PatternOperand::rax, PatternOperand::leftPlusRight}}}}},
+        SelectionPattern{ExprOperator::add, OperandKind::reg, OperandKind::reg, false, 0,
+                         {{{"lea", {PatternOperand::rax, PatternOperand::leftPlusRight}}}}},
+
+        SelectionPattern{ExprOperator::add, OperandKind::any, OperandKind::immediate, true, 1,
+                         {{{"inc", {PatternOperand::rax}}}}},
+        SelectionPattern{ExprOperator::add, OperandKind::any, OperandKind::immediate, true, -1,
+                         {{{"dec", {PatternOperand::rax}}}}},
+        SelectionPattern{ExprOperator::add, OperandKind::any, OperandKind::any, false, 0,
+                         {{{"add", {PatternOperand::rax, PatternOperand::right}}}}},
+
+        SelectionPattern{ExprOperator::sub, OperandKind::any, OperandKind::immediate, true, 1,
+                         {{{"dec", {PatternOperand::rax}}}}},
+        SelectionPattern{ExprOperator::sub, OperandKind::any, OperandKind::immediate, true, -1,
+                         {{{"inc", {PatternOperand::rax}}}}},
+        SelectionPattern{ExprOperator::sub, OperandKind::any, OperandKind::any, false, 0,
+                         {{{"sub", {PatternOperand::rax, PatternOperand::right}}}}},
+
+        // Multiplying by 2, 3, 5 and 9 adds scaled copies, by other powers of two shifts
+        SelectionPattern{ExprOperator::mult, OperandKind::reg, OperandKind::immediate, true, 2,
+                         {{{"lea", {PatternOperand::rax, PatternOperand::leftTimesValue}}}}},
+        SelectionPattern{ExprOperator::mult, OperandKind::any, OperandKind::immediate, true, 2,
+                         {{{"add", {PatternOperand::rax, PatternOperand::rax}}}}},
+        SelectionPattern{ExprOperator::mult, OperandKind::reg, OperandKind::immediate, true, 3,
+                         {{{"lea", {PatternOperand::rax, PatternOperand::leftTimesValue}}}}},
+        SelectionPattern{ExprOperator::mult, OperandKind::any, OperandKind::immediate, true, 3,
+                         {{{"lea", {PatternOperand::rax, PatternOperand::leftTimesValue}}}}},
+        SelectionPattern{ExprOperator::mult, OperandKind::reg, OperandKind::immediate, true, 5,
+                         {{{"lea", {PatternOperand::rax, PatternOperand::leftTimesValue}}}}},
+        SelectionPattern{ExprOperator::mult, OperandKind::any, OperandKind::immediate, true, 5,
+                         {{{"lea", {PatternOperand::rax, PatternOperand::leftTimesValue}}}}},
+        SelectionPattern{ExprOperator::mult, OperandKind::reg, OperandKind::immediate, true, 9,
+                         {{{"lea", {PatternOperand::rax, PatternOperand::leftTimesValue}}}}},
+        SelectionPattern{ExprOperator::mult, OperandKind::any, OperandKind::immediate, true, 9,
+                         {{{"lea", {PatternOperand::rax, PatternOperand::leftTimesValue}}}}},
+        SelectionPattern{ExprOperator::mult, OperandKind::any, OperandKind::powerOfTwo, false, 0,
+                         {{{"shl", {PatternOperand::rax, PatternOperand::shift}}}}},
+        SelectionPattern{ExprOperator::mult, OperandKind::reg, OperandKind::immediate, false, 0,
+                         {{{"imul", {PatternOperand::rax, PatternOperand::left, PatternOperand::right}}}}},
+        SelectionPattern{ExprOperator::mult, OperandKind::any, OperandKind::immediate, false, 0,
+                         {{{"imul", {PatternOperand::rax, PatternOperand::rax, PatternOperand::right}}}}},
+        SelectionPattern{ExprOperator::mult, OperandKind::any, OperandKind::any, false, 0,
+                         {{{"imul", {PatternOperand::rax, PatternOperand::right}}}}},
+
+        // Comparisons compare with the operand directly and set the result from the flags
+        SelectionPattern{ExprOperator::equals, OperandKind::any, OperandKind::immediate, true, 0,
+                         {{{"test", {PatternOperand::rax, PatternOperand::rax}}, {"sete", {PatternOperand::al}},
+                           {"movzx", {PatternOperand::eax, PatternOperand::al}}}}},
+        SelectionPattern{ExprOperator::equals, OperandKind::any, OperandKind::any, false, 0,
+                         {{{"cmp", {PatternOperand::rax, PatternOperand::right}}, {"sete", {PatternOperand::al}},
+                           {"movzx", {PatternOperand::eax, PatternOperand::al}}}}},
+        SelectionPattern{ExprOperator::notEquals, OperandKind::any, OperandKind::immediate, true, 0,
+                         {{{"test", {PatternOperand::rax, PatternOperand::rax}}, {"setne", {PatternOperand::al}},
+                           {"movzx", {PatternOperand::eax, PatternOperand::al}}}}},
+        SelectionPattern{ExprOperator::notEquals, OperandKind::any, OperandKind::any, false, 0,
+                         {{{"cmp", {PatternOperand::rax, PatternOperand::right}}, {"setne", {PatternOperand::al}},
+                           {"movzx", {PatternOperand::eax, PatternOperand::al}}}}},
+        SelectionPattern{ExprOperator::biggerThan, OperandKind::any, OperandKind::any, false, 0,
+                         {{{"cmp", {PatternOperand::rax, PatternOperand::right}}, {"setg", {PatternOperand::al}},
+                           {"movzx", {PatternOperand::eax, PatternOperand::al}}}}},
+        SelectionPattern{ExprOperator::biggerThanEquals, OperandKind::any, OperandKind::any, false, 0,
+                         {{{"cmp", {PatternOperand::rax, PatternOperand::right}}, {"setge", {PatternOperand::al}},
+                           {"movzx", {PatternOperand::eax, PatternOperand::al}}}}},
+        SelectionPattern{ExprOperator::lessThan, OperandKind::any, OperandKind::any, false, 0,
+                         {{{"cmp", {PatternOperand::rax, PatternOperand::right}}, {"setl", {PatternOperand::al}},
+                           {"movzx", {PatternOperand::eax, PatternOperand::al}}}}},
+        SelectionPattern{ExprOperator::lessThanEquals, OperandKind::any, OperandKind::any, false, 0,
+                         {{{"cmp", {PatternOperand::rax, PatternOperand::right}}, {"setle", {PatternOperand::al}},
+                           {"movzx", {PatternOperand::eax, PatternOperand::al}}}}},
+};
+
+#endif //COMPILER_INSTRUCTIONSELECTION_H
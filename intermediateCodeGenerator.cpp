@@ -25,7 +25,7 @@ FunctionCallExpr *ILGenerator::generateFunctionCallExprIL(NodeFunctionCallP func
     }
 
     return new FunctionCallExpr(funcCall->function->name, funcCall->function->returnType,
-                                funcCall->function->returnPtr);
+                                funcCall->function->returnPtr, (int) funcCall->function->params.size());
 }
 
 UniExpr *ILGenerator::convertTerminalToUniExpr(TerminalNodeExprP terminalExpr) {
@@ -75,6 +75,13 @@ TempAssignmentTAStmt *ILGenerator::generateBinaryTempAssignmentIL(UniExprP uniLh
     return new TempAssignmentTAStmt(incCurrentTemp(), new BinaryExpr(uniLhs, uniRhs, op));
 }
 
+std::unordered_set<ExprOperator> ILGenerator::commutativeOperators = {
+        ExprOperator::add,
+        ExprOperator::mult,
+        ExprOperator::equals,
+        ExprOperator::notEquals,
+};
+
 std::unordered_map<std::type_index, ExprOperator> ILGenerator::NodeExprToExprOperator = {
         {typeid(NodeAddExpr),             ExprOperator::add},
         {typeid(NodeSubExpr),             ExprOperator::sub},
@@ -95,36 +102,178 @@ void ILGenerator::generateBinaryExprIL(BinaryNodeExprP binExpr) {
     // Determine the operator of the binary expression
     ExprOperator op = NodeExprToExprOperator[typeid(*binExpr)];
 
-    // Get pointers to the left and right terminal nodes of the binary expression
-    auto lhs = dynamic_cast<TerminalNodeExprP>(binExpr->left);
-    auto rhs = dynamic_cast<TerminalNodeExprP>(binExpr->right);
+    if (shortCircuits(binExpr)) {
+        generateShortCircuitIL(binExpr);
+        return;
+    }
 
     // Pointers to store the converted intermediate expressions for the left and right operands
     UniExprP uniLhs, uniRhs;
 
-    // Convert operands to intermediate representations based on their types
-    if (lhs && rhs) {
-        // Both operands are terminal nodes
-        uniLhs = this->convertTerminalToUniExpr(lhs);
-        uniRhs = this->convertTerminalToUniExpr(rhs);
-    } else if (lhs) {
-        // Only the left operand is a terminal node
-        uniLhs = this->convertTerminalToUniExpr(lhs);
+    if (evaluateRightFirst(binExpr)) {
+        // The right operand's result stays in its temporary while the left operand is evaluated above it, so
+        // the result goes there
         uniRhs = generateNumericExprIL(binExpr->right);
-    } else if (rhs) {
-        // Only the right operand is a terminal node
-        uniLhs = generateNumericExprIL(binExpr->left);
-        uniRhs = this->convertTerminalToUniExpr(rhs);
-    } else {
-        // Both operands are non-terminal nodes
+
+        int rhsTemp = this->currentTemp;
+
         uniLhs = generateNumericExprIL(binExpr->left);
-        uniRhs = generateNumericExprIL(binExpr->right);
+        this->currentTemp = rhsTemp;
+        this->ilStmts.push_back(new TempAssignmentTAStmt(rhsTemp, new BinaryExpr(uniLhs, uniRhs, op)));
+        return;
+    }
+
+    // Convert the operands in order, terminal operands are converted without generating statements
+    uniLhs = generateNumericExprIL(binExpr->left);
+    uniRhs = generateNumericExprIL(binExpr->right);
+
+    // A constant operand of a commutative operator goes on the right, where the optimizer looks for it
+    if (commutativeOperators.contains(op) && dynamic_cast<ImIntValP>(uniLhs) && !dynamic_cast<ImIntValP>(uniRhs)) {
+        std::swap(uniLhs, uniRhs);
     }
 
     // Generate a temporary assignment statement with the converted operands and operator
     this->ilStmts.push_back(generateBinaryTempAssignmentIL(uniLhs, uniRhs, op));
 }
 
+int ILGenerator::tempsNeeded(NodeExprP expr) {
+    if (auto binExpr = dynamic_cast<BinaryNodeExprP>(expr)) {
+        int left = tempsNeeded(binExpr->left);
+        int right = tempsNeeded(binExpr->right);
+
+        // The operands are evaluated one at a time above the result's temporary
+        if (shortCircuits(binExpr)) return std::max(left, right) + 1;
+
+        // The result of the operand evaluated first holds a temporary while the other one is evaluated
+        if (evaluateRightFirst(binExpr)) return std::max(right, left + 1);
+        if (left > 0) return std::max(left, right + 1);
+
+        return std::max(right, 1);
+    } else if (auto unary = dynamic_cast<UnaryNodeExprP>(expr)) {
+        return tempsNeeded(unary->expr);
+    } else if (auto funcCall = dynamic_cast<NodeFunctionCallP>(expr)) {
+        // Each parameter is evaluated from the same temporary and pushed before the next one
+        int needed = 1;
+
+        for (auto param: funcCall->params) {
+            needed = std::max(needed, tempsNeeded(param));
+        }
+
+        return needed;
+    } else if (auto subVar = dynamic_cast<NodeSubscriptableVariableTerminalP>(expr)) {
+        if (dynamic_cast<NodeImIntTerminalP>(subVar->index)) return 0;
+
+        return std::max(tempsNeeded(subVar->index), 1);
+    } else if (auto addrVar = dynamic_cast<AddrVarNodeExpr *>(expr)) {
+        auto sub = dynamic_cast<NodeSubscriptableVariableTerminalP>(addrVar->target);
+
+        return sub ? tempsNeeded(sub->index) : 0;
+    }
+
+    return 0;
+}
+
+bool ILGenerator::containsCall(NodeExprP expr) {
+    if (auto binExpr = dynamic_cast<BinaryNodeExprP>(expr)) {
+        return containsCall(binExpr->left) || containsCall(binExpr->right);
+    } else if (auto unary = dynamic_cast<UnaryNodeExprP>(expr)) {
+        return containsCall(unary->expr);
+    } else if (auto subVar = dynamic_cast<NodeSubscriptableVariableTerminalP>(expr)) {
+        return containsCall(subVar->index);
+    } else if (auto addrVar = dynamic_cast<AddrVarNodeExpr *>(expr)) {
+        return containsCall(addrVar->target);
+    }
+
+    return dynamic_cast<NodeFunctionCallP>(expr) != nullptr;
+}
+
+bool ILGenerator::evaluateRightFirst(BinaryNodeExprP binExpr) {
+    // Calls keep their order, their side effects may be seen by the other operand
+    if (containsCall(binExpr->left) || containsCall(binExpr->right)) return false;
+
+    int left = tempsNeeded(binExpr->left);
+
+    return left > 0 && tempsNeeded(binExpr->right) > left;
+}
+
+bool ILGenerator::shortCircuits(BinaryNodeExprP binExpr) {
+    ExprOperator op = NodeExprToExprOperator[typeid(*binExpr)];
+
+    if (op != ExprOperator::logicalAnd && op != ExprOperator::logicalOr) return false;
+
+    NodeExprP right = binExpr->right;
+
+    while (auto paren = dynamic_cast<NodeParenthesisExprP>(right)) right = paren->expr;
+
+    // Reading a variable or a constant costs less than a jump over it
+    return !dynamic_cast<NodeImIntTerminalP>(right) &&
+           (!dynamic_cast<NodeVariableTerminalP>(right) || dynamic_cast<NodeSubscriptableVariableTerminalP>(right));
+}
+
+void ILGenerator::generateConditionIL(NodeExprP expr, const std::string &label, bool jumpIfTrue) {
+    if (auto paren = dynamic_cast<NodeParenthesisExprP>(expr)) {
+        generateConditionIL(paren->expr, label, jumpIfTrue);
+        return;
+    } else if (auto logicalNot = dynamic_cast<NodeLogicalNotExprP>(expr)) {
+        generateConditionIL(logicalNot->expr, label, !jumpIfTrue);
+        return;
+    } else if (auto binExpr = dynamic_cast<BinaryNodeExprP>(expr)) {
+        ExprOperator op = NodeExprToExprOperator[typeid(*binExpr)];
+
+        if (op == ExprOperator::logicalAnd || op == ExprOperator::logicalOr) {
+            // The left operand decides an 'and' when it is false and an 'or' when it is true
+            bool decidingValue = op == ExprOperator::logicalOr;
+
+            if (decidingValue == jumpIfTrue) {
+                // Deciding the condition jumps, otherwise the right operand decides it
+                generateConditionIL(binExpr->left, label, jumpIfTrue);
+                generateConditionIL(binExpr->right, label, jumpIfTrue);
+            } else {
+                // Deciding the condition falls through, skipping the right operand
+                std::string skipLabel = currentFunctionName + "Cond" + std::to_string(++currentCondId) + "Skip";
+
+                generateConditionIL(binExpr->left, skipLabel, decidingValue);
+                generateConditionIL(binExpr->right, label, jumpIfTrue);
+                this->ilStmts.push_back(new LabelStmt(skipLabel));
+            }
+
+            return;
+        }
+    }
+
+    // The value of the condition is only needed by the jump, its temporaries are freed after it
+    int conditionTemp = this->currentTemp;
+    UniExprP condition = generateNumericExprIL(expr);
+
+    if (jumpIfTrue) {
+        this->ilStmts.push_back(new GotoIfNotZeroStmt(label, condition));
+    } else {
+        this->ilStmts.push_back(new GotoIfZeroStmt(label, condition));
+    }
+
+    this->currentTemp = conditionTemp;
+}
+
+void ILGenerator::generateShortCircuitIL(BinaryNodeExprP binExpr) {
+    bool isOr = NodeExprToExprOperator[typeid(*binExpr)] == ExprOperator::logicalOr;
+    std::string condName = currentFunctionName + "Cond" + std::to_string(++currentCondId);
+    std::string decidedLabel = condName + "Decided";
+    std::string endLabel = condName + "End";
+    int resultTemp = incCurrentTemp();
+
+    // Either operand being true decides an 'or', either being false decides an 'and'
+    generateConditionIL(binExpr->left, decidedLabel, isOr);
+    generateConditionIL(binExpr->right, decidedLabel, isOr);
+
+    this->ilStmts.push_back(new TempAssignmentTAStmt(resultTemp, new ImIntVal(isOr ? "0" : "1")));
+    this->ilStmts.push_back(new GotoStmt(endLabel));
+    this->ilStmts.push_back(new LabelStmt(decidedLabel));
+    this->ilStmts.push_back(new TempAssignmentTAStmt(resultTemp, new ImIntVal(isOr ? "1" : "0")));
+    this->ilStmts.push_back(new LabelStmt(endLabel));
+
+    this->currentTemp = resultTemp;
+}
+
 UniExpr *ILGenerator::generateUnaryExprIL(UnaryNodeExprP unaryExpr) {
     UniExpr *innerUni = generateNumericExprIL(unaryExpr->expr);
 
@@ -205,8 +354,8 @@ void ILGenerator::generateStmtIL(NodeStmtP stmt) {
 
         this->ilStmts.push_back(new LabelStmt(ifName));
 
-        // Emit conditional jump based on the 'if' condition
-        this->ilStmts.push_back(new GotoIfZeroStmt(elseLabel, generateNumericExprIL(ifStmt->expr)));
+        // Emit conditional jumps to the 'else' block when the condition is false
+        generateConditionIL(ifStmt->expr, elseLabel, false);
 
         // Generate IL for the 'if' block
         generateScopeIL(ifStmt->ifBlock);
@@ -242,8 +391,8 @@ void ILGenerator::generateStmtIL(NodeStmtP stmt) {
         // Could be affected by the recursive call to 'generateScopeIL'
         currentTemp = 0;
 
-        // Emit conditional jump back to the loop body if the condition is true
-        this->ilStmts.push_back(new GotoIfNotZeroStmt(bodyLabel, generateNumericExprIL(whileStmt->expr)));
+        // Emit conditional jumps back to the loop body if the condition is true
+        generateConditionIL(whileStmt->expr, bodyLabel, true);
     } else if (auto returnStmt = dynamic_cast<NodeReturnStmtP>(stmt)) {
         if (returnStmt->expr) {
             this->ilStmts.push_back(new SetReturnValueStmt(generateExprIL(returnStmt->expr)));
@@ -267,11 +416,14 @@ void ILGenerator::generateScopeIL(NodeScopeP scope) {
 
 void ILGenerator::generateFunctionIL(NodeFunctionP function) {
     auto funcDecStmt = new FunctionDeclarationStmt(function->name, function->params);
+    funcDecStmt->retType = function->returnType;
+    funcDecStmt->retPtr = function->returnPtr;
 
     // Reset temporary counters and identifiers
     this->maxTemp = 0;
     this->currentIfId = 0;
     this->currentWhileId = 0;
+    this->currentCondId = 0;
     this->currentFunctionName = function->name;
 
     this->ilStmts.push_back(funcDecStmt);
@@ -294,6 +446,10 @@ ThreeAddressProgram *ILGenerator::generateProgramIL() {
         }
     }
 
+    return new ThreeAddressProgram(this->ilStmts, this->builtinFunctionsUsed, this->stringLiteralsUsed);
+}
+
+void ILGenerator::writeProgramIL(ThreeAddressProgramP ilProgram) {
     std::ofstream outFile(this->outfileName);
 
     if (outFile.fail()) {
@@ -303,20 +459,18 @@ ThreeAddressProgram *ILGenerator::generateProgramIL() {
 
     outFile << "Start string literals definition\n";
 
-    for (const auto &literal: stringLiteralsUsed) {
+    for (const auto &literal: ilProgram->stringLiteralsUsed) {
         outFile << literal.first << " = '" << literal.second << "'\n";
     }
 
     outFile << "End string literals definition\n";
 
-    // Write each generated statement to the output file
-    for (ThreeAddressStmt *tasP: this->ilStmts) {
+    // Write each statement to the output file
+    for (ThreeAddressStmt *tasP: ilProgram->ilStmts) {
         outFile << ilStmtToStr(tasP);
     }
 
     outFile.close();
-
-    return new ThreeAddressProgram(this->ilStmts, this->builtinFunctionsUsed, this->stringLiteralsUsed);
 }
 
 int ILGenerator::incCurrentTemp() {
@@ -342,6 +496,20 @@ std::unordered_map<ExprOperator, std::string> ILGenerator::exprOperatorToStr = {
         {ExprOperator::lessThanEquals,   " <= "},
 };
 
+std::unordered_map<VectorOperator, std::string> ILGenerator::vectorOperatorToStr = {
+        {VectorOperator::add, " + "},
+        {VectorOperator::sub, " - "},
+        {VectorOperator::min, "Min "},
+        {VectorOperator::max, "Max "},
+};
+
+std::string ILGenerator::vectorShapeToStr(VectorStmtP vectorStmt, const std::string &kind) {
+    int elementBits = vectorStmt->elementType == VariableType::longType ? 64 :
+                      vectorStmt->elementType == VariableType::intType ? 32 : 8;
+
+    return kind + "<" + std::to_string(vectorStmt->width * 8 / elementBits) + " x i" + std::to_string(elementBits) + ">";
+}
+
 std::string ILGenerator::ilExprToStr(ThreeAddressExprP taExpr) {
     std::stringstream strStream;
 
@@ -366,6 +534,9 @@ std::string ILGenerator::ilExprToStr(ThreeAddressExprP taExpr) {
                   << ilExprToStr(binary->right);
     } else if (auto functionCall = dynamic_cast<FunctionCallExprP>(taExpr)) {
         strStream << "RetValOf Call " << functionCall->functionName;
+    } else if (auto select = dynamic_cast<SelectExprP>(taExpr)) {
+        strStream << ilExprToStr(select->comparison) << " ? " << ilExprToStr(select->trueValue) << " : "
+                  << ilExprToStr(select->falseValue);
     }
 
     return strStream.str();
@@ -381,7 +552,7 @@ std::string ILGenerator::ilStmtToStr(ThreeAddressStmtP taStmt) {
     } else if (auto functionParamPush = dynamic_cast<FunctionParamPushStmtP>(taStmt)) {
         strStream << "PushParam " << ilExprToStr(functionParamPush->expr);
     } else if (auto functionCall = dynamic_cast<FunctionCallExprP>(taStmt)) {
-        strStream << "Call " << functionCall->functionName;
+        strStream << (functionCall->tailCall ? "TailCall " : "Call ") << functionCall->functionName;
     } else if (auto labelStmt = dynamic_cast<LabelStmtP>(taStmt)) {
         strStream << labelStmt->labelName << ":";
     } else if (auto gotoStmt = dynamic_cast<GotoStmtP>(taStmt)) {
@@ -390,6 +561,8 @@ std::string ILGenerator::ilStmtToStr(ThreeAddressStmtP taStmt) {
         strStream << "GotoIfZero " << ilExprToStr(gotoIfZeroStmt->expr) << " " << gotoIfZeroStmt->labelName;
     } else if (auto gotoIfNotZeroStmt = dynamic_cast<GotoIfNotZeroStmtP>(taStmt)) {
         strStream << "GotoIfNotZero " << ilExprToStr(gotoIfNotZeroStmt->expr) << " " << gotoIfNotZeroStmt->labelName;
+    } else if (auto gotoIfCompareStmt = dynamic_cast<GotoIfCompareStmtP>(taStmt)) {
+        strStream << "GotoIf " << ilExprToStr(gotoIfCompareStmt->comparison) << " " << gotoIfCompareStmt->labelName;
     } else if (auto setReturnValue = dynamic_cast<SetReturnValueStmtP>(taStmt)) {
         strStream << "SetReturnValue " << ilExprToStr(setReturnValue->expr);
     } else if (auto scopeEnter = dynamic_cast<ScopeEnterStmtP>(taStmt)) {
@@ -404,15 +577,54 @@ std::string ILGenerator::ilStmtToStr(ThreeAddressStmtP taStmt) {
         strStream << "ScopeExit";
     } else if (auto functionDeclaration = dynamic_cast<FunctionDeclarationStmtP>(taStmt)) {
         strStream << "Function " << functionDeclaration->name << "  MaxTemp: "
-                  << std::to_string(functionDeclaration->maxTemp) << " Params: ";
+                  << std::to_string(functionDeclaration->maxTemp) << " Frame: " << functionDeclaration->frameSize
+                  << " Params: ";
 
         for (const auto &params: functionDeclaration->params) {
             strStream << params.name << " ";
         }
 
         if (functionDeclaration->params.empty()) strStream << "none";
+
+        if (!functionDeclaration->registerVars.empty()) {
+            strStream << " Registers: ";
+
+            for (const auto &registerVar: functionDeclaration->registerVars) {
+                strStream << registerVar.name << " ";
+            }
+        }
+
+        if (functionDeclaration->leaf) strStream << " Leaf";
+
+        if (functionDeclaration->memoRange > 0) {
+            strStream << " Memoized: range " << functionDeclaration->memoRange << " entry temp"
+                      << functionDeclaration->memoTemp;
+        }
     } else if (auto functionExit = dynamic_cast<FunctionExitStmtP>(taStmt)) {
         strStream << "EndFunction";
+    } else if (auto vectorLoad = dynamic_cast<VectorLoadStmtP>(taStmt)) {
+        strStream << "vec" << vectorLoad->reg << " := " << vectorShapeToStr(vectorLoad, "Vector") << " "
+                  << ilExprToStr(vectorLoad->source);
+    } else if (auto vectorStore = dynamic_cast<VectorStoreStmtP>(taStmt)) {
+        strStream << vectorShapeToStr(vectorStore, "Vector") << " " << ilExprToStr(vectorStore->target)
+                  << " = vec" << vectorStore->reg;
+    } else if (auto vectorBroadcast = dynamic_cast<VectorBroadcastStmtP>(taStmt)) {
+        strStream << "vec" << vectorBroadcast->reg << " := " << vectorShapeToStr(vectorBroadcast, "Vector")
+                  << " Broadcast " << ilExprToStr(vectorBroadcast->value);
+    } else if (auto vectorBinary = dynamic_cast<VectorBinaryStmtP>(taStmt)) {
+        strStream << "vec" << vectorBinary->reg << " := " << vectorShapeToStr(vectorBinary, "Vector") << " ";
+
+        if (vectorBinary->op == VectorOperator::add || vectorBinary->op == VectorOperator::sub) {
+            strStream << "vec" << vectorBinary->left << vectorOperatorToStr[vectorBinary->op]
+                      << "vec" << vectorBinary->right;
+        } else {
+            strStream << vectorOperatorToStr[vectorBinary->op] << "vec" << vectorBinary->left
+                      << " vec" << vectorBinary->right;
+        }
+    } else if (auto vectorReduce = dynamic_cast<VectorReduceStmtP>(taStmt)) {
+        strStream << "temp" << vectorReduce->id << " := " << vectorShapeToStr(vectorReduce, "Reduce") << " "
+                  << (vectorReduce->op == VectorOperator::add ? "Sum " : vectorOperatorToStr[vectorReduce->op])
+                  << "vec" << vectorReduce->reg;
     }
 
     strStream << std::endl;
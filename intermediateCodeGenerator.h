@@ -12,6 +12,7 @@
 #include <fstream>
 #include <list>
 #include <unordered_map>
+#include <unordered_set>
 #include "treeNodes.h"
 #include "threeAddressExpressionsAndStatements.h"
 #include "errorHandling.h"
@@ -50,12 +51,22 @@ public:
      * @brief Generates the intermediate code (IL) for the entire program.
      *
      * This method iterates over each function in the program and generates intermediate code
-     * for each function. It then writes the generated intermediate code statements to an
+     * for each function.
+     *
+     * @return The generated IL program.
+     */
+    ThreeAddressProgram *generateProgramIL();
+
+    /**
+     * @brief Writes the IL program's string literals and statements to the
      * output file specified during object creation.
      *
+     * Called after the optimization passes so the file shows the IL the code generator receives.
+     *
+     * @param ilProgram The IL program to write.
      * @throws CompilationException if there is an error opening the output file.
      */
-    ThreeAddressProgram *generateProgramIL();
+    void writeProgramIL(ThreeAddressProgramP ilProgram);
 
     /**
      * @brief Generates intermediate code (IL) for a specific function.
@@ -112,8 +123,11 @@ public:
 private:
     // Map to associate node expression types with their corresponding expression operators
     static std::unordered_map<std::type_index, ExprOperator> NodeExprToExprOperator;
+    // Operators whose operands can be swapped, the logical operators are left out as they may short-circuit
+    static std::unordered_set<ExprOperator> commutativeOperators;
     // Map to associate expression operators with their string representations
     static std::unordered_map<ExprOperator, std::string> exprOperatorToStr;
+    static std::unordered_map<VectorOperator, std::string> vectorOperatorToStr;
 
     // The abstract syntax tree of the program
     ProgramTreeP program;
@@ -126,6 +140,8 @@ private:
     int currentIfId = 0;
     // Counter for generating unique identifiers for while statements
     int currentWhileId = 0;
+    // Counter for generating unique identifiers for short-circuit conditions
+    int currentCondId = 0;
     // Counter for generating temporary variables for expression generating
     int currentTemp = 0;
     // Maximum temporary variable identifier used in each function (getting zeroed each function generation)
@@ -164,12 +180,58 @@ private:
      * @brief Generates intermediate code for a binary expression.
      *
      * Converts the operands into appropriate intermediate representations and creates a
-     * temporary assignment statement.
+     * temporary assignment statement. The operand needing more temporaries is converted first (Sethi-Ullman
+     * ordering), so fewer temporaries are alive at once.
      *
      * @param binExpr Pointer to a BinaryNodeExprP object representing the binary expression.
      */
     void generateBinaryExprIL(BinaryNodeExprP);
 
+    /**
+     * @brief Computes the number of temporaries alive at once while an expression is generated (its Sethi-Ullman
+     * number), 0 for expressions generated without temporaries.
+     */
+    static int tempsNeeded(NodeExprP expr);
+
+    /**
+     * @brief Checks if an expression calls a function.
+     */
+    static bool containsCall(NodeExprP expr);
+
+    /**
+     * @brief Checks if the right operand of a binary expression should be generated before the left one, when both
+     * need temporaries, the right one needs more and neither calls a function.
+     */
+    static bool evaluateRightFirst(BinaryNodeExprP binExpr);
+
+    /**
+     * @brief Checks if a logical operator has to be generated as control flow, the right operand is only
+     * evaluated when the left one doesn't decide the result. A plain variable or constant on the right is
+     * read together with the left operand instead.
+     */
+    static bool shortCircuits(BinaryNodeExprP binExpr);
+
+    /**
+     * @brief Generates a chain of conditional jumps for a condition instead of materializing its value.
+     *
+     * Logical operators and negations are lowered to jumps, so an operand is only evaluated when the
+     * operands before it don't decide the condition.
+     *
+     * @param expr The condition to generate.
+     * @param label The label to jump to.
+     * @param jumpIfTrue Jump when the condition is true if set, when it is false otherwise. Falls through in
+     * the other case.
+     */
+    void generateConditionIL(NodeExprP expr, const std::string &label, bool jumpIfTrue);
+
+    /**
+     * @brief Generates the value (0 or 1) of a short-circuit logical expression into a new temporary, using
+     * conditional jumps to skip the right operand when the left one decides the result.
+     *
+     * @param binExpr The logical and/or expression.
+     */
+    void generateShortCircuitIL(BinaryNodeExprP binExpr);
+
     /**
      * @brief Generates intermediate representation (IL) for a unary expression.
      * @param unaryExpr The unary expression to process.
@@ -219,6 +281,15 @@ private:
      * @return The string representation of the Three Address Expression.
      */
     static std::string ilExprToStr(ThreeAddressExpr *);
+
+    /**
+     * Converts the lanes of a vector statement to a string such as 'Vector<4 x i32>'.
+     *
+     * @param vectorStmt The vector statement.
+     * @param kind The kind of statement written before the lanes.
+     * @return The string representation of the lanes.
+     */
+    static std::string vectorShapeToStr(VectorStmt *, const std::string &kind);
 };
 
 #endif //COMPILER_INTERMEDIATECODEGENERATOR_H
@@ -0,0 +1,179 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#include "machineInstructions.h"
+
+std::unordered_map<std::string, std::pair<std::string, int>> MachineOperand::generalRegisters = [] {
+    std::unordered_map<std::string, std::pair<std::string, int>> registers;
+
+    // 'rax', 'eax', 'ax' and 'al' for each of the 'a', 'b', 'c' and 'd' registers
+    for (std::string name: {"a", "b", "c", "d"}) {
+        std::string full = "r" + name + "x";
+
+        registers[full] = {full, 8};
+        registers["e" + name + "x"] = {full, 4};
+        registers[name + "x"] = {full, 2};
+        registers[name + "l"] = {full, 1};
+    }
+
+    for (std::string name: {"si", "di", "bp", "sp"}) {
+        std::string full = "r" + name;
+
+        registers[full] = {full, 8};
+        registers["e" + name] = {full, 4};
+        registers[name] = {full, 2};
+        registers[name + "l"] = {full, 1};
+    }
+
+    for (int i = 8; i < 16; ++i) {
+        std::string full = "r" + std::to_string(i);
+
+        registers[full] = {full, 8};
+        registers[full + "d"] = {full, 4};
+        registers[full + "w"] = {full, 2};
+        registers[full + "b"] = {full, 1};
+    }
+
+    return registers;
+}();
+
+std::unordered_map<int, std::string> MachineOperand::memorySizes = {
+        {1,  "BYTE"},
+        {2,  "WORD"},
+        {4,  "DWORD"},
+        {8,  "QWORD"},
+        {16, "OWORD"},
+        {32, "YWORD"}
+};
+
+MachineOperand MachineOperand::makeReg(const std::string &name) {
+    MachineOperand operand;
+
+    operand.kind = MachineOperandKind::reg;
+    operand.name = name;
+    operand.size = registerSize(name);
+    return operand;
+}
+
+MachineOperand MachineOperand::makeImm(long long value) {
+    MachineOperand operand;
+
+    operand.value = value;
+    return operand;
+}
+
+MachineOperand MachineOperand::makeMem(int size, const std::string &base, long long displacement,
+                                       const std::string &index, int scale) {
+    MachineOperand operand;
+
+    operand.kind = MachineOperandKind::mem;
+    operand.size = size;
+    operand.base = base;
+    operand.value = displacement;
+    operand.index = index;
+    operand.scale = scale;
+    return operand;
+}
+
+MachineOperand MachineOperand::makeLabel(const std::string &name) {
+    MachineOperand operand;
+
+    operand.kind = MachineOperandKind::label;
+    operand.name = name;
+    return operand;
+}
+
+int MachineOperand::registerSize(const std::string &name) {
+    if (generalRegisters.contains(name)) return generalRegisters[name].second;
+
+    if (name.size() > 3 && (name.starts_with("xmm") || name.starts_with("ymm")) &&
+        name.find_first_not_of("0123456789", 3) == std::string::npos) {
+        return name[0] == 'y' ? 32 : 16;
+    }
+
+    return 0;
+}
+
+std::string MachineOperand::fullRegister(const std::string &name) {
+    if (generalRegisters.contains(name)) return generalRegisters[name].first;
+
+    // 'xmmN' is the lower half of 'ymmN'
+    if (registerSize(name) > 0) return "xmm" + name.substr(3);
+
+    return "";
+}
+
+std::string MachineOperand::partialRegister(const std::string &fullName, int size) {
+    for (const auto &[name, reg]: generalRegisters) {
+        if (reg.first == fullName && reg.second == size) return name;
+    }
+
+    return "";
+}
+
+std::string MachineOperand::fullReg() const {
+    return isReg() ? fullRegister(name) : "";
+}
+
+std::vector<std::string> MachineOperand::addressRegs() const {
+    std::vector<std::string> regs;
+
+    if (!isMem()) return regs;
+
+    if (!base.empty()) regs.push_back(fullRegister(base));
+    if (!index.empty()) regs.push_back(fullRegister(index));
+
+    return regs;
+}
+
+std::string MachineOperand::toString() const {
+    if (kind == MachineOperandKind::reg || kind == MachineOperandKind::label) return name;
+
+    if (kind == MachineOperandKind::imm) return std::to_string(value);
+
+    // The data item or the base register, the scaled index and then the displacement
+    std::string address = name.empty() ? base : (base.empty() ? name : name + " + " + base);
+
+    if (!index.empty()) {
+        address += (address.empty() ? "" : " + ") + index + (scale != 1 ? " * " + std::to_string(scale) : "");
+    }
+
+    if (address.empty()) {
+        address = std::to_string(value);
+    } else if (value != 0) {
+        address += (value > 0 ? " + " : " - ") + std::to_string(value > 0 ? value : -value);
+    }
+
+    return (size > 0 ? memorySizes[size] + " [" : "[") + address + "]";
+}
+
+MachineInstr MachineInstr::makeLabel(const std::string &label, const std::string &comment) {
+    MachineInstr instr;
+
+    instr.label = label;
+    instr.comment = comment;
+    return instr;
+}
+
+std::string MachineInstr::toString() const {
+    std::string line = isLabel() ? label + ":" : opcode;
+
+    for (size_t i = 0; i < operands.size(); ++i) {
+        line += (i == 0 ? " " : ", ") + operands[i].toString();
+    }
+
+    if (!comment.empty()) {
+        line += (isLabel() ? "     ; " : (line.empty() ? "; " : "  ; ")) + comment;
+    }
+
+    return line;
+}
+
+void MachineFunction::print(std::ostream &out) const {
+    for (const auto &instr: instrs) {
+        out << instr.toString() << "\n";
+    }
+
+    out << "\n";
+}
@@ -0,0 +1,190 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#ifndef COMPILER_MACHINEINSTRUCTIONS_H
+#define COMPILER_MACHINEINSTRUCTIONS_H
+
+#include <string>
+#include <vector>
+#include <ostream>
+#include <unordered_map>
+#include <utility>
+
+/**
+ * @brief The kinds of operands of a machine instruction.
+ */
+enum class MachineOperandKind {
+    reg,
+    imm,
+    mem,
+    // A symbol used as a value or a jump target, like a label or a data item
+    label,
+};
+
+/**
+ * @brief Represents an operand of a machine instruction.
+ *
+ * A memory operand addresses 'symbol + base + index * scale + value', any of its parts may be left out.
+ */
+class MachineOperand {
+public:
+    MachineOperandKind kind = MachineOperandKind::imm;
+    // The register of a register operand, the symbol of a label operand or the data item a memory operand is in
+    std::string name;
+    // The value of an immediate, the displacement of a memory operand
+    long long value = 0;
+    // The size in bytes of a register or a memory operand, 0 if not given (immediates, labels, 'lea' addresses and
+    // the memory of the vector moves, whose register gives its size)
+    int size = 0;
+    // The registers the address of a memory operand is computed from, empty if not used
+    std::string base;
+    std::string index;
+    int scale = 1;
+
+    /**
+     * @brief Creates a register operand, its size is the register's.
+     *
+     * @param name The register, a part of a general purpose register ('eax') or a vector register.
+     */
+    static MachineOperand makeReg(const std::string &name);
+
+    /**
+     * @brief Creates an immediate operand.
+     */
+    static MachineOperand makeImm(long long value);
+
+    /**
+     * @brief Creates a memory operand.
+     *
+     * @param size The size of the accessed memory in bytes, 0 to leave it out.
+     * @param base The base register, empty for none.
+     * @param displacement The constant added to the address.
+     * @param index The index register, empty for none.
+     * @param scale The factor of the index register: 1, 2, 4 or 8.
+     */
+    static MachineOperand makeMem(int size, const std::string &base, long long displacement,
+                                  const std::string &index = "", int scale = 1);
+
+    /**
+     * @brief Creates a label operand, the target of a jump or a call or the address of a data item.
+     */
+    static MachineOperand makeLabel(const std::string &name);
+
+    bool isReg() const {
+        return kind == MachineOperandKind::reg;
+    }
+
+    bool isMem() const {
+        return kind == MachineOperandKind::mem;
+    }
+
+    bool isImm() const {
+        return kind == MachineOperandKind::imm;
+    }
+
+    bool operator==(const MachineOperand &other) const = default;
+
+    /**
+     * @brief Returns the 64 bit register a register operand is a part of ('eax' and 'al' are parts of 'rax'),
+     * a vector register is returned by the name of its 16 byte part.
+     */
+    std::string fullReg() const;
+
+    /**
+     * @brief Returns the 64 bit registers the address of a memory operand is computed from.
+     */
+    std::vector<std::string> addressRegs() const;
+
+    /**
+     * @brief Returns the operand as written in the assembly, a memory operand with its size identifier.
+     */
+    std::string toString() const;
+
+    /**
+     * @brief Returns the size in bytes of a register by its name, 0 if it isn't a register.
+     */
+    static int registerSize(const std::string &name);
+
+    /**
+     * @brief Returns the 64 bit register a register name is a part of, an empty string if it isn't a register.
+     */
+    static std::string fullRegister(const std::string &name);
+
+    /**
+     * @brief Returns the part of a general purpose 64 bit register of the given size ('eax' for 'rax' and 4).
+     */
+    static std::string partialRegister(const std::string &fullName, int size);
+
+private:
+    // Map from the names of the general purpose registers to their 64 bit register and their size
+    static std::unordered_map<std::string, std::pair<std::string, int>> generalRegisters;
+    // Map from the sizes of memory operands to their size identifiers
+    static std::unordered_map<int, std::string> memorySizes;
+};
+
+/**
+ * @brief Represents a single line of a function's machine code: an instruction or a label.
+ */
+class MachineInstr {
+public:
+    // The label defined by the line, empty for an instruction
+    std::string label;
+    std::string opcode;
+    std::vector<MachineOperand> operands;
+    // A comment written after the line, without the ';'
+    std::string comment;
+
+    MachineInstr() = default;
+
+    /**
+     * @brief Constructor for the MachineInstr class, an instruction.
+     *
+     * @param opcode The instruction's mnemonic.
+     * @param operands The operands, the destination first.
+     */
+    MachineInstr(std::string opcode, std::vector<MachineOperand> operands)
+            : opcode(std::move(opcode)), operands(std::move(operands)) {
+
+    }
+
+    /**
+     * @brief Creates a line defining a label.
+     *
+     * @param label The label's name.
+     * @param comment A comment written after it, empty for none.
+     */
+    static MachineInstr makeLabel(const std::string &label, const std::string &comment = "");
+
+    bool isLabel() const {
+        return !label.empty();
+    }
+
+    /**
+     * @brief Returns the line of assembly of the instruction or the label.
+     */
+    std::string toString() const;
+};
+
+/**
+ * @brief The machine code of a function, a list of instructions and labels the backend passes can rewrite
+ * before the assembly is written out.
+ */
+class MachineFunction {
+public:
+    std::string name;
+    std::vector<MachineInstr> instrs;
+
+    explicit MachineFunction(std::string name) : name(std::move(name)) {
+
+    }
+
+    /**
+     * @brief Writes the function's assembly, followed by an empty line.
+     *
+     * @param out The stream the assembly is written to.
+     */
+    void print(std::ostream &out) const;
+};
+
+#endif //COMPILER_MACHINEINSTRUCTIONS_H
@@ -0,0 +1,307 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#include "peepholeOptimizer.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <unordered_set>
+
+const std::array<PeepholeRule, 7> PeepholeOptimizer::rules = {{
+        {"store-reload",        forwardStoreToLoad},
+        {"self-move",           removeSelfMove},
+        {"jump-to-next",        removeJumpToNext},
+        {"branch-over-jump",    invertBranchOverJump},
+        {"unreachable",         removeUnreachable},
+        {"stack-adjustments",   foldStackAdjustments},
+        {"zero-idiom",          useZeroIdiom}
+}};
+
+std::unordered_map<std::string, std::string> PeepholeOptimizer::invertedConditions = {
+        {"e",  "ne"},
+        {"ne", "e"},
+        {"z",  "nz"},
+        {"nz", "z"},
+        {"g",  "le"},
+        {"le", "g"},
+        {"ge", "l"},
+        {"l",  "ge"},
+        {"a",  "be"},
+        {"be", "a"},
+        {"ae", "b"},
+        {"b",  "ae"},
+        {"s",  "ns"},
+        {"ns", "s"}
+};
+
+void PeepholeOptimizer::optimizeFunction(MachineFunction &function) {
+    bool changed = true;
+
+    while (changed) {
+        changed = false;
+
+        for (size_t pos = 0; pos < function.instrs.size(); ++pos) {
+            for (size_t rule = 0; rule < rules.size() && pos < function.instrs.size(); ++rule) {
+                if (rules[rule].apply(function.instrs, pos)) {
+                    hits[rule]++;
+                    changed = true;
+                }
+            }
+        }
+    }
+}
+
+void PeepholeOptimizer::printStats(std::ostream &out) const {
+    for (size_t rule = 0; rule < rules.size(); ++rule) {
+        out << "peephole " << rules[rule].name << ": " << hits[rule] << std::endl;
+    }
+}
+
+bool PeepholeOptimizer::forwardStoreToLoad(std::vector<MachineInstr> &instrs, size_t pos) {
+    if (pos + 1 >= instrs.size()) return false;
+
+    const MachineInstr &store = instrs[pos];
+    MachineInstr &load = instrs[pos + 1];
+
+    if (store.opcode != "mov" || store.operands.size() != 2 || !store.operands[0].isMem() ||
+        !store.operands[1].isReg() || load.operands.size() != 2 || !load.operands[0].isReg() ||
+        load.operands[1] != store.operands[0]) {
+        return false;
+    }
+
+    const MachineOperand &dest = load.operands[0];
+    const MachineOperand &source = store.operands[1];
+
+    if (load.opcode == "mov") {
+        // Loading the stored register back to itself does nothing, a 32 bit load still clears the upper half
+        if (dest == source && dest.size == 8) {
+            instrs.erase(instrs.begin() + (long) pos + 1);
+        } else {
+            load = MachineInstr("mov", {dest, source});
+        }
+
+        return true;
+    } else if (load.opcode == "movsx" || load.opcode == "movsxd" || load.opcode == "movzx") {
+        // Sign extending a 32 bit register is 'movsxd', a zero extended 32 bit register is already extended
+        std::string opcode = load.opcode == "movzx" ? "movzx" : (store.operands[1].size == 4 ? "movsxd" : "movsx");
+
+        if (opcode == "movzx" && store.operands[1].size == 4) return false;
+
+        load = MachineInstr(opcode, {dest, source});
+        return true;
+    }
+
+    return false;
+}
+
+bool PeepholeOptimizer::removeSelfMove(std::vector<MachineInstr> &instrs, size_t pos) {
+    const MachineInstr &instr = instrs[pos];
+
+    // Moving a 32 bit register to itself clears its upper half, so only the 64 bit moves are removed
+    if (instr.opcode != "mov" || instr.operands.size() != 2 || !instr.operands[0].isReg() ||
+        instr.operands[0].size != 8 || instr.operands[0] != instr.operands[1]) {
+        return false;
+    }
+
+    instrs.erase(instrs.begin() + (long) pos);
+    return true;
+}
+
+bool PeepholeOptimizer::removeJumpToNext(std::vector<MachineInstr> &instrs, size_t pos) {
+    if (!isJump(instrs[pos])) return false;
+
+    const std::string &target = instrs[pos].operands[0].name;
+
+    for (size_t next = pos + 1; next < instrs.size() && instrs[next].isLabel(); ++next) {
+        if (instrs[next].label == target) {
+            instrs.erase(instrs.begin() + (long) pos);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool PeepholeOptimizer::invertBranchOverJump(std::vector<MachineInstr> &instrs, size_t pos) {
+    if (pos + 2 >= instrs.size() || !isJump(instrs[pos]) || instrs[pos].opcode == "jmp") return false;
+
+    MachineInstr &branch = instrs[pos];
+    const MachineInstr &jump = instrs[pos + 1];
+    std::string condition = branch.opcode.substr(1);
+
+    if (jump.opcode != "jmp" || !isJump(jump) || !instrs[pos + 2].isLabel() ||
+        instrs[pos + 2].label != branch.operands[0].name || !invertedConditions.contains(condition)) {
+        return false;
+    }
+
+    branch = MachineInstr("j" + invertedConditions[condition], {jump.operands[0]});
+    instrs.erase(instrs.begin() + (long) pos + 1);
+    return true;
+}
+
+bool PeepholeOptimizer::removeUnreachable(std::vector<MachineInstr> &instrs, size_t pos) {
+    if (instrs[pos].opcode != "jmp" && instrs[pos].opcode != "ret") return false;
+
+    // Only a label can be jumped to
+    size_t end = pos + 1;
+
+    while (end < instrs.size() && !instrs[end].isLabel()) ++end;
+
+    if (end == pos + 1) return false;
+
+    instrs.erase(instrs.begin() + (long) pos + 1, instrs.begin() + (long) end);
+    return true;
+}
+
+bool PeepholeOptimizer::foldStackAdjustments(std::vector<MachineInstr> &instrs, size_t pos) {
+    long long first, second;
+
+    if (!isStackAdjustment(instrs[pos], first)) return false;
+
+    size_t next = pos + 1;
+
+    // Find the next adjustment, no instruction in between may use the stack pointer or read the flags, which the
+    // next adjustment overwrites
+    for (; next < instrs.size() && !isStackAdjustment(instrs[next], second); ++next) {
+        const MachineInstr &instr = instrs[next];
+
+        if (instr.isLabel() || isJump(instr) || readsFlags(instr) || instr.opcode == "call" ||
+            instr.opcode == "ret" || instr.opcode == "push" || instr.opcode == "pop" || instr.opcode == "leave") {
+            return false;
+        }
+
+        for (const auto &operand: instr.operands) {
+            std::vector<std::string> addressRegs = operand.addressRegs();
+            bool addressesStack = std::find(addressRegs.begin(), addressRegs.end(), "rsp") != addressRegs.end();
+
+            if (operand.fullReg() == "rsp" || addressesStack || (first < 0 && operand.isMem())) {
+                return false;
+            }
+        }
+    }
+
+    if (next == instrs.size() || !flagsDeadAfter(instrs, next)) return false;
+
+    long long total = first + second;
+
+    if (total == 0) {
+        instrs.erase(instrs.begin() + (long) next);
+    } else {
+        instrs[next] = MachineInstr(total > 0 ? "add" : "sub",
+                                    {MachineOperand::makeReg("rsp"), MachineOperand::makeImm(std::abs(total))});
+    }
+
+    instrs.erase(instrs.begin() + (long) pos);
+    return true;
+}
+
+bool PeepholeOptimizer::useZeroIdiom(std::vector<MachineInstr> &instrs, size_t pos) {
+    const MachineInstr &instr = instrs[pos];
+
+    if (instr.opcode != "mov" || instr.operands.size() != 2 || !instr.operands[0].isReg() ||
+        instr.operands[0].size < 4 || instr.operands[0].size > 8 || !instr.operands[1].isImm() ||
+        instr.operands[1].value != 0 || !flagsDeadAfter(instrs, pos)) {
+        return false;
+    }
+
+    // Writing the 32 bit part of a register clears its upper half
+    MachineOperand reg = MachineOperand::makeReg(MachineOperand::partialRegister(instr.operands[0].fullReg(), 4));
+
+    instrs[pos] = MachineInstr("xor", {reg, reg});
+    return true;
+}
+
+bool PeepholeOptimizer::readsFlags(const MachineInstr &instr) {
+    const std::string &opcode = instr.opcode;
+
+    return (opcode.starts_with("j") && opcode != "jmp") || opcode.starts_with("set") || opcode.starts_with("cmov") ||
+           opcode == "adc" || opcode == "sbb";
+}
+
+bool PeepholeOptimizer::keepsCarry(const MachineInstr &instr) {
+    return instr.opcode == "inc" || instr.opcode == "dec";
+}
+
+bool PeepholeOptimizer::readsCarry(const MachineInstr &instr) {
+    static const std::unordered_set<std::string> carryConditions = {
+            "b", "ae", "a", "be", "c", "nc", "nae", "nb", "na", "nbe"
+    };
+    std::string condition;
+
+    if (instr.opcode == "adc" || instr.opcode == "sbb") return true;
+
+    if (instr.opcode.starts_with("j")) {
+        condition = instr.opcode.substr(1);
+    } else if (instr.opcode.starts_with("set")) {
+        condition = instr.opcode.substr(3);
+    } else if (instr.opcode.starts_with("cmov")) {
+        condition = instr.opcode.substr(4);
+    }
+
+    return carryConditions.contains(condition);
+}
+
+bool PeepholeOptimizer::writesFlags(const MachineInstr &instr) {
+    static const std::unordered_set<std::string> flagsWriters = {
+            "cmp", "test", "add", "sub", "and", "or", "xor", "neg", "imul", "idiv", "div"
+    };
+
+    // A shift by zero leaves the flags as they are
+    if (instr.opcode == "shl" || instr.opcode == "shr" || instr.opcode == "sar") {
+        return instr.operands.size() == 2 && instr.operands[1].isImm() && instr.operands[1].value != 0;
+    }
+
+    return flagsWriters.contains(instr.opcode);
+}
+
+bool PeepholeOptimizer::flagsDeadAfter(const std::vector<MachineInstr> &instrs, size_t pos) {
+    static const std::unordered_set<std::string> flagsPreserving = {
+            "mov", "movsx", "movsxd", "movzx", "lea", "push", "pop", "cqo", "cdq"
+    };
+
+    // Whether an 'inc' or 'dec' overwrote every flag but the carry flag
+    bool onlyCarryLeft = false;
+
+    for (size_t next = pos + 1; next < instrs.size(); ++next) {
+        const MachineInstr &instr = instrs[next];
+
+        // Falling through a label keeps the flags, and a call doesn't pass them to the called function
+        if (instr.isLabel() || flagsPreserving.contains(instr.opcode)) continue;
+
+        if (keepsCarry(instr)) {
+            onlyCarryLeft = true;
+            continue;
+        }
+
+        if (readsFlags(instr)) {
+            if (!onlyCarryLeft || readsCarry(instr)) return false;
+
+            continue;
+        }
+
+        if (writesFlags(instr) || instr.opcode == "call" || instr.opcode == "ret") return true;
+
+        return false;
+    }
+
+    return true;
+}
+
+bool PeepholeOptimizer::isStackAdjustment(const MachineInstr &instr, long long &amount) {
+    if ((instr.opcode != "add" && instr.opcode != "sub") || instr.operands.size() != 2 ||
+        !instr.operands[0].isReg() || instr.operands[0].name != "rsp" || !instr.operands[1].isImm()) {
+        return false;
+    }
+
+    amount = instr.operands[1].value;
+
+    if (instr.opcode == "sub") amount = -amount;
+
+    return true;
+}
+
+bool PeepholeOptimizer::isJump(const MachineInstr &instr) {
+    return instr.opcode.starts_with("j") && instr.operands.size() == 1 &&
+           instr.operands[0].kind == MachineOperandKind::label;
+}
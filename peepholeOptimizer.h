@@ -0,0 +1,139 @@
+//
+// Created by idang on 19/10/2026.
+//
+
+#ifndef COMPILER_PEEPHOLEOPTIMIZER_H
+#define COMPILER_PEEPHOLEOPTIMIZER_H
+
+#include <array>
+#include <string_view>
+#include <ostream>
+#include "machineInstructions.h"
+
+/**
+ * @brief A peephole rewrite rule, applied to the instructions starting at a position of a function.
+ */
+struct PeepholeRule {
+    std::string_view name;
+    // Rewrites the instructions starting at the position, returns whether it did
+    bool (*apply)(std::vector<MachineInstr> &instrs, size_t pos);
+};
+
+/**
+ * @brief Rewrites short windows of a function's machine instructions to cheaper equivalents.
+ *
+ * Every rule is tried at every position until none of them applies anymore, since a rewrite can expose
+ * another (a removed jump can leave a store right before its reload).
+ */
+class PeepholeOptimizer {
+public:
+    /**
+     * @brief Applies the rules to a function until it stops changing.
+     *
+     * @param function The function to rewrite in place.
+     */
+    void optimizeFunction(MachineFunction &function);
+
+    /**
+     * @brief Prints how many times each rule was applied.
+     *
+     * @param out The stream the counts are printed to.
+     */
+    void printStats(std::ostream &out) const;
+
+private:
+    // The rules, tried in order at each position
+    static const std::array<PeepholeRule, 7> rules;
+    // Map from the condition codes of the conditional jumps to their opposites
+    static std::unordered_map<std::string, std::string> invertedConditions;
+
+    // How many times each rule was applied
+    std::array<int, rules.size()> hits{};
+
+    /**
+     * @brief Removes the reload of a value just stored from a register, or copies the register instead.
+     *
+     * 'mov [m], reg' followed by 'mov reg2, [m]' (or a 'movsx'/'movzx' of it) reads the register instead.
+     */
+    static bool forwardStoreToLoad(std::vector<MachineInstr> &instrs, size_t pos);
+
+    /**
+     * @brief Removes a move of a 64 bit register to itself.
+     */
+    static bool removeSelfMove(std::vector<MachineInstr> &instrs, size_t pos);
+
+    /**
+     * @brief Removes a jump to a label right after it, only other labels between them.
+     */
+    static bool removeJumpToNext(std::vector<MachineInstr> &instrs, size_t pos);
+
+    /**
+     * @brief Replaces a conditional jump over an unconditional one with the opposite conditional jump.
+     *
+     * 'jcc l1', 'jmp l2', 'l1:' becomes 'jncc l2', 'l1:'.
+     */
+    static bool invertBranchOverJump(std::vector<MachineInstr> &instrs, size_t pos);
+
+    /**
+     * @brief Removes the instructions after an unconditional jump or a return, up to the next label.
+     */
+    static bool removeUnreachable(std::vector<MachineInstr> &instrs, size_t pos);
+
+    /**
+     * @brief Folds an adjustment of 'rsp' by a constant into the next one, removing both if they cancel out.
+     *
+     * Releasing stack space later is always safe, allocating it later is only safe when no memory is accessed in
+     * between. The flags set by the adjustments must not be read.
+     */
+    static bool foldStackAdjustments(std::vector<MachineInstr> &instrs, size_t pos);
+
+    /**
+     * @brief Replaces moving zero to a register with the shorter 'xor' of its 32 bit part, when the flags it sets
+     * are not read.
+     */
+    static bool useZeroIdiom(std::vector<MachineInstr> &instrs, size_t pos);
+
+    /**
+     * @brief Checks whether an instruction reads the flags, the jumps, 'setcc' and 'cmovcc' among others.
+     */
+    static bool readsFlags(const MachineInstr &instr);
+
+    /**
+     * @brief Checks whether an instruction writes every flag but the carry flag, which it keeps ('inc' and 'dec').
+     */
+    static bool keepsCarry(const MachineInstr &instr);
+
+    /**
+     * @brief Checks whether an instruction reads the carry flag, the only flag the 'keepsCarry' instructions keep.
+     */
+    static bool readsCarry(const MachineInstr &instr);
+
+    /**
+     * @brief Checks whether an instruction sets all the flags its condition codes can read.
+     */
+    static bool writesFlags(const MachineInstr &instr);
+
+    /**
+     * @brief Checks whether the flags are overwritten before being read after an instruction, following the
+     * instructions that fall through. A jump, or an instruction the check doesn't know, is assumed to read them.
+     *
+     * @param instrs The instructions of the function.
+     * @param pos The position of the instruction.
+     */
+    static bool flagsDeadAfter(const std::vector<MachineInstr> &instrs, size_t pos);
+
+    /**
+     * @brief Checks whether an instruction is an 'add' or 'sub' of 'rsp' and a constant.
+     *
+     * @param instr The instruction.
+     * @param amount Set to the amount added to 'rsp', negative for a 'sub'.
+     */
+    static bool isStackAdjustment(const MachineInstr &instr, long long &amount);
+
+    /**
+     * @brief Checks whether an instruction is a jump to a label, conditional or not.
+     */
+    static bool isJump(const MachineInstr &instr);
+};
+
+#endif //COMPILER_PEEPHOLEOPTIMIZER_H
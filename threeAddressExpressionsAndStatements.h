@@ -6,6 +6,7 @@
 #define COMPILER_THREEADDRESSEXPRESSIONSANDSTATEMENTS_H
 
 #include <utility>
+#include <unordered_map>
 
 #include "treeNodes.h"
 
@@ -42,6 +43,8 @@ public:
 class VariableVal : public UniExpr {
 public:
     Variable var;
+    // Known from the variable's range where it is read: its value is non-negative, so its load may zero extend it
+    bool nonNegative = false;
 
     explicit VariableVal(Variable var) : var(std::move(var)) {
     }
@@ -135,6 +138,12 @@ public:
     UniExpr *left;
     UniExpr *right;
     ExprOperator op;
+    // Known from the ranges of the operands: both are non-negative, and both operands and the result fit in 32 bits
+    bool nonNegative = false;
+    bool narrow = false;
+    // Known from the range of an addition, a subtraction or a multiplication: the result is non-negative and fits in
+    // 32 bits, so computing its low 32 bits gives its value
+    bool narrowResult = false;
 
     BinaryExpr(UniExpr *left, UniExpr *right, ExprOperator op) : op(op) {
         this->left = left;
@@ -147,6 +156,34 @@ public:
     }
 };
 
+// The true value when the comparison holds and the false value otherwise, made by if-conversion
+class SelectExpr : public ThreeAddressExpr {
+public:
+    BinaryExpr *comparison;
+    UniExpr *trueValue;
+    UniExpr *falseValue;
+
+    SelectExpr(BinaryExpr *comparison, UniExpr *trueValue, UniExpr *falseValue) {
+        this->comparison = comparison;
+        this->trueValue = trueValue;
+        this->falseValue = falseValue;
+    }
+
+    ~SelectExpr() override {
+        delete comparison;
+        delete trueValue;
+        delete falseValue;
+    }
+};
+
+// Lane-wise operations of vector statements
+enum class VectorOperator {
+    add,
+    sub,
+    min,
+    max,
+};
+
 class ThreeAddressStmt {
 public:
     virtual ~ThreeAddressStmt() = default;
@@ -188,6 +225,13 @@ public:
     VariableType varType;
     bool isPtr;
     ThreeAddressExpr *expr;
+    // The argument's offset from 'rsp' at the call, set by the frame layout
+    int argOffset = 0;
+    // The size of the call's whole argument block, allocated by its first push, 0 for the other pushes
+    int argsSize = 0;
+    // The index of the argument register the value is passed in, set by the frame layout, -1 for an argument passed
+    // on the stack
+    int argRegister = -1;
 
     FunctionParamPushStmt(VariableType varType, bool isPtr, ThreeAddressExpr *expr) : varType(varType) {
         this->isPtr = isPtr;
@@ -204,11 +248,18 @@ public:
     std::string functionName;
     VariableType retType;
     bool retPtr;
-
-    FunctionCallExpr(std::string functionName, VariableType retType, bool retPtr)
+    // Whether the call ends the calling function, which then jumps to the called function reusing its own frame
+    bool tailCall = false;
+    // Whether the called function's return value already fits its type, so it isn't extended after the call
+    bool retExtended = false;
+    // The number of parameters pushed for the call, the pushes closest to it
+    int paramCount;
+
+    FunctionCallExpr(std::string functionName, VariableType retType, bool retPtr, int paramCount)
             : functionName(std::move(functionName)),
               retType(retType),
-              retPtr(retPtr) {
+              retPtr(retPtr),
+              paramCount(paramCount) {
     }
 
     ~FunctionCallExpr() override = default;
@@ -259,6 +310,21 @@ public:
     }
 };
 
+// Jumps when a relational or equality comparison holds, made from a comparison only read by a conditional jump
+class GotoIfCompareStmt : public ThreeAddressStmt {
+public:
+    std::string labelName;
+    BinaryExpr *comparison;
+
+    GotoIfCompareStmt(std::string labelName, BinaryExpr *comparison) : labelName(std::move(labelName)) {
+        this->comparison = comparison;
+    }
+
+    ~GotoIfCompareStmt() override {
+        delete comparison;
+    }
+};
+
 class SetReturnValueStmt : public ThreeAddressStmt {
 public:
     ThreeAddressExpr *expr;
@@ -290,6 +356,22 @@ public:
     std::string name;
     std::vector<Variable> params;
     int maxTemp = 0;
+    VariableType retType = VariableType::voidType;
+    bool retPtr = false;
+    // Compiler generated variables kept in callee-saved registers for the whole function
+    std::vector<Variable> registerVars;
+    // The results of calls whose arguments are all below 'memoRange' are cached in a table, 0 when they are not
+    int memoRange = 0;
+    // The temporary holding the call's entry in the table, or -1 when the arguments are out of range
+    int memoTemp = 0;
+    // The bytes below 'rbp' taken by the temporaries, the saved registers and the variables, set by the frame layout
+    int frameSize = 0;
+    // Whether the function calls nothing and its frame fits the red zone below 'rsp', so it builds no frame of its
+    // own, set by the frame layout
+    bool leaf = false;
+    // The number of the first parameters passed in the argument registers and stored to the frame by the prologue,
+    // set by the frame layout
+    int registerParams = 0;
 
     FunctionDeclarationStmt(std::string name, std::vector<Variable> params) : name(std::move(name)),
                                                                               params(std::move(params)) {
@@ -301,6 +383,89 @@ public:
     FunctionExitStmt() = default;
 };
 
+// A statement working on all the lanes of vector registers at once, each register holds 'width' bytes of
+// 'elementType' elements
+class VectorStmt : public ThreeAddressStmt {
+public:
+    VariableType elementType;
+    int width;
+
+    VectorStmt(VariableType elementType, int width) : elementType(elementType), width(width) {
+    }
+};
+
+// Loads the consecutive elements starting at 'source'
+class VectorLoadStmt : public VectorStmt {
+public:
+    int reg;
+    SubscriptableVariableVal *source;
+
+    VectorLoadStmt(VariableType elementType, int width, int reg, SubscriptableVariableVal *source)
+            : VectorStmt(elementType, width), reg(reg) {
+        this->source = source;
+    }
+
+    ~VectorLoadStmt() override {
+        delete source;
+    }
+};
+
+// Stores the lanes of a register to the consecutive elements starting at 'target'
+class VectorStoreStmt : public VectorStmt {
+public:
+    SubscriptableVariableVal *target;
+    int reg;
+
+    VectorStoreStmt(VariableType elementType, int width, SubscriptableVariableVal *target, int reg)
+            : VectorStmt(elementType, width), reg(reg) {
+        this->target = target;
+    }
+
+    ~VectorStoreStmt() override {
+        delete target;
+    }
+};
+
+// Copies a scalar value to every lane of a register
+class VectorBroadcastStmt : public VectorStmt {
+public:
+    int reg;
+    UniExpr *value;
+
+    VectorBroadcastStmt(VariableType elementType, int width, int reg, UniExpr *value)
+            : VectorStmt(elementType, width), reg(reg) {
+        this->value = value;
+    }
+
+    ~VectorBroadcastStmt() override {
+        delete value;
+    }
+};
+
+class VectorBinaryStmt : public VectorStmt {
+public:
+    int reg;
+    int left;
+    int right;
+    VectorOperator op;
+
+    VectorBinaryStmt(VariableType elementType, int width, int reg, int left, int right, VectorOperator op)
+            : VectorStmt(elementType, width), reg(reg), left(left), right(right), op(op) {
+    }
+};
+
+// Combines the lanes of a register to a single value assigned to a temporary
+class VectorReduceStmt : public VectorStmt {
+public:
+    int id;
+    int reg;
+    VectorOperator op;
+
+    VectorReduceStmt(VariableType elementType, int width, int id, int reg, VectorOperator op)
+            : VectorStmt(elementType, width), id(id), reg(reg), op(op) {
+    }
+};
+
 class ThreeAddressProgram {
 public:
     std::list<ThreeAddressStmt *> ilStmts;
@@ -334,6 +499,7 @@ typedef AddrExpr *AddrExprP;
 typedef AddrVarExpr *AddrVarExprP;
 typedef AddrStrExpr *AddrStrExprP;
 typedef BinaryExpr *BinaryExprP;
+typedef SelectExpr *SelectExprP;
 typedef ThreeAddressStmt *ThreeAddressStmtP;
 typedef TempAssignmentTAStmt *TempAssignmentTAStmtP;
 typedef VarAssignmentTAStmt *VarAssignmentTAStmtP;
@@ -343,10 +509,17 @@ typedef LabelStmt *LabelStmtP;
 typedef GotoStmt *GotoStmtP;
 typedef GotoIfZeroStmt *GotoIfZeroStmtP;
 typedef GotoIfNotZeroStmt *GotoIfNotZeroStmtP;
+typedef GotoIfCompareStmt *GotoIfCompareStmtP;
 typedef SetReturnValueStmt *SetReturnValueStmtP;
 typedef ScopeEnterStmt *ScopeEnterStmtP;
 typedef ScopeExitStmt *ScopeExitStmtP;
 typedef FunctionDeclarationStmt *FunctionDeclarationStmtP;
 typedef FunctionExitStmt *FunctionExitStmtP;
+typedef VectorStmt *VectorStmtP;
+typedef VectorLoadStmt *VectorLoadStmtP;
+typedef VectorStoreStmt *VectorStoreStmtP;
+typedef VectorBroadcastStmt *VectorBroadcastStmtP;
+typedef VectorBinaryStmt *VectorBinaryStmtP;
+typedef VectorReduceStmt *VectorReduceStmtP;
 
 #endif //COMPILER_THREEADDRESSEXPRESSIONSANDSTATEMENTS_H
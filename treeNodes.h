@@ -60,6 +60,8 @@ public:
     VariableType type;
     bool ptrType;
     int arrSize;
+    // The variable's offset from 'rbp' in its function's frame, set by the frame layout of the IL
+    int frameOffset = 0;
 
     Variable(std::string name, VariableType type, bool ptrType, int arrSize = 0) {
         this->name = std::move(name);